@@ -0,0 +1,181 @@
+#ifndef BLOCK_POOL_H_
+#define BLOCK_POOL_H_
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace odd {
+
+/*
+ * Fixed size blocks that are recycled rather than returned to the heap. Each thread keeps a free
+ * list of its own, so allocating and freeing is a push or pop on a thread local list. Blocks often
+ * go one way, allocated by the thread that posts work and freed by the one that runs it, so a thread
+ * that has freed more than two batches hands a batch back to a shared list, and a thread that has
+ * run out takes a batch from it before it asks the heap for more.
+ *
+ * The blocks are kept until the program exits, a pool is as large as the most blocks it has had in
+ * use at once.
+ */
+template <std::size_t Size>
+class BlockPool
+{
+  public:
+    [[nodiscard]] static void* allocate()
+    {
+      auto& cache = threadCache();
+
+      if (cache.m_head == nullptr) cache.refill();
+
+      auto* block = cache.m_head;
+      cache.m_head = block->m_next;
+      cache.m_count--;
+
+      return block;
+    }
+
+    static void deallocate(void* pointer)
+    {
+      auto& cache = threadCache();
+      auto* block = static_cast<Block*>(pointer);
+
+      block->m_next = cache.m_head;
+      cache.m_head = block;
+
+      if (++cache.m_count > 2 * BATCH) cache.release(BATCH);
+    }
+
+  private:
+    static constexpr std::size_t BATCH = 32;
+
+    union Block
+    {
+      Block* m_next;
+      alignas(std::max_align_t) unsigned char m_bytes[Size];
+    };
+
+    // A list of blocks linked through m_next
+    struct Chain
+    {
+      Block* m_head;
+      std::size_t m_count;
+    };
+
+    struct Central
+    {
+      ~Central()
+      {
+        for (auto& chain : m_chains)
+        {
+          while (chain.m_head != nullptr)
+          {
+            delete std::exchange(chain.m_head, chain.m_head->m_next);
+          }
+        }
+      }
+
+      std::mutex m_mutex;
+      std::vector<Chain> m_chains;
+    };
+
+    struct Cache
+    {
+      ~Cache()
+      {
+        release(m_count);
+      }
+
+      void refill()
+      {
+        {
+          std::lock_guard<std::mutex> lock(central().m_mutex);
+          auto& chains = central().m_chains;
+
+          if (not chains.empty())
+          {
+            m_head = chains.back().m_head;
+            m_count = chains.back().m_count;
+            chains.pop_back();
+            return;
+          }
+        }
+
+        for (std::size_t i = 0; i < BATCH; i++)
+        {
+          auto* block = new Block;
+          block->m_next = m_head;
+          m_head = block;
+        }
+
+        m_count = BATCH;
+      }
+
+      void release(std::size_t count)
+      {
+        if (count == 0) return;
+
+        Chain chain{ m_head, count };
+        auto* last = m_head;
+
+        for (std::size_t i = 1; i < count; i++)
+        {
+          last = last->m_next;
+        }
+
+        m_head = last->m_next;
+        m_count -= count;
+        last->m_next = nullptr;
+
+        std::lock_guard<std::mutex> lock(central().m_mutex);
+        central().m_chains.push_back(chain);
+      }
+
+      Block* m_head = nullptr;
+      std::size_t m_count = 0;
+    };
+
+    static Central& central()
+    {
+      static Central central;
+      return central;
+    }
+
+    static Cache& threadCache()
+    {
+      // The central list is constructed first, so it outlives every thread's cache
+      central();
+
+      thread_local Cache cache;
+      return cache;
+    }
+};
+
+// A block for an object of the given size and alignment, from the pool of the smallest size class
+// it fits in. Objects that are larger than the largest class or over aligned come from the heap
+template <std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+[[nodiscard]] void* allocateBlock()
+{
+  if constexpr (Alignment > alignof(std::max_align_t)) return ::operator new(Size, std::align_val_t{ Alignment });
+  else if constexpr (Size <= 64) return BlockPool<64>::allocate();
+  else if constexpr (Size <= 128) return BlockPool<128>::allocate();
+  else if constexpr (Size <= 256) return BlockPool<256>::allocate();
+  else if constexpr (Size <= 512) return BlockPool<512>::allocate();
+  else return ::operator new(Size);
+}
+
+template <std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+void deallocateBlock(void* block)
+{
+  if constexpr (Alignment > alignof(std::max_align_t)) ::operator delete(block, std::align_val_t{ Alignment });
+  else if constexpr (Size <= 64) BlockPool<64>::deallocate(block);
+  else if constexpr (Size <= 128) BlockPool<128>::deallocate(block);
+  else if constexpr (Size <= 256) BlockPool<256>::deallocate(block);
+  else if constexpr (Size <= 512) BlockPool<512>::deallocate(block);
+  else ::operator delete(block);
+}
+
+} // namespace odd
+
+#endif // BLOCK_POOL_H_
@@ -0,0 +1,217 @@
+#ifndef FUTURE_H_
+#define FUTURE_H_
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "BlockPool.h"
+
+namespace odd {
+
+template <typename T>
+class Promise;
+
+template <typename T>
+class Future;
+
+// A promise and the future it sets, sharing a state allocated from a BlockPool
+template <typename T>
+std::pair<Promise<T>, Future<T>> makePromise();
+
+namespace detail {
+
+/*
+ * The state shared by a promise and its future, freed by whichever of them lets go of it last. A
+ * future waits for it to be set on the ready flag itself, which blocks in the kernel without a mutex
+ * or condition variable of its own.
+ */
+template <typename T>
+struct SharedState
+{
+  using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+  static SharedState* create()
+  {
+    return new (allocateBlock<sizeof(SharedState), alignof(SharedState)>()) SharedState;
+  }
+
+  void release()
+  {
+    if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      this->~SharedState();
+      deallocateBlock<sizeof(SharedState), alignof(SharedState)>(this);
+    }
+  }
+
+  void setReady()
+  {
+    m_ready.store(true, std::memory_order_release);
+    m_ready.notify_all();
+  }
+
+  std::atomic<int> m_references{ 2 };
+  std::atomic<bool> m_ready{ false };
+  std::optional<Value> m_value;
+  std::exception_ptr m_exception;
+};
+
+} // namespace detail
+
+/*
+ * Sets the value, or exception, its future returns. A promise that is destroyed without being set
+ * gives its future a broken promise error.
+ */
+template <typename T>
+class Promise
+{
+  public:
+    Promise() = default;
+
+    Promise(Promise&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) {}
+
+    Promise& operator=(Promise&& other) noexcept
+    {
+      if (this != &other)
+      {
+        abandon();
+        m_state = std::exchange(other.m_state, nullptr);
+      }
+
+      return *this;
+    }
+
+    Promise(const Promise&) = delete;
+    Promise& operator=(const Promise&) = delete;
+
+    ~Promise()
+    {
+      abandon();
+    }
+
+    template <typename... Args>
+    void setValue(Args&&... args)
+    {
+      m_state->m_value.emplace(std::forward<Args>(args)...);
+      finish();
+    }
+
+    void setException(std::exception_ptr exception)
+    {
+      m_state->m_exception = std::move(exception);
+      finish();
+    }
+
+  private:
+    friend std::pair<Promise<T>, Future<T>> makePromise<T>();
+
+    explicit Promise(detail::SharedState<T>* state) : m_state(state) {}
+
+    // A promise is set at most once, it lets go of the state as soon as it has set it
+    void finish()
+    {
+      auto* state = std::exchange(m_state, nullptr);
+
+      state->setReady();
+      state->release();
+    }
+
+    void abandon()
+    {
+      if (m_state == nullptr) return;
+
+      setException(std::make_exception_ptr(std::future_error{ std::future_errc::broken_promise }));
+    }
+
+    detail::SharedState<T>* m_state = nullptr;
+};
+
+/*
+ * The result of work that is done elsewhere. get() waits for the promise to be set, then returns the
+ * value or throws the exception it was set with, and can only be called once.
+ */
+template <typename T>
+class Future
+{
+  public:
+    Future() = default;
+
+    Future(Future&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) {}
+
+    Future& operator=(Future&& other) noexcept
+    {
+      if (this != &other)
+      {
+        if (m_state != nullptr) m_state->release();
+        m_state = std::exchange(other.m_state, nullptr);
+      }
+
+      return *this;
+    }
+
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+
+    ~Future()
+    {
+      if (m_state != nullptr) m_state->release();
+    }
+
+    [[nodiscard]] bool valid() const
+    {
+      return m_state != nullptr;
+    }
+
+    [[nodiscard]] bool ready() const
+    {
+      return m_state->m_ready.load(std::memory_order_acquire);
+    }
+
+    void wait() const
+    {
+      m_state->m_ready.wait(false, std::memory_order_acquire);
+    }
+
+    T get()
+    {
+      wait();
+
+      auto* state = std::exchange(m_state, nullptr);
+
+      struct Release
+      {
+        detail::SharedState<T>* m_state;
+        ~Release() { m_state->release(); }
+      } release{ state };
+
+      if (state->m_exception) std::rethrow_exception(state->m_exception);
+
+      if constexpr (std::is_void_v<T>) return;
+      else return std::move(*state->m_value);
+    }
+
+  private:
+    friend std::pair<Promise<T>, Future<T>> makePromise<T>();
+
+    explicit Future(detail::SharedState<T>* state) : m_state(state) {}
+
+    detail::SharedState<T>* m_state = nullptr;
+};
+
+template <typename T>
+std::pair<Promise<T>, Future<T>> makePromise()
+{
+  auto* state = detail::SharedState<T>::create();
+
+  return { Promise<T>{ state }, Future<T>{ state } };
+}
+
+} // namespace odd
+
+#endif // FUTURE_H_
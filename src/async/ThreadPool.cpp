@@ -1,40 +1,67 @@
 #include "ThreadPool.h"
 
+#include <algorithm>
+
 namespace odd {
 
+namespace {
+
+// The pool and worker the calling thread belongs to, if it is a worker
+thread_local const void* currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+// How many times an idle worker looks for work again before it parks
+constexpr int SPINS_BEFORE_PARKING = 64;
+
+uint64_t nextRandom(uint64_t& state)
+{
+  // xorshift64
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+
+  return state;
+}
+
+} // namespace
+
 ThreadJoiner::ThreadJoiner(std::vector<std::thread>& threads) : m_threads(threads)
 {
 }
 
 ThreadJoiner::~ThreadJoiner()
 {
-  int toJoin = m_threads.size();
-  int joined{ 0 };
-
   for (auto& thread : m_threads)
   {
     if (thread.joinable())
     {
-      joined++;
       thread.join();
     }
   }
 }
 
-ThreadPool::ThreadPool() : m_done(false), m_joiner(m_threads)
+ThreadPool::ThreadPool(std::size_t threadCount) : m_done(false), m_joiner(m_threads)
 {
-  auto threadCount = std::thread::hardware_concurrency();
+  threadCount = std::max<std::size_t>(threadCount, 1);
+
+  for (std::size_t i = 0; i < threadCount; i++)
+  {
+    m_workers.push_back(std::make_unique<Worker>());
+    m_workers.back()->m_random = 0x9e3779b97f4a7c15 * (i + 1);
+  }
 
   try
   {
-    for (int i = 0; i < threadCount; i++)
+    for (std::size_t i = 0; i < threadCount; i++)
     {
-      m_threads.push_back(std::thread{ &ThreadPool::workerThread, this });
+      m_threads.push_back(std::thread{ &ThreadPool::workerThread, this, i });
     }
   }
   catch (...)
   {
+    // Every worker that has started may already be parked
     m_done = true;
+    wakeAll();
     throw;
   }
 }
@@ -42,23 +69,194 @@ ThreadPool::ThreadPool() : m_done(false), m_joiner(m_threads)
 ThreadPool::~ThreadPool()
 {
   m_done = true;
+  wakeAll();
+
+  for (auto& thread : m_threads)
+  {
+    if (thread.joinable()) thread.join();
+  }
+
+  for (auto& worker : m_workers)
+  {
+    while (auto* task = worker->m_deque.pop()) Task::destroy(task);
+  }
+
+  while (auto* task = m_injected.pop()) Task::destroy(task);
+}
+
+[[nodiscard]] std::size_t ThreadPool::threadCount() const
+{
+  return m_workers.size();
+}
+
+void ThreadPool::submit(Task* task)
+{
+  if (currentPool == this)
+  {
+    m_workers[currentWorker]->m_deque.push(task);
+  }
+  else
+  {
+    m_injected.push(task);
+  }
+
+  // Pairs with the fence in park, either the parking worker sees the task or this sees the worker
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (m_parked.load(std::memory_order_relaxed) > 0) wakeOne();
 }
 
-void ThreadPool::workerThread()
+void ThreadPool::workerThread(std::size_t index)
 {
-  while (!m_done)
+  currentPool = this;
+  currentWorker = index;
+
+  auto& worker = *m_workers[index];
+  int idle = 0;
+
+  while (not m_done)
   {
-    FunctionWrapper task;
+    if (auto* task = findWork(worker))
+    {
+      task->m_function();
+      Task::destroy(task);
+      idle = 0;
+      continue;
+    }
 
-    if (m_workQueue.tryPop(task))
+    if (++idle < SPINS_BEFORE_PARKING)
     {
-      task();
+      std::this_thread::yield();
       continue;
     }
 
-    std::this_thread::yield();
+    park();
+    idle = 0;
   }
+
+  currentPool = nullptr;
 }
 
-} // namespace odd
+ThreadPool::Task* ThreadPool::findWork(Worker& worker)
+{
+  if (auto* task = worker.m_deque.pop()) return task;
+
+  if (auto* task = m_injected.pop()) return task;
+
+  return steal(worker);
+}
+
+ThreadPool::Task* ThreadPool::steal(Worker& thief)
+{
+  auto count = m_workers.size();
+  auto first = static_cast<std::size_t>(nextRandom(thief.m_random) % count);
+
+  for (std::size_t i = 0; i < count; i++)
+  {
+    auto& victim = *m_workers[(first + i) % count];
+
+    if (&victim == &thief) continue;
+
+    if (auto* task = victim.m_deque.steal()) return task;
+  }
+
+  return nullptr;
+}
+
+void ThreadPool::park()
+{
+  auto wakeups = m_wakeups.load(std::memory_order_acquire);
+
+  m_parked.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  // Work posted before this worker counted itself as parked did not wake anyone
+  if (not hasQueuedWork() && not m_done)
+  {
+    std::unique_lock<std::mutex> lock(m_parkMutex);
+    m_parkCondition.wait(lock, [this, wakeups]
+    {
+      return m_done || m_wakeups.load(std::memory_order_relaxed) != wakeups;
+    });
+  }
+
+  m_parked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ThreadPool::wakeOne()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_parkMutex);
+    m_wakeups.fetch_add(1, std::memory_order_release);
+  }
+
+  m_parkCondition.notify_one();
+}
+
+void ThreadPool::wakeAll()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_parkMutex);
+    m_wakeups.fetch_add(1, std::memory_order_release);
+  }
+
+  m_parkCondition.notify_all();
+}
+
+[[nodiscard]] bool ThreadPool::hasQueuedWork() const
+{
+  if (not m_injected.empty()) return true;
+
+  return std::any_of(m_workers.begin(), m_workers.end(), [] (const auto& worker)
+  {
+    return not worker->m_deque.empty();
+  });
+}
+
+void ThreadPool::SharedQueue::push(Task* task)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  task->m_next = nullptr;
+
+  if (m_tail == nullptr)
+  {
+    m_head = task;
+  }
+  else
+  {
+    m_tail->m_next = task;
+  }
+
+  m_tail = task;
+  m_empty.store(false, std::memory_order_relaxed);
+}
+
+ThreadPool::Task* ThreadPool::SharedQueue::pop()
+{
+  // Idle workers look here on every round, only take the lock when there is something to take
+  if (m_empty.load(std::memory_order_relaxed)) return nullptr;
 
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto* task = m_head;
+
+  if (task == nullptr) return nullptr;
+
+  m_head = task->m_next;
+
+  if (m_head == nullptr)
+  {
+    m_tail = nullptr;
+    m_empty.store(true, std::memory_order_relaxed);
+  }
+
+  return task;
+}
+
+[[nodiscard]] bool ThreadPool::SharedQueue::empty() const
+{
+  return m_empty.load(std::memory_order_relaxed);
+}
+
+} // namespace odd
@@ -1,11 +1,24 @@
 #ifndef THREAD_POOL_H_
 #define THREAD_POOL_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <future>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "BlockPool.h"
+#include "Future.h"
+#include "WorkStealingDeque.h"
+
 namespace odd {
 
 template<typename T>
@@ -83,81 +96,257 @@ class ThreadJoiner
       std::vector<std::thread>& m_threads;
 };
 
+/*
+ * A move only callable. Functions of up to INLINE_SIZE bytes are kept in the wrapper itself, larger
+ * ones in a block from a BlockPool, so wrapping a function does not allocate from the heap.
+ */
 class FunctionWrapper
 {
   public:
-    FunctionWrapper() = default;
+    static constexpr std::size_t INLINE_SIZE = 48;
 
-    template<typename F>
-    FunctionWrapper(F&& f) : m_impl(std::make_unique<impl_type<F>>(std::move(f))) {}
+    FunctionWrapper() = default;
 
-    void operator()() { m_impl->call(); }
+    template<typename F, typename = std::enable_if_t<not std::is_same_v<std::decay_t<F>, FunctionWrapper>>>
+    FunctionWrapper(F&& f)
+    {
+      using Function = std::decay_t<F>;
+
+      if constexpr (isInline<Function>())
+      {
+        new (&m_storage) Function(std::forward<F>(f));
+        m_operations = &INLINE_OPERATIONS<Function>;
+      }
+      else
+      {
+        auto* block = allocateBlock<sizeof(Function), alignof(Function)>();
+        *reinterpret_cast<Function**>(&m_storage) = new (block) Function(std::forward<F>(f));
+        m_operations = &POOLED_OPERATIONS<Function>;
+      }
+    }
 
-    FunctionWrapper(FunctionWrapper&& other) : m_impl(std::move(other.m_impl))
+    FunctionWrapper(FunctionWrapper&& other) noexcept
     {
+      take(other);
     }
 
-    FunctionWrapper& operator=(FunctionWrapper&& other)
+    FunctionWrapper& operator=(FunctionWrapper&& other) noexcept
     {
-      m_impl = std::move(other.m_impl);
+      if (this != &other)
+      {
+        reset();
+        take(other);
+      }
+
       return *this;
     }
 
     FunctionWrapper(const FunctionWrapper&) = delete;
-    FunctionWrapper(FunctionWrapper&) = delete;
     FunctionWrapper& operator=(const FunctionWrapper&) = delete;
-    
+
+    ~FunctionWrapper()
+    {
+      reset();
+    }
+
+    void operator()() { m_operations->m_call(&m_storage); }
+
+    explicit operator bool() const { return m_operations != nullptr; }
+
   private:
-    struct impl_base
+    struct Operations
+    {
+      void (*m_call)(void*);
+
+      // Moves the function from one wrapper's storage to another's and destroys the original
+      void (*m_move)(void*, void*);
+      void (*m_destroy)(void*);
+    };
+
+    template<typename Function>
+    static constexpr bool isInline()
     {
-      virtual void call() = 0;
-      virtual ~impl_base() {};
+      return sizeof(Function) <= INLINE_SIZE &&
+             alignof(Function) <= alignof(void*) &&
+             std::is_nothrow_move_constructible_v<Function>;
+    }
+
+    template<typename Function>
+    static constexpr Operations INLINE_OPERATIONS
+    {
+      [] (void* storage) { (*static_cast<Function*>(storage))(); },
+      [] (void* from, void* to)
+      {
+        new (to) Function(std::move(*static_cast<Function*>(from)));
+        static_cast<Function*>(from)->~Function();
+      },
+      [] (void* storage) { static_cast<Function*>(storage)->~Function(); }
     };
 
-    std::unique_ptr<impl_base> m_impl;
-    
-    template<typename F>
-    struct impl_type : impl_base
+    // The storage holds a pointer to the function
+    template<typename Function>
+    static constexpr Operations POOLED_OPERATIONS
     {
-      F m_f;
-      impl_type(F&& f) : m_f(std::move(f)) {}
-      void call() { m_f(); }
+      [] (void* storage) { (**static_cast<Function**>(storage))(); },
+      [] (void* from, void* to) { *static_cast<Function**>(to) = *static_cast<Function**>(from); },
+      [] (void* storage)
+      {
+        auto* function = *static_cast<Function**>(storage);
+        function->~Function();
+        deallocateBlock<sizeof(Function), alignof(Function)>(function);
+      }
     };
+
+    void take(FunctionWrapper& other)
+    {
+      if (other.m_operations == nullptr) return;
+
+      other.m_operations->m_move(&other.m_storage, &m_storage);
+      m_operations = std::exchange(other.m_operations, nullptr);
+    }
+
+    void reset()
+    {
+      if (m_operations == nullptr) return;
+
+      std::exchange(m_operations, nullptr)->m_destroy(&m_storage);
+    }
+
+    // Pointer aligned rather than max aligned, which keeps a task to a 64 byte block
+    alignas(void*) unsigned char m_storage[INLINE_SIZE];
+    const Operations* m_operations = nullptr;
 };
 
+/*
+ * Runs posted functions on a fixed set of worker threads. Each worker has a work stealing deque:
+ * work posted from a worker goes on its own deque and is run last in first out, so a task that
+ * spawns tasks usually runs them itself while their data is still in its cache. Work posted from
+ * other threads goes on a shared queue. A worker that runs out of work takes from the shared queue,
+ * then steals the oldest work of the other workers starting from a random one, and parks once it
+ * has found nothing for a while. Posting only wakes a worker if one is parked.
+ *
+ * Posting does not allocate from the heap: the task and the state shared by the promise and future
+ * of its result come from BlockPools, and small functions are kept inline in the task.
+ *
+ * Work still queued when the pool is destroyed is not run.
+ */
 class ThreadPool
 {
   public:
-    ThreadPool();
+    explicit ThreadPool(std::size_t threadCount = std::thread::hardware_concurrency());
     ~ThreadPool();
 
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
     template<typename FunctionType>
-    std::future<typename std::result_of<FunctionType()>::type> post(FunctionType fn)
+    Future<std::invoke_result_t<FunctionType>> post(FunctionType fn)
     {
-      typedef typename std::result_of<FunctionType()>::type ResultType;
-
-      std::packaged_task<ResultType()> task(std::move(fn));
-      std::future<ResultType> result(task.get_future());
-
-      m_workQueue.push(std::move(task));
-
-      return result;
+      using ResultType = std::invoke_result_t<FunctionType>;
+
+      auto [promise, result] = makePromise<ResultType>();
+
+      submit(Task::create([promise = std::move(promise), fn = std::move(fn)] () mutable
+      {
+        try
+        {
+          if constexpr (std::is_void_v<ResultType>)
+          {
+            fn();
+            promise.setValue();
+          }
+          else
+          {
+            promise.setValue(fn());
+          }
+        }
+        catch (...)
+        {
+          promise.setException(std::current_exception());
+        }
+      }));
+
+      return std::move(result);
     }
 
     template<typename FunctionType>
     void postWithoutResult(FunctionType fn)
     {
-      m_workQueue.push(std::move(fn));
+      submit(Task::create(std::move(fn)));
     }
 
+    [[nodiscard]] std::size_t threadCount() const;
+
   private:
+    // A posted function, in a block from a BlockPool
+    struct Task
+    {
+      template<typename F>
+      static Task* create(F&& f)
+      {
+        return new (allocateBlock<sizeof(Task)>()) Task{ nullptr, FunctionWrapper{ std::forward<F>(f) } };
+      }
+
+      static void destroy(Task* task)
+      {
+        task->~Task();
+        deallocateBlock<sizeof(Task)>(task);
+      }
+
+      // Links the tasks in the shared queue
+      Task* m_next;
+      FunctionWrapper m_function;
+    };
+
+    // The tasks posted from outside the pool, first in first out
+    class SharedQueue
+    {
+      public:
+        void push(Task* task);
+        Task* pop();
+
+        [[nodiscard]] bool empty() const;
+
+      private:
+        std::mutex m_mutex;
+        Task* m_head = nullptr;
+        Task* m_tail = nullptr;
+        std::atomic<bool> m_empty{ true };
+    };
+
+    struct Worker
+    {
+      WorkStealingDeque<Task> m_deque;
+      uint64_t m_random;
+    };
+
+    // Queues the task on the calling worker's deque, or the shared queue from any other thread
+    void submit(Task* task);
+
+    void workerThread(std::size_t index);
+
+    Task* findWork(Worker& worker);
+    Task* steal(Worker& thief);
+
+    // Waits until work is posted or the pool is stopped
+    void park();
+    void wakeOne();
+    void wakeAll();
+
+    [[nodiscard]] bool hasQueuedWork() const;
+
     std::atomic_bool m_done;
-    ThreadSafeQueue<FunctionWrapper> m_workQueue;
-    std::vector<std::thread> m_threads;
-    ThreadJoiner m_joiner;
 
-    void workerThread();
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    SharedQueue m_injected;
 
+    std::atomic<std::size_t> m_parked{ 0 };
+    std::atomic<uint64_t> m_wakeups{ 0 };
+    std::mutex m_parkMutex;
+    std::condition_variable m_parkCondition;
+
+    std::vector<std::thread> m_threads;
+    ThreadJoiner m_joiner;
 };
 
 } // namespace odd
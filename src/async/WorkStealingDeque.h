@@ -0,0 +1,158 @@
+#ifndef WORK_STEALING_DEQUE_H_
+#define WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace odd {
+
+/*
+ * A Chase-Lev deque of pointers. The thread that owns the deque pushes and pops at the bottom, last
+ * in first out, and any other thread steals from the top, so the owner works on what it pushed most
+ * recently while thieves take the oldest work. Pushing and popping only synchronise with thieves when
+ * the deque is down to its last item, stealing is a single compare and swap on the top.
+ *
+ * The array grows when it is full. Arrays that have been grown out of are kept until the deque is
+ * destroyed, a thief may still be reading one.
+ *
+ * Following Lê, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (PPoPP 2013).
+ */
+template <typename T>
+class WorkStealingDeque
+{
+  public:
+    explicit WorkStealingDeque(std::size_t capacity = 256)
+    {
+      std::size_t size = 1;
+
+      while (size < capacity) size <<= 1;
+
+      m_arrays.push_back(std::make_unique<Array>(size));
+      m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only
+    void push(T* item)
+    {
+      auto bottom = m_bottom.load(std::memory_order_relaxed);
+      auto top = m_top.load(std::memory_order_acquire);
+      auto* array = m_array.load(std::memory_order_relaxed);
+
+      if (bottom - top > static_cast<int64_t>(array->m_mask)) array = grow(array, top, bottom);
+
+      array->put(bottom, item);
+      std::atomic_thread_fence(std::memory_order_release);
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only, returns nullptr if the deque is empty
+    T* pop()
+    {
+      auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+      auto* array = m_array.load(std::memory_order_relaxed);
+
+      m_bottom.store(bottom, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      auto top = m_top.load(std::memory_order_relaxed);
+
+      if (top > bottom)
+      {
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+      }
+
+      auto* item = array->get(bottom);
+
+      if (top == bottom)
+      {
+        // The last item, which a thief may be taking at the same time
+        if (not m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+          item = nullptr;
+        }
+
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      }
+
+      return item;
+    }
+
+    // Any thread, returns nullptr if the deque is empty or another thread took the item first
+    T* steal()
+    {
+      auto top = m_top.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto bottom = m_bottom.load(std::memory_order_acquire);
+
+      if (top >= bottom) return nullptr;
+
+      auto* item = m_array.load(std::memory_order_acquire)->get(top);
+
+      if (not m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      {
+        return nullptr;
+      }
+
+      return item;
+    }
+
+    // A snapshot, which may already be out of date
+    [[nodiscard]] bool empty() const
+    {
+      return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Array
+    {
+      explicit Array(std::size_t size) : m_mask(size - 1), m_items(size) {}
+
+      T* get(int64_t index) const
+      {
+        return m_items[static_cast<std::size_t>(index) & m_mask].load(std::memory_order_relaxed);
+      }
+
+      void put(int64_t index, T* item)
+      {
+        m_items[static_cast<std::size_t>(index) & m_mask].store(item, std::memory_order_relaxed);
+      }
+
+      const std::size_t m_mask;
+      std::vector<std::atomic<T*>> m_items;
+    };
+
+    Array* grow(Array* array, int64_t top, int64_t bottom)
+    {
+      m_arrays.push_back(std::make_unique<Array>((array->m_mask + 1) * 2));
+      auto* grown = m_arrays.back().get();
+
+      for (auto i = top; i < bottom; i++)
+      {
+        grown->put(i, array->get(i));
+      }
+
+      m_array.store(grown, std::memory_order_release);
+
+      return grown;
+    }
+
+    // The owner and the thieves each write one end, keep them off each other's cache lines
+    alignas(64) std::atomic<int64_t> m_top{ 0 };
+    alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+    alignas(64) std::atomic<Array*> m_array{ nullptr };
+
+    // Only touched by the owner
+    std::vector<std::unique_ptr<Array>> m_arrays;
+};
+
+} // namespace odd
+
+#endif // WORK_STEALING_DEQUE_H_
@@ -0,0 +1,311 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <Future.h>
+#include <ThreadPool.h>
+#include <WorkStealingDeque.h>
+
+namespace {
+
+std::atomic<std::size_t> heapAllocations{ 0 };
+
+} // namespace
+
+// Counts the allocations from the heap, to check that posting work does not make any
+void* operator new(std::size_t size)
+{
+  heapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+namespace odd {
+
+TEST_CASE("A function wrapper keeps small functions inline and large ones in a pooled block")
+{
+  auto destroyed = std::make_shared<int>(0);
+
+  struct Counted
+  {
+    std::shared_ptr<int> m_destroyed;
+    int* m_calls;
+
+    Counted(std::shared_ptr<int> destroyed, int* calls) : m_destroyed(std::move(destroyed)), m_calls(calls) {}
+    Counted(Counted&& other) noexcept = default;
+    ~Counted() { if (m_destroyed) (*m_destroyed)++; }
+
+    void operator()() { (*m_calls)++; }
+  };
+
+  int calls = 0;
+
+  {
+    FunctionWrapper small{ Counted{ destroyed, &calls } };
+    FunctionWrapper moved{ std::move(small) };
+
+    CHECK_FALSE(small);
+    moved();
+    CHECK(calls == 1);
+  }
+
+  CHECK(*destroyed == 1);
+
+  std::array<char, 200> payload{};
+  payload[199] = 3;
+
+  {
+    FunctionWrapper large{ [payload, &calls] { calls += payload[199]; } };
+    FunctionWrapper moved;
+    moved = std::move(large);
+
+    CHECK_FALSE(large);
+    moved();
+    CHECK(calls == 4);
+  }
+}
+
+TEST_CASE("A future returns the value or exception its promise was set with")
+{
+  {
+    auto [promise, future] = makePromise<std::unique_ptr<int>>();
+
+    std::thread setter{ [promise = std::move(promise)] () mutable { promise.setValue(std::make_unique<int>(5)); } };
+
+    CHECK(*future.get() == 5);
+    CHECK_FALSE(future.valid());
+    setter.join();
+  }
+
+  {
+    auto [promise, future] = makePromise<void>();
+    promise.setException(std::make_exception_ptr(std::runtime_error{ "failed" }));
+
+    CHECK(future.ready());
+    CHECK_THROWS_AS(future.get(), std::runtime_error);
+  }
+
+  {
+    auto [promise, future] = makePromise<int>();
+    promise = Promise<int>{};
+
+    CHECK_THROWS_AS(future.get(), std::future_error);
+  }
+}
+
+TEST_CASE("The owner of a work stealing deque pops last in first out and thieves steal the oldest")
+{
+  WorkStealingDeque<int> deque{ 2 };
+  std::vector<int> items(10);
+
+  for (auto& item : items)
+  {
+    deque.push(&item);
+  }
+
+  CHECK(deque.steal() == &items[0]);
+  CHECK(deque.pop() == &items[9]);
+  CHECK(deque.pop() == &items[8]);
+  CHECK(deque.steal() == &items[1]);
+
+  for (int i = 7; i >= 2; i--)
+  {
+    CHECK(deque.pop() == &items[i]);
+  }
+
+  CHECK(deque.pop() == nullptr);
+  CHECK(deque.steal() == nullptr);
+  CHECK(deque.empty());
+}
+
+TEST_CASE("Every item pushed to a work stealing deque is taken once by the owner or a thief")
+{
+  constexpr int itemCount = 200000;
+  constexpr int thiefCount = 3;
+
+  WorkStealingDeque<int> deque;
+  std::vector<int> items(itemCount);
+  std::vector<std::atomic<int>> taken(itemCount);
+  std::atomic<bool> done{ false };
+
+  auto take = [&items, &taken] (int* item)
+  {
+    taken[item - items.data()]++;
+  };
+
+  std::vector<std::thread> thieves;
+
+  for (int i = 0; i < thiefCount; i++)
+  {
+    thieves.emplace_back([&]
+    {
+      while (not done)
+      {
+        if (auto* item = deque.steal()) take(item);
+      }
+
+      while (auto* item = deque.steal()) take(item);
+    });
+  }
+
+  for (int i = 0; i < itemCount; i++)
+  {
+    deque.push(&items[i]);
+
+    // The owner takes some back, racing the thieves for the last item
+    if (i % 3 == 0)
+    {
+      if (auto* item = deque.pop()) take(item);
+    }
+  }
+
+  done = true;
+
+  for (auto& thief : thieves)
+  {
+    thief.join();
+  }
+
+  for (int i = 0; i < itemCount; i++)
+  {
+    REQUIRE(taken[i] == 1);
+  }
+}
+
+TEST_CASE("A thread pool runs posted work and returns its results")
+{
+  ThreadPool pool{ 4 };
+
+  std::vector<Future<int>> results;
+
+  for (int i = 0; i < 1000; i++)
+  {
+    results.push_back(pool.post([i] { return i * 2; }));
+  }
+
+  for (int i = 0; i < 1000; i++)
+  {
+    CHECK(results[i].get() == i * 2);
+  }
+}
+
+TEST_CASE("Work posted by work runs on the pool, and is stolen by the other workers")
+{
+  ThreadPool pool{ 4 };
+
+  std::atomic<int> remaining{ 0 };
+  std::promise<void> finished;
+
+  // A binary tree of tasks, each one posting its two children from the worker it runs on
+  std::function<void(int)> spawn = [&] (int depth)
+  {
+    if (depth > 0)
+    {
+      remaining += 2;
+      pool.postWithoutResult([&spawn, depth] { spawn(depth - 1); });
+      pool.postWithoutResult([&spawn, depth] { spawn(depth - 1); });
+    }
+
+    if (--remaining == 0) finished.set_value();
+  };
+
+  remaining = 1;
+  pool.postWithoutResult([&spawn] { spawn(14); });
+
+  CHECK(finished.get_future().wait_for(std::chrono::seconds{ 30 }) == std::future_status::ready);
+}
+
+TEST_CASE("An idle thread pool parks its workers instead of spinning")
+{
+  using namespace std::chrono_literals;
+
+  ThreadPool pool{ 4 };
+
+  pool.post([] {}).get();
+  std::this_thread::sleep_for(100ms);
+
+  auto cpuStart = std::clock();
+  std::this_thread::sleep_for(500ms);
+  auto cpuTime = std::chrono::duration<double>(static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC);
+
+  CHECK(cpuTime < 50ms);
+
+  // A parked pool still wakes for new work
+  CHECK(pool.post([] { return 7; }).get() == 7);
+}
+
+TEST_CASE("Posting work does not allocate from the heap once the pools have warmed up")
+{
+  ThreadPool pool{ 2 };
+
+  auto round = [&pool]
+  {
+    long long total = 0;
+
+    for (int i = 0; i < 2000; i++)
+    {
+      total += pool.post([i] { return static_cast<long long>(i); }).get();
+    }
+
+    return total;
+  };
+
+  round();
+
+  auto before = heapAllocations.load();
+  auto total = round();
+  auto after = heapAllocations.load();
+
+  CHECK(total == 1999LL * 2000 / 2);
+  CHECK(after == before);
+}
+
+// Not run by default, run with AsyncTests "[benchmark]" to see the cost of a submission
+TEST_CASE("The cost of posting a task to the pool", "[.][benchmark]")
+{
+  using namespace std::chrono_literals;
+
+  ThreadPool pool{ 4 };
+
+  constexpr int postCount = 100000;
+  std::atomic<int> ran{ 0 };
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < postCount; i++)
+  {
+    pool.postWithoutResult([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+  }
+
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+  std::cout << "posting took " << elapsed.count() / postCount << " ns a task" << std::endl;
+
+  while (ran.load() < postCount) std::this_thread::sleep_for(1ms);
+}
+
+} // namespace odd
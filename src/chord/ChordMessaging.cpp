@@ -71,19 +71,22 @@ FindSuccessorResponseMessage::FindSuccessorResponseMessage(CommsVersion version,
                                                            const NodeId& nodeId,
                                                            const NodeId& sourceNodeId,
                                                            uint32_t ipAddress,
-                                                           uint32_t requestId)
-  : Message(version, MessageType::CHORD_FIND_SUCCESSOR_RESPONSE, 2 * sizeof(NodeId) + 8),
+                                                           uint32_t requestId,
+                                                           uint32_t hops)
+  : Message(version, MessageType::CHORD_FIND_SUCCESSOR_RESPONSE, 2 * sizeof(NodeId) + 12),
     m_nodeId(nodeId),
     m_sourceNodeId(sourceNodeId),
     m_ipAddress(ipAddress),
-    m_requestId(requestId)
+    m_requestId(requestId),
+    m_hops(hops)
 {
 }
 
 FindSuccessorResponseMessage::FindSuccessorResponseMessage(CommsVersion version)
-  : Message(version, MessageType::CHORD_FIND_SUCCESSOR_RESPONSE, 2 * sizeof(NodeId) + 8),
+  : Message(version, MessageType::CHORD_FIND_SUCCESSOR_RESPONSE, 2 * sizeof(NodeId) + 12),
     m_ipAddress(0),
-    m_requestId(0)
+    m_requestId(0),
+    m_hops(0)
 {
 }
 
@@ -103,6 +106,9 @@ FindSuccessorResponseMessage::FindSuccessorResponseMessage(CommsVersion version)
   payload_p += sizeof(uint32_t);
 
   encodeSingleValue(&m_requestId, payload_p);
+  payload_p += sizeof(uint32_t);
+
+  encodeSingleValue(&m_hops, payload_p);
 
   return std::move(encoded);
 }
@@ -123,6 +129,9 @@ void FindSuccessorResponseMessage::decode(EncodedMessage&& message)
   payload_p += sizeof(uint32_t);
 
   decodeSingleValue(payload_p, &m_requestId);
+  payload_p += sizeof(uint32_t);
+
+  decodeSingleValue(payload_p, &m_hops);
 }
 
 [[nodiscard]] const NodeId& FindSuccessorResponseMessage::nodeId() const
@@ -145,6 +154,11 @@ void FindSuccessorResponseMessage::decode(EncodedMessage&& message)
   return m_requestId;
 }
 
+[[nodiscard]] uint32_t FindSuccessorResponseMessage::hops() const
+{
+  return m_hops;
+}
+
 NotifyMessage::NotifyMessage(CommsVersion version,
                              const NodeId& nodeId)
   : Message(version, MessageType::CHORD_NOTIFY, sizeof(NodeId)),
@@ -467,5 +481,715 @@ void FindIpMessage::decode(EncodedMessage&& message)
   return m_timeToLive;
 }
 
-} // namespace odd::chord
+CheckPredecessorMessage::CheckPredecessorMessage(CommsVersion version,
+                                                 const NodeId& sourceNodeId,
+                                                 uint32_t sourceNodeIp,
+                                                 uint32_t requestId)
+  : Message(version, MessageType::CHORD_CHECK_PREDECESSOR, 2 * sizeof(uint32_t) + sizeof(NodeId)),
+    m_sourceNodeId(sourceNodeId),
+    m_sourceNodeIp(sourceNodeIp),
+    m_requestId(requestId)
+{
+}
+
+CheckPredecessorMessage::CheckPredecessorMessage(CommsVersion version)
+  : Message(version, MessageType::CHORD_CHECK_PREDECESSOR, 2 * sizeof(uint32_t) + sizeof(NodeId)),
+    m_sourceNodeIp(0),
+    m_requestId(0)
+{
+}
+
+[[nodiscard]] EncodedMessage CheckPredecessorMessage::encode() const
+{
+  EncodedMessage encoded = createEncodedMessage();
+
+  auto* payload_p = &encoded.m_message[8];
+
+  encodeSingleValue(&m_sourceNodeId, payload_p);
+  payload_p += sizeof(NodeId);
+
+  encodeSingleValue(&m_sourceNodeIp, payload_p);
+  payload_p += sizeof(uint32_t);
+
+  encodeSingleValue(&m_requestId, payload_p);
+
+  return encoded;
+}
+
+void CheckPredecessorMessage::decode(EncodedMessage&& message)
+{
+  decodeHeaders(message);
+
+  auto* payload_p = &message.m_message[8];
+
+  decodeSingleValue(payload_p, &m_sourceNodeId);
+  payload_p += sizeof(NodeId);
+
+  decodeSingleValue(payload_p, &m_sourceNodeIp);
+  payload_p += sizeof(uint32_t);
+
+  decodeSingleValue(payload_p, &m_requestId);
+}
+
+[[nodiscard]] const NodeId& CheckPredecessorMessage::sourceNodeId() const
+{
+  return m_sourceNodeId;
+}
+
+[[nodiscard]] uint32_t CheckPredecessorMessage::sourceNodeIp() const
+{
+  return m_sourceNodeIp;
+}
+
+[[nodiscard]] uint32_t CheckPredecessorMessage::requestId() const
+{
+  return m_requestId;
+}
+
+CheckPredecessorResponseMessage::CheckPredecessorResponseMessage(CommsVersion version,
+                                                                 const NodeId& sourceNodeId,
+                                                                 uint32_t requestId)
+  : Message(version, MessageType::CHORD_CHECK_PREDECESSOR_RESPONSE, sizeof(uint32_t) + sizeof(NodeId)),
+    m_sourceNodeId(sourceNodeId),
+    m_requestId(requestId)
+{
+}
 
+CheckPredecessorResponseMessage::CheckPredecessorResponseMessage(CommsVersion version)
+  : Message(version, MessageType::CHORD_CHECK_PREDECESSOR_RESPONSE, sizeof(uint32_t) + sizeof(NodeId)),
+    m_requestId(0)
+{
+}
+
+[[nodiscard]] EncodedMessage CheckPredecessorResponseMessage::encode() const
+{
+  EncodedMessage encoded = createEncodedMessage();
+
+  auto* payload_p = &encoded.m_message[8];
+
+  encodeSingleValue(&m_sourceNodeId, payload_p);
+  payload_p += sizeof(NodeId);
+
+  encodeSingleValue(&m_requestId, payload_p);
+
+  return encoded;
+}
+
+void CheckPredecessorResponseMessage::decode(EncodedMessage&& message)
+{
+  decodeHeaders(message);
+
+  auto* payload_p = &message.m_message[8];
+
+  decodeSingleValue(payload_p, &m_sourceNodeId);
+  payload_p += sizeof(NodeId);
+
+  decodeSingleValue(payload_p, &m_requestId);
+}
+
+[[nodiscard]] const NodeId& CheckPredecessorResponseMessage::sourceNodeId() const
+{
+  return m_sourceNodeId;
+}
+
+[[nodiscard]] uint32_t CheckPredecessorResponseMessage::requestId() const
+{
+  return m_requestId;
+}
+
+BootstrapMessage::BootstrapMessage(CommsVersion version,
+                                   const NodeId& sourceNodeId,
+                                   uint32_t requestId)
+  : Message(version, MessageType::CHORD_BOOTSTRAP, sizeof(uint32_t) + sizeof(NodeId)),
+    m_sourceNodeId(sourceNodeId),
+    m_requestId(requestId)
+{
+}
+
+BootstrapMessage::BootstrapMessage(CommsVersion version)
+  : Message(version, MessageType::CHORD_BOOTSTRAP, sizeof(uint32_t) + sizeof(NodeId)),
+    m_requestId(0)
+{
+}
+
+[[nodiscard]] EncodedMessage BootstrapMessage::encode() const
+{
+  EncodedMessage encoded = createEncodedMessage();
+
+  auto* payload_p = &encoded.m_message[8];
+
+  encodeSingleValue(&m_sourceNodeId, payload_p);
+  payload_p += sizeof(NodeId);
+
+  encodeSingleValue(&m_requestId, payload_p);
+
+  return encoded;
+}
+
+void BootstrapMessage::decode(EncodedMessage&& message)
+{
+  decodeHeaders(message);
+
+  auto* payload_p = &message.m_message[8];
+
+  decodeSingleValue(payload_p, &m_sourceNodeId);
+  payload_p += sizeof(NodeId);
+
+  decodeSingleValue(payload_p, &m_requestId);
+}
+
+[[nodiscard]] const NodeId& BootstrapMessage::sourceNodeId() const
+{
+  return m_sourceNodeId;
+}
+
+[[nodiscard]] uint32_t BootstrapMessage::requestId() const
+{
+  return m_requestId;
+}
+
+BootstrapResponseMessage::BootstrapResponseMessage(CommsVersion version,
+                                                   const NodeId& sourceNodeId,
+                                                   uint32_t requestId,
+                                                   std::optional<NodeAddress> predecessor,
+                                                   std::vector<NodeAddress> successors,
+                                                   std::vector<NodeAddress> fingers)
+  : Message(version, MessageType::CHORD_BOOTSTRAP_RESPONSE, payloadLength(successors.size(), fingers.size())),
+    m_sourceNodeId(sourceNodeId),
+    m_requestId(requestId),
+    m_predecessor(predecessor),
+    m_successors(std::move(successors)),
+    m_fingers(std::move(fingers))
+{
+}
+
+BootstrapResponseMessage::BootstrapResponseMessage(CommsVersion version)
+  : Message(version, MessageType::CHORD_BOOTSTRAP_RESPONSE, payloadLength(0, 0)),
+    m_requestId(0)
+{
+}
+
+std::size_t BootstrapResponseMessage::payloadLength(std::size_t successorCount, std::size_t fingerCount)
+{
+  constexpr std::size_t addressLength = sizeof(NodeId) + sizeof(uint32_t);
+
+  return sizeof(NodeId) + sizeof(uint32_t) + sizeof(uint8_t) + addressLength +
+         2 * sizeof(uint16_t) + (successorCount + fingerCount) * addressLength;
+}
+
+[[nodiscard]] EncodedMessage BootstrapResponseMessage::encode() const
+{
+  EncodedMessage encoded = createEncodedMessage();
+
+  auto* payload_p = &encoded.m_message[8];
+
+  auto encodeAddress = [&payload_p] (const NodeAddress& address)
+  {
+    encodeSingleValue(&address.m_nodeId, payload_p);
+    payload_p += sizeof(NodeId);
+
+    encodeSingleValue(&address.m_ip, payload_p);
+    payload_p += sizeof(uint32_t);
+  };
+
+  encodeSingleValue(&m_sourceNodeId, payload_p);
+  payload_p += sizeof(NodeId);
+
+  encodeSingleValue(&m_requestId, payload_p);
+  payload_p += sizeof(uint32_t);
+
+  uint8_t hasPredecessor = m_predecessor.has_value();
+  encodeSingleValue(&hasPredecessor, payload_p);
+  payload_p += sizeof(uint8_t);
+
+  encodeAddress(m_predecessor.value_or(NodeAddress{ NodeId{}, 0 }));
+
+  auto successorCount = static_cast<uint16_t>(m_successors.size());
+  encodeSingleValue(&successorCount, payload_p);
+  payload_p += sizeof(uint16_t);
+
+  for (const auto& successor : m_successors)
+  {
+    encodeAddress(successor);
+  }
+
+  auto fingerCount = static_cast<uint16_t>(m_fingers.size());
+  encodeSingleValue(&fingerCount, payload_p);
+  payload_p += sizeof(uint16_t);
+
+  for (const auto& finger : m_fingers)
+  {
+    encodeAddress(finger);
+  }
+
+  return encoded;
+}
+
+void BootstrapResponseMessage::decode(EncodedMessage&& message)
+{
+  decodeHeaders(message);
+
+  auto* payload_p = &message.m_message[8];
+
+  auto decodeAddress = [&payload_p] ()
+  {
+    NodeAddress address;
+
+    decodeSingleValue(payload_p, &address.m_nodeId);
+    payload_p += sizeof(NodeId);
+
+    decodeSingleValue(payload_p, &address.m_ip);
+    payload_p += sizeof(uint32_t);
+
+    return address;
+  };
+
+  decodeSingleValue(payload_p, &m_sourceNodeId);
+  payload_p += sizeof(NodeId);
+
+  decodeSingleValue(payload_p, &m_requestId);
+  payload_p += sizeof(uint32_t);
+
+  uint8_t hasPredecessor;
+  decodeSingleValue(payload_p, &hasPredecessor);
+  payload_p += sizeof(uint8_t);
+
+  auto predecessor = decodeAddress();
+  m_predecessor = hasPredecessor ? std::optional<NodeAddress>{ predecessor } : std::nullopt;
+
+  uint16_t successorCount;
+  decodeSingleValue(payload_p, &successorCount);
+  payload_p += sizeof(uint16_t);
+
+  // Never read past the end of a truncated or corrupt message
+  auto remaining = [&] { return static_cast<std::size_t>(message.m_message + message.m_length - payload_p); };
+  constexpr std::size_t addressLength = sizeof(NodeId) + sizeof(uint32_t);
+
+  m_successors.clear();
+
+  for (uint16_t i = 0; i < successorCount && remaining() >= addressLength; i++)
+  {
+    m_successors.push_back(decodeAddress());
+  }
+
+  if (remaining() < sizeof(uint16_t)) return;
+
+  uint16_t fingerCount;
+  decodeSingleValue(payload_p, &fingerCount);
+  payload_p += sizeof(uint16_t);
+
+  m_fingers.clear();
+
+  for (uint16_t i = 0; i < fingerCount && remaining() >= addressLength; i++)
+  {
+    m_fingers.push_back(decodeAddress());
+  }
+}
+
+[[nodiscard]] const NodeId& BootstrapResponseMessage::sourceNodeId() const
+{
+  return m_sourceNodeId;
+}
+
+[[nodiscard]] uint32_t BootstrapResponseMessage::requestId() const
+{
+  return m_requestId;
+}
+
+[[nodiscard]] const std::optional<NodeAddress>& BootstrapResponseMessage::predecessor() const
+{
+  return m_predecessor;
+}
+
+[[nodiscard]] const std::vector<NodeAddress>& BootstrapResponseMessage::successors() const
+{
+  return m_successors;
+}
+
+[[nodiscard]] const std::vector<NodeAddress>& BootstrapResponseMessage::fingers() const
+{
+  return m_fingers;
+}
+
+StabiliseMessage::StabiliseMessage(CommsVersion version,
+                                   const NodeId& sourceNodeId,
+                                   uint32_t sourceNodeIp,
+                                   uint32_t requestId,
+                                   uint64_t knownState)
+  : Message(version, MessageType::CHORD_STABILISE, sizeof(NodeId) + 2 * sizeof(uint32_t) + sizeof(uint64_t)),
+    m_sourceNodeId(sourceNodeId),
+    m_sourceNodeIp(sourceNodeIp),
+    m_requestId(requestId),
+    m_knownState(knownState)
+{
+}
+
+StabiliseMessage::StabiliseMessage(CommsVersion version)
+  : Message(version, MessageType::CHORD_STABILISE, sizeof(NodeId) + 2 * sizeof(uint32_t) + sizeof(uint64_t)),
+    m_sourceNodeIp(0),
+    m_requestId(0),
+    m_knownState(0)
+{
+}
+
+[[nodiscard]] EncodedMessage StabiliseMessage::encode() const
+{
+  EncodedMessage encoded = createEncodedMessage();
+
+  auto* payload_p = &encoded.m_message[8];
+
+  encodeSingleValue(&m_sourceNodeId, payload_p);
+  payload_p += sizeof(NodeId);
+
+  encodeSingleValue(&m_sourceNodeIp, payload_p);
+  payload_p += sizeof(uint32_t);
+
+  encodeSingleValue(&m_requestId, payload_p);
+  payload_p += sizeof(uint32_t);
+
+  encodeSingleValue(&m_knownState, payload_p);
+
+  return encoded;
+}
+
+void StabiliseMessage::decode(EncodedMessage&& message)
+{
+  decodeHeaders(message);
+
+  auto* payload_p = &message.m_message[8];
+
+  decodeSingleValue(payload_p, &m_sourceNodeId);
+  payload_p += sizeof(NodeId);
+
+  decodeSingleValue(payload_p, &m_sourceNodeIp);
+  payload_p += sizeof(uint32_t);
+
+  decodeSingleValue(payload_p, &m_requestId);
+  payload_p += sizeof(uint32_t);
+
+  decodeSingleValue(payload_p, &m_knownState);
+}
+
+[[nodiscard]] const NodeId& StabiliseMessage::sourceNodeId() const
+{
+  return m_sourceNodeId;
+}
+
+[[nodiscard]] uint32_t StabiliseMessage::sourceNodeIp() const
+{
+  return m_sourceNodeIp;
+}
+
+[[nodiscard]] uint32_t StabiliseMessage::requestId() const
+{
+  return m_requestId;
+}
+
+[[nodiscard]] uint64_t StabiliseMessage::knownState() const
+{
+  return m_knownState;
+}
+
+StabiliseResponseMessage::StabiliseResponseMessage(CommsVersion version,
+                                                   const NodeId& sourceNodeId,
+                                                   uint32_t requestId,
+                                                   uint64_t state,
+                                                   std::optional<NodeAddress> predecessor,
+                                                   std::vector<NodeAddress> successors)
+  : Message(version, MessageType::CHORD_STABILISE_RESPONSE, payloadLength(false, successors.size())),
+    m_sourceNodeId(sourceNodeId),
+    m_requestId(requestId),
+    m_state(state),
+    m_unchanged(false),
+    m_predecessor(predecessor),
+    m_successors(std::move(successors))
+{
+}
+
+StabiliseResponseMessage::StabiliseResponseMessage(CommsVersion version,
+                                                   const NodeId& sourceNodeId,
+                                                   uint32_t requestId,
+                                                   uint64_t state)
+  : Message(version, MessageType::CHORD_STABILISE_RESPONSE, payloadLength(true, 0)),
+    m_sourceNodeId(sourceNodeId),
+    m_requestId(requestId),
+    m_state(state),
+    m_unchanged(true)
+{
+}
+
+StabiliseResponseMessage::StabiliseResponseMessage(CommsVersion version)
+  : Message(version, MessageType::CHORD_STABILISE_RESPONSE, payloadLength(true, 0)),
+    m_requestId(0),
+    m_state(0),
+    m_unchanged(true)
+{
+}
+
+std::size_t StabiliseResponseMessage::payloadLength(bool unchanged, std::size_t successorCount)
+{
+  constexpr std::size_t addressLength = sizeof(NodeId) + sizeof(uint32_t);
+  constexpr std::size_t headerLength = sizeof(NodeId) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint8_t);
+
+  if (unchanged) return headerLength;
+
+  return headerLength + sizeof(uint8_t) + addressLength + sizeof(uint16_t) + successorCount * addressLength;
+}
+
+[[nodiscard]] EncodedMessage StabiliseResponseMessage::encode() const
+{
+  EncodedMessage encoded = createEncodedMessage();
+
+  auto* payload_p = &encoded.m_message[8];
+
+  auto encodeAddress = [&payload_p] (const NodeAddress& address)
+  {
+    encodeSingleValue(&address.m_nodeId, payload_p);
+    payload_p += sizeof(NodeId);
+
+    encodeSingleValue(&address.m_ip, payload_p);
+    payload_p += sizeof(uint32_t);
+  };
+
+  encodeSingleValue(&m_sourceNodeId, payload_p);
+  payload_p += sizeof(NodeId);
+
+  encodeSingleValue(&m_requestId, payload_p);
+  payload_p += sizeof(uint32_t);
+
+  encodeSingleValue(&m_state, payload_p);
+  payload_p += sizeof(uint64_t);
+
+  uint8_t unchanged = m_unchanged;
+  encodeSingleValue(&unchanged, payload_p);
+  payload_p += sizeof(uint8_t);
+
+  if (m_unchanged) return encoded;
+
+  uint8_t hasPredecessor = m_predecessor.has_value();
+  encodeSingleValue(&hasPredecessor, payload_p);
+  payload_p += sizeof(uint8_t);
+
+  encodeAddress(m_predecessor.value_or(NodeAddress{ NodeId{}, 0 }));
+
+  auto successorCount = static_cast<uint16_t>(m_successors.size());
+  encodeSingleValue(&successorCount, payload_p);
+  payload_p += sizeof(uint16_t);
+
+  for (const auto& successor : m_successors)
+  {
+    encodeAddress(successor);
+  }
+
+  return encoded;
+}
+
+void StabiliseResponseMessage::decode(EncodedMessage&& message)
+{
+  decodeHeaders(message);
+
+  auto* payload_p = &message.m_message[8];
+
+  auto decodeAddress = [&payload_p] ()
+  {
+    NodeAddress address;
+
+    decodeSingleValue(payload_p, &address.m_nodeId);
+    payload_p += sizeof(NodeId);
+
+    decodeSingleValue(payload_p, &address.m_ip);
+    payload_p += sizeof(uint32_t);
+
+    return address;
+  };
+
+  decodeSingleValue(payload_p, &m_sourceNodeId);
+  payload_p += sizeof(NodeId);
+
+  decodeSingleValue(payload_p, &m_requestId);
+  payload_p += sizeof(uint32_t);
+
+  decodeSingleValue(payload_p, &m_state);
+  payload_p += sizeof(uint64_t);
+
+  uint8_t unchanged;
+  decodeSingleValue(payload_p, &unchanged);
+  payload_p += sizeof(uint8_t);
+
+  m_unchanged = unchanged != 0;
+  m_predecessor.reset();
+  m_successors.clear();
+
+  // Never read past the end of a truncated or corrupt message
+  auto remaining = [&] { return static_cast<std::size_t>(message.m_message + message.m_length - payload_p); };
+  constexpr std::size_t addressLength = sizeof(NodeId) + sizeof(uint32_t);
+
+  if (m_unchanged || remaining() < sizeof(uint8_t) + addressLength + sizeof(uint16_t)) return;
+
+  uint8_t hasPredecessor;
+  decodeSingleValue(payload_p, &hasPredecessor);
+  payload_p += sizeof(uint8_t);
+
+  auto predecessor = decodeAddress();
+  if (hasPredecessor) m_predecessor = predecessor;
+
+  uint16_t successorCount;
+  decodeSingleValue(payload_p, &successorCount);
+  payload_p += sizeof(uint16_t);
+
+  for (uint16_t i = 0; i < successorCount && remaining() >= addressLength; i++)
+  {
+    m_successors.push_back(decodeAddress());
+  }
+}
+
+[[nodiscard]] const NodeId& StabiliseResponseMessage::sourceNodeId() const
+{
+  return m_sourceNodeId;
+}
+
+[[nodiscard]] uint32_t StabiliseResponseMessage::requestId() const
+{
+  return m_requestId;
+}
+
+[[nodiscard]] uint64_t StabiliseResponseMessage::state() const
+{
+  return m_state;
+}
+
+[[nodiscard]] bool StabiliseResponseMessage::unchanged() const
+{
+  return m_unchanged;
+}
+
+[[nodiscard]] const std::optional<NodeAddress>& StabiliseResponseMessage::predecessor() const
+{
+  return m_predecessor;
+}
+
+[[nodiscard]] const std::vector<NodeAddress>& StabiliseResponseMessage::successors() const
+{
+  return m_successors;
+}
+
+LeaveMessage::LeaveMessage(CommsVersion version,
+                           const NodeId& sourceNodeId,
+                           std::optional<NodeAddress> predecessor,
+                           std::vector<NodeAddress> successors)
+  : Message(version, MessageType::CHORD_LEAVE, payloadLength(successors.size())),
+    m_sourceNodeId(sourceNodeId),
+    m_predecessor(predecessor),
+    m_successors(std::move(successors))
+{
+}
+
+LeaveMessage::LeaveMessage(CommsVersion version)
+  : Message(version, MessageType::CHORD_LEAVE, payloadLength(0))
+{
+}
+
+std::size_t LeaveMessage::payloadLength(std::size_t successorCount)
+{
+  constexpr std::size_t addressLength = sizeof(NodeId) + sizeof(uint32_t);
+
+  return sizeof(NodeId) + sizeof(uint8_t) + addressLength + sizeof(uint16_t) + successorCount * addressLength;
+}
+
+[[nodiscard]] EncodedMessage LeaveMessage::encode() const
+{
+  EncodedMessage encoded = createEncodedMessage();
+
+  auto* payload_p = &encoded.m_message[8];
+
+  auto encodeAddress = [&payload_p] (const NodeAddress& address)
+  {
+    encodeSingleValue(&address.m_nodeId, payload_p);
+    payload_p += sizeof(NodeId);
+
+    encodeSingleValue(&address.m_ip, payload_p);
+    payload_p += sizeof(uint32_t);
+  };
+
+  encodeSingleValue(&m_sourceNodeId, payload_p);
+  payload_p += sizeof(NodeId);
+
+  uint8_t hasPredecessor = m_predecessor.has_value();
+  encodeSingleValue(&hasPredecessor, payload_p);
+  payload_p += sizeof(uint8_t);
+
+  encodeAddress(m_predecessor.value_or(NodeAddress{ NodeId{}, 0 }));
+
+  auto successorCount = static_cast<uint16_t>(m_successors.size());
+  encodeSingleValue(&successorCount, payload_p);
+  payload_p += sizeof(uint16_t);
+
+  for (const auto& successor : m_successors)
+  {
+    encodeAddress(successor);
+  }
+
+  return encoded;
+}
+
+void LeaveMessage::decode(EncodedMessage&& message)
+{
+  decodeHeaders(message);
+
+  auto* payload_p = &message.m_message[8];
+
+  auto decodeAddress = [&payload_p] ()
+  {
+    NodeAddress address;
+
+    decodeSingleValue(payload_p, &address.m_nodeId);
+    payload_p += sizeof(NodeId);
+
+    decodeSingleValue(payload_p, &address.m_ip);
+    payload_p += sizeof(uint32_t);
+
+    return address;
+  };
+
+  decodeSingleValue(payload_p, &m_sourceNodeId);
+  payload_p += sizeof(NodeId);
+
+  uint8_t hasPredecessor;
+  decodeSingleValue(payload_p, &hasPredecessor);
+  payload_p += sizeof(uint8_t);
+
+  auto predecessor = decodeAddress();
+  m_predecessor = hasPredecessor ? std::optional<NodeAddress>{ predecessor } : std::nullopt;
+
+  uint16_t successorCount;
+  decodeSingleValue(payload_p, &successorCount);
+  payload_p += sizeof(uint16_t);
+
+  // Never read past the end of a truncated or corrupt message
+  auto remaining = [&] { return static_cast<std::size_t>(message.m_message + message.m_length - payload_p); };
+  constexpr std::size_t addressLength = sizeof(NodeId) + sizeof(uint32_t);
+
+  m_successors.clear();
+
+  for (uint16_t i = 0; i < successorCount && remaining() >= addressLength; i++)
+  {
+    m_successors.push_back(decodeAddress());
+  }
+}
+
+[[nodiscard]] const NodeId& LeaveMessage::sourceNodeId() const
+{
+  return m_sourceNodeId;
+}
+
+[[nodiscard]] const std::optional<NodeAddress>& LeaveMessage::predecessor() const
+{
+  return m_predecessor;
+}
+
+[[nodiscard]] const std::vector<NodeAddress>& LeaveMessage::successors() const
+{
+  return m_successors;
+}
+
+} // namespace odd::chord
@@ -4,6 +4,8 @@
 #include "../comms/Comms.h"
 #include "NodeId.h"
 #include <cstdint>
+#include <optional>
+#include <vector>
 
 namespace odd::chord {
 
@@ -37,7 +39,8 @@ class FindSuccessorResponseMessage : public Message
                                  const NodeId& nodeId,
                                  const NodeId& sourceNodeId,
                                  uint32_t ipAddress,
-                                 uint32_t requestId);
+                                 uint32_t requestId,
+                                 uint32_t hops = 0);
     explicit FindSuccessorResponseMessage(CommsVersion version);
     ~FindSuccessorResponseMessage() = default;
 
@@ -49,11 +52,15 @@ class FindSuccessorResponseMessage : public Message
     [[nodiscard]] uint32_t ip() const;
     [[nodiscard]] uint32_t requestId() const;
 
+    // The number of nodes the request was forwarded through after the one this response is from
+    [[nodiscard]] uint32_t hops() const;
+
   private:
     NodeId m_nodeId;
     NodeId m_sourceNodeId;
     uint32_t m_ipAddress;
     uint32_t m_requestId;
+    uint32_t m_hops;
 };
 
 class NotifyMessage : public Message
@@ -177,6 +184,233 @@ class FindIpMessage : public Message
     uint32_t m_timeToLive;
 };
 
+class CheckPredecessorMessage : public Message
+{
+  public:
+    CheckPredecessorMessage(CommsVersion version,
+                            const NodeId& sourceNodeId,
+                            uint32_t sourceNodeIp,
+                            uint32_t requestId);
+    explicit CheckPredecessorMessage(CommsVersion version);
+    ~CheckPredecessorMessage() = default;
+
+    [[nodiscard]] EncodedMessage encode() const override;
+    void decode(EncodedMessage&& message) override;
+
+    [[nodiscard]] const NodeId& sourceNodeId() const;
+    [[nodiscard]] uint32_t sourceNodeIp() const;
+    [[nodiscard]] uint32_t requestId() const;
+
+  private:
+    NodeId m_sourceNodeId;
+    uint32_t m_sourceNodeIp;
+    uint32_t m_requestId;
+};
+
+class CheckPredecessorResponseMessage : public Message
+{
+  public:
+    CheckPredecessorResponseMessage(CommsVersion version,
+                                    const NodeId& sourceNodeId,
+                                    uint32_t requestId);
+    explicit CheckPredecessorResponseMessage(CommsVersion version);
+    ~CheckPredecessorResponseMessage() = default;
+
+    [[nodiscard]] EncodedMessage encode() const override;
+    void decode(EncodedMessage&& message) override;
+
+    [[nodiscard]] const NodeId& sourceNodeId() const;
+    [[nodiscard]] uint32_t requestId() const;
+
+  private:
+    NodeId m_sourceNodeId;
+    uint32_t m_requestId;
+};
+
+class BootstrapMessage : public Message
+{
+  public:
+    BootstrapMessage(CommsVersion version,
+                     const NodeId& sourceNodeId,
+                     uint32_t requestId);
+    explicit BootstrapMessage(CommsVersion version);
+    ~BootstrapMessage() = default;
+
+    [[nodiscard]] EncodedMessage encode() const override;
+    void decode(EncodedMessage&& message) override;
+
+    [[nodiscard]] const NodeId& sourceNodeId() const;
+    [[nodiscard]] uint32_t requestId() const;
+
+  private:
+    NodeId m_sourceNodeId;
+    uint32_t m_requestId;
+};
+
+struct NodeAddress
+{
+  NodeId m_nodeId;
+  uint32_t m_ip;
+};
+
+/*
+ * The routing state of a node, sent to a node that has just joined in front of it so that the new
+ * node can seed its own fingers. Variable length:
+ *
+ * source node ID, request ID
+ * has predecessor (1 byte), predecessor address
+ * successor count (2 bytes), successor addresses
+ * finger count (2 bytes), addresses of the distinct fingers
+ */
+class BootstrapResponseMessage : public Message
+{
+  public:
+    BootstrapResponseMessage(CommsVersion version,
+                             const NodeId& sourceNodeId,
+                             uint32_t requestId,
+                             std::optional<NodeAddress> predecessor,
+                             std::vector<NodeAddress> successors,
+                             std::vector<NodeAddress> fingers);
+    explicit BootstrapResponseMessage(CommsVersion version);
+    ~BootstrapResponseMessage() = default;
+
+    [[nodiscard]] EncodedMessage encode() const override;
+    void decode(EncodedMessage&& message) override;
+
+    [[nodiscard]] const NodeId& sourceNodeId() const;
+    [[nodiscard]] uint32_t requestId() const;
+    [[nodiscard]] const std::optional<NodeAddress>& predecessor() const;
+    [[nodiscard]] const std::vector<NodeAddress>& successors() const;
+    [[nodiscard]] const std::vector<NodeAddress>& fingers() const;
+
+  private:
+    static std::size_t payloadLength(std::size_t successorCount, std::size_t fingerCount);
+
+    NodeId m_sourceNodeId;
+    uint32_t m_requestId;
+    std::optional<NodeAddress> m_predecessor;
+    std::vector<NodeAddress> m_successors;
+    std::vector<NodeAddress> m_fingers;
+};
+
+/*
+ * One stabilise round: asks the successor for its neighbours and notifies it of the sender as a
+ * possible predecessor, replacing GetNeighbours followed by Notify.
+ *
+ * The known state is the state from the last full response the sender had from this node, zero if
+ * none. If it is still current the response only says so.
+ *
+ * The sender's address is carried so that the successor can answer, and pass the sender on as its
+ * predecessor, without having to look the address up.
+ */
+class StabiliseMessage : public Message
+{
+  public:
+    StabiliseMessage(CommsVersion version,
+                     const NodeId& sourceNodeId,
+                     uint32_t sourceNodeIp,
+                     uint32_t requestId,
+                     uint64_t knownState);
+    explicit StabiliseMessage(CommsVersion version);
+    ~StabiliseMessage() = default;
+
+    [[nodiscard]] EncodedMessage encode() const override;
+    void decode(EncodedMessage&& message) override;
+
+    [[nodiscard]] const NodeId& sourceNodeId() const;
+    [[nodiscard]] uint32_t sourceNodeIp() const;
+    [[nodiscard]] uint32_t requestId() const;
+    [[nodiscard]] uint64_t knownState() const;
+
+  private:
+    NodeId m_sourceNodeId;
+    uint32_t m_sourceNodeIp;
+    uint32_t m_requestId;
+    uint64_t m_knownState;
+};
+
+/*
+ * The answer to a StabiliseMessage. Variable length:
+ *
+ * source node ID, request ID, state (8 bytes), unchanged (1 byte)
+ * and unless unchanged:
+ * has predecessor (1 byte), predecessor address
+ * successor count (2 bytes), successor addresses
+ */
+class StabiliseResponseMessage : public Message
+{
+  public:
+    // The full response
+    StabiliseResponseMessage(CommsVersion version,
+                             const NodeId& sourceNodeId,
+                             uint32_t requestId,
+                             uint64_t state,
+                             std::optional<NodeAddress> predecessor,
+                             std::vector<NodeAddress> successors);
+
+    // The response when the state the requester knows is still current
+    StabiliseResponseMessage(CommsVersion version,
+                             const NodeId& sourceNodeId,
+                             uint32_t requestId,
+                             uint64_t state);
+    explicit StabiliseResponseMessage(CommsVersion version);
+    ~StabiliseResponseMessage() = default;
+
+    [[nodiscard]] EncodedMessage encode() const override;
+    void decode(EncodedMessage&& message) override;
+
+    [[nodiscard]] const NodeId& sourceNodeId() const;
+    [[nodiscard]] uint32_t requestId() const;
+    [[nodiscard]] uint64_t state() const;
+    [[nodiscard]] bool unchanged() const;
+    [[nodiscard]] const std::optional<NodeAddress>& predecessor() const;
+    [[nodiscard]] const std::vector<NodeAddress>& successors() const;
+
+  private:
+    static std::size_t payloadLength(bool unchanged, std::size_t successorCount);
+
+    NodeId m_sourceNodeId;
+    uint32_t m_requestId;
+    uint64_t m_state;
+    bool m_unchanged;
+    std::optional<NodeAddress> m_predecessor;
+    std::vector<NodeAddress> m_successors;
+};
+
+/*
+ * Sent by a node that is leaving the ring to every node it routes through. The predecessor and
+ * successor use the addresses to close the ring around it, everyone else takes it out of their
+ * routing state. Variable length:
+ *
+ * source node ID
+ * has predecessor (1 byte), predecessor address
+ * successor count (2 bytes), successor addresses
+ */
+class LeaveMessage : public Message
+{
+  public:
+    LeaveMessage(CommsVersion version,
+                 const NodeId& sourceNodeId,
+                 std::optional<NodeAddress> predecessor,
+                 std::vector<NodeAddress> successors);
+    explicit LeaveMessage(CommsVersion version);
+    ~LeaveMessage() = default;
+
+    [[nodiscard]] EncodedMessage encode() const override;
+    void decode(EncodedMessage&& message) override;
+
+    [[nodiscard]] const NodeId& sourceNodeId() const;
+    [[nodiscard]] const std::optional<NodeAddress>& predecessor() const;
+    [[nodiscard]] const std::vector<NodeAddress>& successors() const;
+
+  private:
+    static std::size_t payloadLength(std::size_t successorCount);
+
+    NodeId m_sourceNodeId;
+    std::optional<NodeAddress> m_predecessor;
+    std::vector<NodeAddress> m_successors;
+};
+
 } // namespace odd::chord
 
 #endif // CHORD_MESSAGING_H_
@@ -11,7 +11,10 @@ ChordNode::ChordNode(const std::string& nodeName,
                      const std::string& ip,
                      uint16_t port,
                      const ConnectionManagerFactory& connectionManagerFactory,
-                     std::unique_ptr<logging::Logger> logger)
+                     std::unique_ptr<logging::Logger> logger,
+                     ChordConfig config,
+                     std::unique_ptr<Executor_I> executor,
+                     std::shared_ptr<const Clock_I> clock)
   : m_nodeName(nodeName),
     m_ipAddress{convertIpAddressToInteger(ip)},
     m_id(m_ipAddress),
@@ -21,7 +24,12 @@ ChordNode::ChordNode(const std::string& nodeName,
     m_connectionManager(connectionManagerFactory(NodeId{m_ipAddress}, m_ipAddress, port)),
     m_logger(std::move(logger)),
     m_logPrefix(nodeName + " - " + m_id.toString() + ": "),
-    m_running(true)
+    m_config(config),
+    m_peerLatency(config.m_initialRequestTimeout, config.m_minRequestTimeout, config.m_maxRequestTimeout),
+    m_stabiliseSchedule(config.m_minMaintenanceInterval, config.m_maxMaintenanceInterval, config.m_maintenanceBackoffFactor),
+    m_fingerSchedule(config.m_minMaintenanceInterval, config.m_maxMaintenanceInterval, config.m_maintenanceBackoffFactor),
+    m_clock(clock ? std::move(clock) : std::make_shared<SteadyClock>()),
+    m_executor(executor ? std::move(executor) : std::make_unique<ThreadExecutor>())
 {
   initialiseFingerTable(m_fingerTable, m_id);
 
@@ -32,14 +40,21 @@ ChordNode::ChordNode(const std::string& nodeName,
 
   m_connectionManager->registerReceiveHandler(onReceiveCallback);
 
-  m_workThread = std::thread{&ChordNode::workThread, this};
+  OnEncodedMessageCallback onEncodedMessageCallback = [this] (EncodedMessage&& encoded)
+  {
+    m_logger->log(m_logPrefix + "receiving message");
+    handleReceivedMessage(std::move(encoded));
+  };
+
+  m_connectionManager->registerEncodedMessageHandler(onEncodedMessageCallback);
+
+  m_executor->start([this] { return step(); });
 }
 
 ChordNode::~ChordNode()
 {
-  m_running = false;
   m_connectionManager->stop();
-  m_workThread.join();
+  m_executor->stop();
 }
 
 uint32_t ChordNode::convertIpAddressToInteger(const std::string& ipAddress)
@@ -51,6 +66,7 @@ uint32_t ChordNode::convertIpAddressToInteger(const std::string& ipAddress)
 
 void ChordNode::create()
 {
+  m_left = false;
   m_predecessor = NodeId{};
   m_hasPredecessor = false;
   m_successor = m_id;
@@ -58,6 +74,8 @@ void ChordNode::create()
 
 void ChordNode::join(const std::string &knownNodeIpAddress)
 {
+  m_left = false;
+
   std::function<bool()> joinTask = [this, knownNodeIpAddress] ()
   {
     m_logger->log(m_logPrefix + "Running join task");
@@ -80,16 +98,14 @@ void ChordNode::join(const std::string &knownNodeIpAddress)
 
     m_joinFuture = m_joinPromise.get_future();
 
-    JoinMessage joinMessage{ CommsVersion::V1, m_connectionManager->ip(), requestId };
-
     m_logger->log(m_logPrefix + "JoinTask: sending JoinMessage");
 
-    m_connectionManager->send(knownNodeId, joinMessage);
+    sendRequest(requestId, knownNodeId);
 
     return true;
   };
 
-  m_queue.putWork(joinTask);
+  queueWork(joinTask);
 
   auto ip = convertIpAddressToInteger(knownNodeIpAddress);
   NodeId knownNodeId{ ip };
@@ -105,12 +121,21 @@ void ChordNode::join(const std::string &knownNodeIpAddress)
       // if the future can't be found then do not load this task again.
       if (it == m_findSuccessorFutures.end()) return true;
 
-      auto futureStatus = it->second.wait_for(std::chrono::milliseconds{20});
+      auto futureStatus = it->second.wait_for(std::chrono::milliseconds{0});
 
       // future not ready, run the task again
       if (futureStatus != std::future_status::ready) return false;
 
-      m_successor = it->second.get();
+      auto successor = it->second.get();
+      m_findSuccessorFutures.erase(it);
+
+      if (isPurged(successor)) return true;
+
+      m_successor = successor;
+      pinRoutingConnections();
+      ringChanged();
+
+      if (m_successor != m_id) bootstrapFrom(m_successor);
 
       m_logger->log(m_logPrefix + "first findSuccessor has found successor, " + m_successor.toString());
 
@@ -123,7 +148,86 @@ void ChordNode::join(const std::string &knownNodeIpAddress)
     return true;
   };
 
-  m_queue.putWork(findSuccessorTask);
+  queueWork(findSuccessorTask);
+}
+
+void ChordNode::lookup(const NodeId& key, LookupCallback callback)
+{
+  std::function<bool()> lookupTask = [this, key, callback = std::move(callback)] () mutable -> bool
+  {
+    auto requestId = findSuccessor(key);
+
+    // This node knew the answer without asking anyone
+    if (auto future = m_findSuccessorFutures.find(requestId);
+        future != m_findSuccessorFutures.end() &&
+        future->second.wait_for(std::chrono::milliseconds{0}) == std::future_status::ready)
+    {
+      auto successor = future->second.get();
+      m_findSuccessorFutures.erase(future);
+
+      callback(successor, 0);
+      return true;
+    }
+
+    m_lookups.emplace(requestId, std::move(callback));
+
+    return true;
+  };
+
+  queueWork(lookupTask);
+}
+
+void ChordNode::leave()
+{
+  m_left = true;
+
+  m_executor->runAndWait([this] { leaveRing(); });
+}
+
+void ChordNode::adoptRingState(const RingState& state)
+{
+  m_left = false;
+
+  m_executor->runAndWait([this, &state]
+  {
+    auto learn = [this] (const NodeAddress& address)
+    {
+      if (address.m_nodeId != m_id) m_connectionManager->insert(address.m_nodeId, address.m_ip, 0);
+    };
+
+    m_hasPredecessor = state.m_predecessor.has_value();
+    m_predecessor = m_hasPredecessor ? state.m_predecessor->m_nodeId : NodeId{};
+
+    if (m_hasPredecessor) learn(*state.m_predecessor);
+
+    m_successor = m_id;
+    m_successorList.clear();
+
+    // The list holds the nodes after the successor, as the stabilise responses leave it
+    for (const auto& successor : state.m_successors)
+    {
+      learn(successor);
+
+      if (&successor == &state.m_successors.front())
+      {
+        m_successor = successor.m_nodeId;
+      }
+      else
+      {
+        m_successorList.push_back(successor.m_nodeId);
+      }
+    }
+
+    for (std::size_t i = 0; i < m_fingerTable.m_fingers.size() && i < state.m_fingers.size(); i++)
+    {
+      // Fingers come in runs of the same node
+      if (i == 0 || state.m_fingers[i].m_nodeId != state.m_fingers[i - 1].m_nodeId) learn(state.m_fingers[i]);
+
+      m_fingerTable.m_fingers[i].m_nodeId = state.m_fingers[i].m_nodeId;
+    }
+
+    pinRoutingConnections();
+  });
 }
 
 const NodeId& ChordNode::getId() const
@@ -131,6 +235,11 @@ const NodeId& ChordNode::getId() const
   return m_id;
 }
 
+uint32_t ChordNode::getIpAddress() const
+{
+  return m_ipAddress;
+}
+
 const NodeId &ChordNode::getPredecessorId() const
 {
   return m_predecessor;
@@ -141,6 +250,11 @@ const NodeId &ChordNode::getSuccessorId() const
   return m_successor;
 }
 
+const FingerTable& ChordNode::getFingerTable() const
+{
+  return m_fingerTable;
+}
+
 void ChordNode::receive(uint8_t* message, std::size_t messageLength)
 {
   m_logger->log(m_logPrefix + "receiving message");
@@ -149,23 +263,61 @@ void ChordNode::receive(uint8_t* message, std::size_t messageLength)
   handleReceivedMessage(std::move(encoded));
 }
 
-void ChordNode::workThread()
+Clock_I::Clock::time_point ChordNode::step()
 {
-  while (m_running)
+  auto queued = m_queue.size();
+  auto finished = m_queue.doQueuedWork();
+
+  auto now = m_clock->now();
+
+  m_timers.runExpired(now);
+
+  if (m_stabiliseSchedule.due(now))
   {
-    m_queue.doNextWork();
-    if (std::chrono::high_resolution_clock::now() - m_lastManageTime > std::chrono::seconds{1})
-    {
-      stabilise();
-      fixFingers();
-      m_lastManageTime = std::chrono::high_resolution_clock::now();
-    }
+    m_stabiliseSchedule.started(now);
+    stabilise();
+  }
+
+  // A round that is still running is not due again until it finishes
+  if (m_fingerSchedule.due(now) && m_fingerLookupsOutstanding == 0)
+  {
+    m_fingerSchedule.started(now);
+    fixFingers();
+  }
+
+  if (now - m_lastManageTime >= std::chrono::seconds{1})
+  {
+    checkLiveness();
+    m_lastManageTime = now;
+  }
 
+  // Work that finished may be what the rest of the queue was waiting for, and new work has not been
+  // tried yet, otherwise the queue waits for the next message or timer
+  if (finished > 0 ? m_queue.hasWork() : m_queue.size() > queued)
+  {
+    return now;
   }
+
+  auto next = std::min(m_stabiliseSchedule.next(), m_lastManageTime + std::chrono::seconds{1});
+
+  // A finger round that is still running is started again by the lookups' responses or timeouts
+  if (m_fingerLookupsOutstanding == 0) next = std::min(next, m_fingerSchedule.next());
+
+  if (auto deadline = m_timers.nextDeadline()) next = std::min(next, *deadline);
+
+  return next;
+}
+
+void ChordNode::queueWork(std::function<bool()> work)
+{
+  m_queue.putWork(std::move(work));
+  m_executor->wake();
 }
 
 void ChordNode::doFindSuccessor(const FindSuccessorMessage& message)
 {
+  heardFrom(message.sourceNodeId());
+
   m_logger->log(m_logPrefix + "finding successor for " + message.queryNodeId().toString());
 
   if (containedInLeftOpenInterval(m_id, m_successor, message.queryNodeId()))
@@ -177,10 +329,7 @@ void ChordNode::doFindSuccessor(const FindSuccessorMessage& message)
 
     m_logger->log(m_logPrefix + "sending FindSuccessorResponse");
 
-    if (not m_connectionManager->send(message.sourceNodeId(), response))
-    {
-      findIp(message.sourceNodeId());
-    }
+    sendOrFindIp(message.sourceNodeId(), response);
 
     return;
   }
@@ -197,17 +346,12 @@ void ChordNode::doFindSuccessor(const FindSuccessorMessage& message)
   pending.m_nodeId = nodeId;
   pending.m_hasChain = true;
   pending.m_chainingDestination = message.sourceNodeId();
+  pending.m_chainingRequestId = message.requestId();
+  pending.m_query = message.queryNodeId();
 
   m_pendingResponses.emplace(requestId, pending);
 
-  FindSuccessorMessage messageToForward{ CommsVersion::V1, message.queryNodeId(), m_id, requestId };
-
-  m_logger->log(m_logPrefix + "sending FindSuccessorMessage");
-  m_connectionManager->send(nodeId, messageToForward);
-  if (not m_connectionManager->send(nodeId, messageToForward))
-  {
-    findIp(nodeId);
-  }
+  sendRequest(requestId, nodeId);
 }
 
 void ChordNode::handleFindSuccessorResponse(const FindSuccessorResponseMessage& message)
@@ -220,6 +364,8 @@ void ChordNode::handleFindSuccessorResponse(const FindSuccessorResponseMessage&
     return;
   }
 
+  completeRequest(message.requestId(), message.sourceNodeId());
+
   if (it->second.m_hasChain)
   {
     // This message is not for us, forward it on
@@ -227,20 +373,20 @@ void ChordNode::handleFindSuccessorResponse(const FindSuccessorResponseMessage&
                                                    message.nodeId(),
                                                    m_id,
                                                    message.ip(),
-                                                   message.requestId() };
+                                                   it->second.m_chainingRequestId,
+                                                   message.hops() + 1 };
 
     m_logger->log(m_logPrefix + "sending FindSuccessorResponse");
 
-    if (not m_connectionManager->send(it->second.m_chainingDestination, messageToForward))
-    {
-      findIp(it->second.m_chainingDestination);
-    }
+    sendOrFindIp(it->second.m_chainingDestination, messageToForward);
 
     m_pendingResponses.erase(it);
 
     return;
   }
 
+  m_pendingResponses.erase(it);
+
   // This message is for us, there should be a promise waiting for the result
   auto promiseIter = m_findSuccessorPromises.find(message.requestId());
 
@@ -252,16 +398,28 @@ void ChordNode::handleFindSuccessorResponse(const FindSuccessorResponseMessage&
 
   promiseIter->second.set_value(message.nodeId());
 
-  m_successor = message.nodeId();
+  m_findSuccessorPromises.erase(promiseIter);
+
+  if (auto lookup = m_lookups.find(message.requestId()); lookup != m_lookups.end())
+  {
+    auto callback = std::move(lookup->second);
+    m_lookups.erase(lookup);
+    m_findSuccessorFutures.erase(message.requestId());
+
+    callback(message.nodeId(), message.hops() + 1);
+  }
+
+  if (isPurged(message.nodeId())) return;
 
+  // Most lookups are for fingers, the successor is only changed by the task waiting on a lookup
+  // for this node's own ID
   if (message.nodeId() != m_id)
   {
-    m_connectionManager->insert(message.nodeId(), message.ip(), 0);
+    // The responder may not know the address of the node it answered with
+    if (message.ip() != 0) m_connectionManager->insert(message.nodeId(), message.ip(), 0);
+
     sendConnect(message.nodeId());
   }
-
-  m_logger->log(m_logPrefix + "m_successor has been set to " + m_successor.toString());
-  m_findSuccessorPromises.erase(promiseIter);
 }
 
 uint32_t ChordNode::findSuccessor(const NodeId& hash)
@@ -278,6 +436,13 @@ uint32_t ChordNode::findSuccessor(const NodeId& nodeToQuery, const NodeId& hash)
 
   m_findSuccessorFutures.emplace(requestId, std::move(findSuccessorFuture));
 
+  // Keys between the predecessor and this node are this node's, nobody else can answer better
+  if (m_hasPredecessor && containedInLeftOpenInterval(m_predecessor, m_id, hash))
+  {
+    findSuccessorPromise.set_value(m_id);
+    return requestId;
+  }
+
   // if the node to query is the current node ID then there is no need to do the RPC
   if (nodeToQuery == m_id)
   {
@@ -289,82 +454,17 @@ uint32_t ChordNode::findSuccessor(const NodeId& nodeToQuery, const NodeId& hash)
 
   PendingMessageResponse pending;
   pending.m_type = MessageType::CHORD_FIND_SUCCESSOR_RESPONSE;
-  pending.m_nodeId = hash;
-  pending.m_hasChain = false;
-
-  m_pendingResponses.emplace(requestId, pending);
-
-  FindSuccessorMessage message{ CommsVersion::V1, hash, m_id, requestId };
-
-  m_logger->log(m_logPrefix + "sending FindSuccessorMessage");
-
-  if (not m_connectionManager->send(nodeToQuery, message))
-  {
-    findIp(nodeToQuery);
-  }
-
-  return requestId;
-}
-
-uint32_t ChordNode::getNeighbours(const NodeId& nodeToQuery)
-{
-  auto requestId = getNextAvailableRequestId();
-
-  m_logger->log(m_logPrefix + "get neighbours, request ID " + std::to_string(requestId));
-
-  std::promise<Neighbours> getNeighboursPromise;
-  std::future<Neighbours> getNeighboursFuture = getNeighboursPromise.get_future();
-
-  m_getNeighboursPromises.emplace(requestId, std::move(getNeighboursPromise));
-  m_getNeighboursFutures.emplace(requestId, std::move(getNeighboursFuture));
-
-  m_logger->log(m_logPrefix + "getNeighbours node to query " + nodeToQuery.toString());
-
-  if (nodeToQuery == m_id)
-  {
-    m_logger->log(m_logPrefix + "handling getNeigbours locally");
-    Neighbours myNeighbours;
-    myNeighbours.hasPredecessor = m_hasPredecessor;
-    myNeighbours.predecessor = m_predecessor;
-    myNeighbours.successor = m_successor;
-
-    m_getNeighboursPromises.find(requestId)->second.set_value(myNeighbours);
-    return requestId;
-  }
-
-  PendingMessageResponse pending;
-  pending.m_type = MessageType::CHORD_GET_NEIGHBOURS_RESPONSE;
   pending.m_nodeId = nodeToQuery;
   pending.m_hasChain = false;
-
-  m_logger->log(m_logPrefix + "created a pending response for " + pending.m_nodeId.toString());
+  pending.m_query = hash;
 
   m_pendingResponses.emplace(requestId, pending);
 
-  GetNeighboursMessage message{ CommsVersion::V1, m_id, requestId };
-
-  m_logger->log(m_logPrefix + "sending GetNeighboursMessage");
-
-  if (not m_connectionManager->send(nodeToQuery, message))
-  {
-    findIp(nodeToQuery);
-  }
+  sendRequest(requestId, nodeToQuery);
 
   return requestId;
 }
 
-void ChordNode::notify(const NodeId& nodeId)
-{
-  NotifyMessage message{ CommsVersion::V1, m_id };
-
-  m_logger->log(m_logPrefix + "sending NotifyMessage");
-
-  if (not m_connectionManager->send(nodeId, message))
-  {
-    findIp(nodeId);
-  }
-}
-
 const NodeId &ChordNode::closestPrecedingFinger(const NodeId &id)
 {
   for (int i = 159; i >= 0; i--)
@@ -382,6 +482,8 @@ const NodeId &ChordNode::closestPrecedingFinger(const NodeId &id)
 
 void ChordNode::handleReceivedMessage(EncodedMessage&& encoded)
 {
+  if (m_left) return;
+
   // Ignore comms version for now, this will probably be handled differently at a later time
 
   // get the message type, which is a uint32_t starting at encoded.message[2]
@@ -403,7 +505,7 @@ void ChordNode::handleReceivedMessage(EncodedMessage&& encoded)
         return true;
       };
 
-      m_queue.putWork(work);
+      queueWork(work);
       break;
     }
     case MessageType::JOIN_RESPONSE:
@@ -419,7 +521,7 @@ void ChordNode::handleReceivedMessage(EncodedMessage&& encoded)
         return true;
       };
 
-      m_queue.putWork(work);
+      queueWork(work);
       break;
     }
     case MessageType::CHORD_FIND_SUCCESSOR:
@@ -435,7 +537,7 @@ void ChordNode::handleReceivedMessage(EncodedMessage&& encoded)
         return true;
       };
 
-      m_queue.putWork(work);
+      queueWork(work);
       break;
     }
 
@@ -452,7 +554,7 @@ void ChordNode::handleReceivedMessage(EncodedMessage&& encoded)
         return true;
       };
 
-      m_queue.putWork(work);
+      queueWork(work);
       break;
     }
 
@@ -469,7 +571,75 @@ void ChordNode::handleReceivedMessage(EncodedMessage&& encoded)
         return true;
       };
 
-      m_queue.putWork(work);
+      queueWork(work);
+      break;
+    }
+
+    case MessageType::CHORD_CHECK_PREDECESSOR:
+    {
+      m_logger->log(m_logPrefix + "received chord check predecessor request");
+      CheckPredecessorMessage message{ CommsVersion::V1 };
+
+      message.decode(std::move(encoded));
+
+      std::function<bool()> work = [this, message]
+      {
+        handleCheckPredecessor(message);
+        return true;
+      };
+
+      queueWork(work);
+      break;
+    }
+
+    case MessageType::CHORD_CHECK_PREDECESSOR_RESPONSE:
+    {
+      m_logger->log(m_logPrefix + "received chord check predecessor response");
+      CheckPredecessorResponseMessage message{ CommsVersion::V1 };
+
+      message.decode(std::move(encoded));
+
+      std::function<bool()> work = [this, message]
+      {
+        handleCheckPredecessorResponse(message);
+        return true;
+      };
+
+      queueWork(work);
+      break;
+    }
+
+    case MessageType::CHORD_BOOTSTRAP:
+    {
+      m_logger->log(m_logPrefix + "received chord bootstrap request");
+      BootstrapMessage message{ CommsVersion::V1 };
+
+      message.decode(std::move(encoded));
+
+      std::function<bool()> work = [this, message]
+      {
+        handleBootstrap(message);
+        return true;
+      };
+
+      queueWork(work);
+      break;
+    }
+
+    case MessageType::CHORD_BOOTSTRAP_RESPONSE:
+    {
+      m_logger->log(m_logPrefix + "received chord bootstrap response");
+      BootstrapResponseMessage message{ CommsVersion::V1 };
+
+      message.decode(std::move(encoded));
+
+      std::function<bool()> work = [this, message]
+      {
+        handleBootstrapResponse(message);
+        return true;
+      };
+
+      queueWork(work);
       break;
     }
 
@@ -486,24 +656,58 @@ void ChordNode::handleReceivedMessage(EncodedMessage&& encoded)
         return true;
       };
 
-      m_queue.putWork(work);
+      queueWork(work);
+      break;
+    }
+
+    case MessageType::CHORD_LEAVE:
+    {
+      m_logger->log(m_logPrefix + "received chord leave");
+      LeaveMessage message{ CommsVersion::V1 };
+
+      message.decode(std::move(encoded));
+
+      std::function<bool()> work = [this, message]
+      {
+        handleLeave(message);
+        return true;
+      };
+
+      queueWork(work);
+      break;
+    }
+
+    case MessageType::CHORD_STABILISE:
+    {
+      m_logger->log(m_logPrefix + "received chord stabilise request");
+      StabiliseMessage message{ CommsVersion::V1 };
+
+      message.decode(std::move(encoded));
+
+      std::function<bool()> work = [this, message]
+      {
+        handleStabilise(message);
+        return true;
+      };
+
+      queueWork(work);
       break;
     }
 
-    case MessageType::CHORD_GET_NEIGHBOURS_RESPONSE:
+    case MessageType::CHORD_STABILISE_RESPONSE:
     {
-      m_logger->log(m_logPrefix + "received chord get neighbours response") ;
-      GetNeighboursResponseMessage message{ CommsVersion::V1 };
+      m_logger->log(m_logPrefix + "received chord stabilise response");
+      StabiliseResponseMessage message{ CommsVersion::V1 };
 
       message.decode(std::move(encoded));
 
       std::function<bool()> work = [this, message]
       {
-        handleGetNeighboursResponse(message);
+        handleStabiliseResponse(message);
         return true;
       };
 
-      m_queue.putWork(work);
+      queueWork(work);
       break;
     }
 
@@ -520,7 +724,7 @@ void ChordNode::handleReceivedMessage(EncodedMessage&& encoded)
         return true;
       };
 
-      m_queue.putWork(work);
+      queueWork(work);
       break;
     }
 
@@ -537,7 +741,7 @@ void ChordNode::handleReceivedMessage(EncodedMessage&& encoded)
         return true;
       };
 
-      m_queue.putWork(work);
+      queueWork(work);
       break;
     }
     default:
@@ -569,23 +773,45 @@ void ChordNode::handleJoinRequest(const JoinMessage& message)
 
 void ChordNode::handleJoinResponse(const JoinResponseMessage& message)
 {
-  m_joinPromise.set_value(NodeId{ message.ip() });
+  auto it = m_pendingResponses.find(message.requestId());
+
+  // A response to a join request that was sent again, the first response has already been handled
+  if (it == m_pendingResponses.end()) return;
+
+  NodeId responder{ message.ip() };
+
+  completeRequest(message.requestId(), responder);
+  m_pendingResponses.erase(it);
+
+  m_joinPromise.set_value(responder);
 }
 
 void ChordNode::handleNotify(const NotifyMessage& message)
 {
+  heardFrom(message.nodeId());
+  considerPredecessor(message.nodeId());
+}
+
+void ChordNode::considerPredecessor(const NodeId& nodeId)
+{
+  if (nodeId == m_id) return;
+
   if (not m_hasPredecessor ||
-      (containedInOpenInterval(m_predecessor, m_id, message.nodeId())))
+      (containedInOpenInterval(m_predecessor, m_id, nodeId)))
   {
-    m_logger->log(m_logPrefix + "pred " + m_predecessor.toString() + " id " + m_id.toString() + " mess " + message.nodeId().toString());
-    m_predecessor = message.nodeId();
+    m_logger->log(m_logPrefix + "pred " + m_predecessor.toString() + " id " + m_id.toString() + " mess " + nodeId.toString());
+    m_predecessor = nodeId;
     m_hasPredecessor = true;
+    pinRoutingConnections();
+    ringChanged();
     m_logger->log(m_logPrefix + "Notify: predecessor set to: " + m_predecessor.toString());
   }
 }
 
 void ChordNode::handleGetNeighbours(const GetNeighboursMessage& message)
 {
+  heardFrom(message.sourceNodeId());
+
   GetNeighboursResponseMessage response{ CommsVersion::V1 };
 
   if (m_hasPredecessor)
@@ -599,38 +825,7 @@ void ChordNode::handleGetNeighbours(const GetNeighboursMessage& message)
   }
 
   m_logger->log(m_logPrefix + "sending GetNeigboursResponse");
-  if (not m_connectionManager->send(message.sourceNodeId(), response))
-  {
-    findIp(message.sourceNodeId());
-  }
-}
-
-void ChordNode::handleGetNeighboursResponse(const GetNeighboursResponseMessage& message)
-{
-  auto it = m_pendingResponses.find(message.requestId());
-
-  if (it == m_pendingResponses.end())
-  {
-    m_logger->log(m_logPrefix + "Unexpected get neighbours response from node: " + message.sourceNodeId().toString() + ", id " + std::to_string(message.requestId()));
-    return;
-  }
-
-  // This message is for us, there should be a promise waiting for the result
-  auto promiseIter = m_getNeighboursPromises.find(message.requestId());
-
-  if (promiseIter == m_getNeighboursPromises.end())
-  {
-    std::cout << "Expected promise, but there wasn't one" << std::endl;
-    return;
-  }
-
-  Neighbours neighbours;
-  neighbours.predecessor = message.predecessor();
-  neighbours.successor = message.successor();
-  neighbours.hasPredecessor = message.hasPredecessor();
-  promiseIter->second.set_value(neighbours);
-
-  m_getNeighboursPromises.erase(promiseIter);
+  sendOrFindIp(message.sourceNodeId(), response);
 }
 
 void ChordNode::sendConnect(const NodeId& destination)
@@ -651,34 +846,49 @@ void ChordNode::sendConnect(const NodeId& destination, const NodeId& nodeId, uin
 void ChordNode::handleConnectMessage(const ConnectMessage& message)
 {
   m_connectionManager->insert(message.nodeId(), message.ip(), 0);
+  addressFound(message.nodeId());
 }
 
-void ChordNode::findIp(const NodeId& nodeId)
+template <typename MessageT>
+void ChordNode::sendOrFindIp(const NodeId& destination, const MessageT& message)
 {
-  FindIpMessage message{ CommsVersion::V1, nodeId, m_id, m_connectionManager->ip(), 5 };
+  if (m_connectionManager->send(destination, message)) return;
+
+  findIp(destination, [this, destination, message] { m_connectionManager->send(destination, message); });
+}
+
+void ChordNode::findIp(const NodeId& nodeId, std::function<void()> send)
+{
+  auto [it, inserted] = m_addressLookups.try_emplace(nodeId);
+
+  it->second.m_sends.push_back(std::move(send));
+
+  if (not inserted) return;
+
+  it->second.m_timeoutTimer = m_timers.schedule(m_clock->now() + m_config.m_addressLookupTimeout, [this, nodeId]
+  {
+    m_logger->log(m_logPrefix + "could not find ip for node " + nodeId.toString());
+    m_addressLookups.erase(nodeId);
+  });
 
   m_logger->log(m_logPrefix + "sending find ip for node " + nodeId.toString() + " our ip is " + std::to_string(m_connectionManager->ip()));
 
-  m_connectionManager->broadcast(message);
+  routeFindIp(FindIpMessage{ CommsVersion::V1, nodeId, m_id, m_connectionManager->ip(), m_config.m_addressLookupHopLimit });
 }
 
 void ChordNode::handleFindIp(const FindIpMessage& message)
 {
-  if (message.timeToLive() == 0) return;
-
-  uint32_t ip = m_connectionManager->ip(message.nodeId());
+  uint32_t ip = message.nodeId() == m_id ? m_connectionManager->ip() : m_connectionManager->ip(message.nodeId());
 
   if (ip == 0)
   {
-    m_logger->log(m_logPrefix + "could not find ip address, broadcasting again, ttl " + std::to_string(message.timeToLive()));
-    FindIpMessage messageToForward{ CommsVersion::V1,
-                                    message.nodeId(),
-                                    message.sourceNodeId(),
-                                    message.sourceNodeIp(),
-                                    message.timeToLive() - 1 };
-
-    m_connectionManager->broadcast(messageToForward);
+    if (message.timeToLive() == 0) return;
 
+    routeFindIp(FindIpMessage{ CommsVersion::V1,
+                               message.nodeId(),
+                               message.sourceNodeId(),
+                               message.sourceNodeIp(),
+                               message.timeToLive() - 1 });
     return;
   }
 
@@ -690,10 +900,47 @@ void ChordNode::handleFindIp(const FindIpMessage& message)
   sendConnect(message.sourceNodeId(), message.nodeId(), ip);
 }
 
-uint32_t ChordNode::getNextAvailableRequestId()
+void ChordNode::routeFindIp(const FindIpMessage& message)
 {
-  // Zero is a null value for requestId, so always skip it
-  if (m_requestIdCounter == 0) m_requestIdCounter++;
+  // The node would be this node's successor, which knows its successor's address, so it is not in
+  // the ring as far as this node can tell
+  if (containedInLeftOpenInterval(m_id, m_successor, message.nodeId()))
+  {
+    m_logger->log(m_logPrefix + "no node to ask for the ip of " + message.nodeId().toString());
+    return;
+  }
+
+  auto nextHop = closestPrecedingFinger(message.nodeId());
+
+  if (nextHop == m_id) nextHop = m_successor;
+
+  m_logger->log(m_logPrefix + "routing find ip for " + message.nodeId().toString() + " to " + nextHop.toString());
+
+  m_connectionManager->send(nextHop, message);
+}
+
+void ChordNode::addressFound(const NodeId& nodeId)
+{
+  auto it = m_addressLookups.find(nodeId);
+
+  if (it == m_addressLookups.end()) return;
+
+  // Taken out of the map first, a send that fails again starts a new lookup
+  auto lookup = std::move(it->second);
+  m_addressLookups.erase(it);
+
+  m_timers.cancel(lookup.m_timeoutTimer);
+
+  for (auto& send : lookup.m_sends)
+  {
+    send();
+  }
+}
+
+uint32_t ChordNode::getNextAvailableRequestId()
+{
+  // Zero is a null value for requestId, so always skip it
+  if (m_requestIdCounter == 0) m_requestIdCounter++;
 
   auto it = m_pendingResponses.find(m_requestIdCounter);
 
@@ -701,6 +948,10 @@ uint32_t ChordNode::getNextAvailableRequestId()
 
   while (it != m_pendingResponses.end())
   {
+    m_requestIdCounter++;
+
+    if (m_requestIdCounter == 0) m_requestIdCounter++;
+
     it = m_pendingResponses.find(m_requestIdCounter);
     if (it == m_pendingResponses.end()) return m_requestIdCounter++;
   }
@@ -711,18 +962,37 @@ uint32_t ChordNode::getNextAvailableRequestId()
 
 void ChordNode::fixFingers()
 {
-  m_fingerTable.m_next++;
+  if (m_fingerLookupsOutstanding > 0) return;
+
+  m_logger->log(m_logPrefix + "Fixing fingers");
 
-  m_logger->log(m_logPrefix + "Fixing finger " + std::to_string(m_fingerTable.m_next));
+  m_fingerLookupsIssued.reset();
+  m_fingerRoundChanged = false;
 
-  if (m_fingerTable.m_next >= 160)
+  // One lookup for each run of fingers that currently point at the same node, the answers are
+  // usually the same runs so every finger is refreshed with a handful of lookups in parallel
+  auto& fingers = m_fingerTable.m_fingers;
+
+  for (std::size_t i = 0; i < fingers.size();)
   {
-    m_fingerTable.m_next = 0;
+    fixFingersFrom(i);
+
+    auto j = i + 1;
+
+    while (j < fingers.size() && fingers[j].m_nodeId == fingers[i].m_nodeId) j++;
+
+    i = j;
   }
+}
+
+void ChordNode::fixFingersFrom(std::size_t index)
+{
+  m_fingerLookupsIssued.set(index);
+  m_fingerLookupsOutstanding++;
 
-  auto requestId = findSuccessor(m_fingerTable.m_fingers[m_fingerTable.m_next].m_end);
+  auto requestId = findSuccessor(m_fingerTable.m_fingers[index].m_end);
 
-  std::function<bool()> checkFutureTask = [this, requestId, tableIndex = m_fingerTable.m_next] () -> bool
+  std::function<bool()> checkFutureTask = [this, requestId, index] () -> bool
   {
     auto it = m_findSuccessorFutures.find(requestId);
 
@@ -730,59 +1000,1045 @@ void ChordNode::fixFingers()
     if (it == m_findSuccessorFutures.end())
     {
       m_logger->log(m_logPrefix + "Fix fingers: could not find future for this request");
+      m_fingerRoundChanged = true;
+      fingerLookupFinished();
       return true;
     }
 
-    auto futureStatus = it->second.wait_for(std::chrono::milliseconds{20});
+    // Several of these tasks are queued at once, so do not block the work thread waiting for one
+    auto futureStatus = it->second.wait_for(std::chrono::milliseconds{0});
 
     if (futureStatus != std::future_status::ready)
     {
       return false;
     }
-    
-    m_fingerTable.m_fingers[tableIndex].m_nodeId = it->second.get();
-    m_logger->log(m_logPrefix + "got successor, finger " + std::to_string(tableIndex) + " nodeId set to " + m_fingerTable.m_fingers[tableIndex].m_nodeId.toString());
 
+    auto successor = it->second.get();
+    m_findSuccessorFutures.erase(it);
+
+    if (isPurged(successor))
+    {
+      m_fingerRoundChanged = true;
+      fingerLookupFinished();
+      return true;
+    }
+
+    // Every following finger whose end is between this node and the successor has the same successor
+    auto& fingers = m_fingerTable.m_fingers;
+    auto next = index;
+
+    do
+    {
+      if (fingers[next].m_nodeId != successor) m_fingerRoundChanged = true;
+
+      fingers[next].m_nodeId = successor;
+      next++;
+    }
+    while (next < fingers.size() && containedInLeftOpenInterval(m_id, successor, fingers[next].m_end));
+
+    pinRoutingConnections();
+    m_logger->log(m_logPrefix + "got successor, fingers " + std::to_string(index) + " to " + std::to_string(next - 1) + " set to " + successor.toString());
+
+    // The fingers up to the next run that has a lookup of its own still need one
+    if (next < fingers.size() && not m_fingerLookupsIssued.test(next))
+    {
+      fixFingersFrom(next);
+    }
+
+    fingerLookupFinished();
     return true;
   };
 
-  m_queue.putWork(checkFutureTask);
+  if (not m_queue.putWork(checkFutureTask))
+  {
+    m_logger->log(m_logPrefix + "Fix fingers: work queue full, dropping lookup for finger " + std::to_string(index));
+    m_fingerRoundChanged = true;
+    fingerLookupFinished();
+  }
 }
 
 void ChordNode::stabilise()
 {
   m_logger->log(m_logPrefix + "stabilise");
 
-  auto requestId = getNeighbours(m_successor);
+  // The first node of a ring learns its successor from the predecessor that notified it
+  if (m_successor == m_id)
+  {
+    if (m_hasPredecessor && not isPurged(m_predecessor))
+    {
+      m_successor = m_predecessor;
+      pinRoutingConnections();
+      m_stabiliseSchedule.recordChange();
+    }
+    else
+    {
+      m_stabiliseSchedule.recordUnchanged();
+    }
+
+    return;
+  }
+
+  auto requestId = getNextAvailableRequestId();
+
+  PendingMessageResponse pending;
+  pending.m_type = MessageType::CHORD_STABILISE_RESPONSE;
+  pending.m_nodeId = m_successor;
+  pending.m_hasChain = false;
+
+  m_pendingResponses.emplace(requestId, pending);
+
+  sendRequest(requestId, m_successor);
+}
+
+void ChordNode::handleStabilise(const StabiliseMessage& message)
+{
+  // The sender may be new to this node, its address is needed to answer it and to pass it on as
+  // the predecessor
+  if (message.sourceNodeIp() != 0) m_connectionManager->insert(message.sourceNodeId(), message.sourceNodeIp(), 0);
+
+  heardFrom(message.sourceNodeId());
+  considerPredecessor(message.sourceNodeId());
+
+  auto state = neighbourhoodState();
+
+  if (message.knownState() == state)
+  {
+    StabiliseResponseMessage response{ CommsVersion::V1, m_id, message.requestId(), state };
+
+    sendOrFindIp(message.sourceNodeId(), response);
+
+    return;
+  }
+
+  std::optional<NodeAddress> predecessor;
+
+  if (m_hasPredecessor) predecessor = addressOf(m_predecessor);
 
-  std::function<bool()> checkFutureTask = [this, requestId] ()
+  std::vector<NodeAddress> successors;
+
+  for (const auto& successor : successorList())
   {
-    auto it = m_getNeighboursFutures.find(requestId);
+    successors.push_back(addressOf(successor));
+  }
+
+  StabiliseResponseMessage response{ CommsVersion::V1, m_id, message.requestId(), state, predecessor, successors };
+
+  m_logger->log(m_logPrefix + "sending StabiliseResponse");
+
+  sendOrFindIp(message.sourceNodeId(), response);
+}
 
-    if (it == m_getNeighboursFutures.end()) return true;
+void ChordNode::handleStabiliseResponse(const StabiliseResponseMessage& message)
+{
+  auto it = m_pendingResponses.find(message.requestId());
 
-    auto result = it->second.wait_for(std::chrono::milliseconds{20});
+  if (it == m_pendingResponses.end()) return;
 
-    if (result != std::future_status::ready) return false;
+  completeRequest(message.requestId(), message.sourceNodeId());
+  m_pendingResponses.erase(it);
 
-    m_logger->log(m_logPrefix + "stabilise - got neighbours from successor");
-    Neighbours successorNeighbours = it->second.get();
+  // The successor changed while the request was out, the next round asks the new one
+  if (message.sourceNodeId() != m_successor) return;
 
+  if (message.unchanged() && m_successorStateSource == m_successor && message.state() == m_successorState)
+  {
+    m_logger->log(m_logPrefix + "stabilise - successor unchanged");
 
-    if (successorNeighbours.hasPredecessor &&
-        containedInOpenInterval(m_id, m_successor, successorNeighbours.predecessor))
+    if (m_successorsPredecessor == m_id)
+    {
+      m_stabiliseSchedule.recordUnchanged();
+    }
+    else
     {
-      m_successor = successorNeighbours.predecessor;
+      // This node came back to the successor after taking the node in between as its successor,
+      // the node in between has to be looked at again, which needs the response in full
+      if (m_successorsPredecessor && containedInOpenInterval(m_id, m_successor, *m_successorsPredecessor))
+      {
+        m_successorState = 0;
+      }
+
+      m_stabiliseSchedule.recordChange();
     }
 
-    m_logger->log(m_logPrefix + "stabilise - notifying successor " + m_successor.toString());
+    return;
+  }
+
+  // An unchanged response to a state this node no longer has, ask again in full next time
+  if (message.unchanged())
+  {
+    m_successorState = 0;
+    m_stabiliseSchedule.recordChange();
+    return;
+  }
+
+  m_logger->log(m_logPrefix + "stabilise - got neighbours from successor");
+
+  auto learn = [this] (const NodeAddress& address)
+  {
+    if (address.m_nodeId == m_id || address.m_ip == 0 || isPurged(address.m_nodeId)) return false;
 
-    notify(m_successor);
+    m_connectionManager->insert(address.m_nodeId, address.m_ip, 0);
     return true;
   };
 
-  m_queue.putWork(checkFutureTask);
+  m_successorStateSource = m_successor;
+  m_successorState = message.state();
+  m_successorsPredecessor.reset();
+
+  if (message.predecessor()) m_successorsPredecessor = message.predecessor()->m_nodeId;
+
+  // This node's successor list is its successor's, shifted along by one
+  m_successorList.clear();
+
+  for (const auto& successor : message.successors())
+  {
+    // The list has come all the way round a small ring
+    if (successor.m_nodeId == m_id || m_successorList.size() + 1 >= m_config.m_successorListLength) break;
+
+    if (learn(successor)) m_successorList.push_back(successor.m_nodeId);
+  }
+
+  // The ring is settled here when the successor already has this node as its predecessor, which it
+  // does from this round on unless another node is in between
+  if (m_successorsPredecessor == m_id)
+  {
+    m_stabiliseSchedule.recordUnchanged();
+    return;
+  }
+
+  m_stabiliseSchedule.recordChange();
+
+  if (not message.predecessor() || not containedInOpenInterval(m_id, m_successor, message.predecessor()->m_nodeId))
+  {
+    return;
+  }
+
+  const auto& predecessor = *message.predecessor();
+
+  if (learn(predecessor))
+  {
+    m_successorList.insert(m_successorList.begin(), m_successor);
+    m_successor = predecessor.m_nodeId;
+    pinRoutingConnections();
+
+    m_logger->log(m_logPrefix + "stabilise - successor set to " + m_successor.toString());
+  }
+  else if (predecessor.m_nodeId != m_id && predecessor.m_ip != 0 && isPurged(predecessor.m_nodeId))
+  {
+    // The successor has heard from a node this one purged, which is how a node that left or
+    // failed comes back. It is probed directly, an answer lifts the quarantine and the next
+    // round, which asks in full again, adopts it. A node that is still gone just stays purged
+    m_successorState = 0;
+    m_connectionManager->insert(predecessor.m_nodeId, predecessor.m_ip, 0);
+    m_lastHeard.emplace(predecessor.m_nodeId, m_clock->now());
+    probe(predecessor.m_nodeId);
+  }
+}
+
+uint64_t ChordNode::neighbourhoodState() const
+{
+  NodeIdHash hash;
+  uint64_t state = m_hasPredecessor ? hash(m_predecessor) : 0x9e3779b97f4a7c15;
+
+  for (const auto& successor : successorList())
+  {
+    state ^= hash(successor) + 0x9e3779b97f4a7c15 + (state << 6) + (state >> 2);
+  }
+
+  // Zero means no known state
+  return state == 0 ? 1 : state;
+}
+
+NodeAddress ChordNode::addressOf(const NodeId& nodeId) const
+{
+  return NodeAddress{ nodeId, nodeId == m_id ? m_connectionManager->ip() : m_connectionManager->ip(nodeId) };
+}
+
+void ChordNode::sendRequest(uint32_t requestId, const NodeId& destination)
+{
+  auto it = m_pendingResponses.find(requestId);
+
+  if (it == m_pendingResponses.end()) return;
+
+  auto& pending = it->second;
+  pending.m_nodeId = destination;
+  pending.m_triedNodes.push_back(destination);
+  pending.m_sentAt = m_clock->now();
+  pending.m_attempts++;
+
+  m_timers.cancel(pending.m_timeoutTimer);
+  pending.m_timeoutTimer = m_timers.schedule(pending.m_sentAt + m_peerLatency.timeout(destination),
+                                             [this, requestId] { handleRequestTimeout(requestId); });
+
+  if (m_config.m_hedgeRequests &&
+      pending.m_type == MessageType::CHORD_FIND_SUCCESSOR_RESPONSE &&
+      not pending.m_hedged)
+  {
+    m_timers.cancel(pending.m_hedgeTimer);
+    pending.m_hedgeTimer = m_timers.schedule(pending.m_sentAt + m_peerLatency.hedgeDelay(destination),
+                                             [this, requestId] { hedgeRequest(requestId); });
+  }
+
+  transmitRequest(requestId, destination);
+}
+
+void ChordNode::transmitRequest(uint32_t requestId, const NodeId& destination)
+{
+  const auto& pending = m_pendingResponses.at(requestId);
+  bool sent = false;
+
+  switch (pending.m_type)
+  {
+    case MessageType::CHORD_FIND_SUCCESSOR_RESPONSE:
+    {
+      FindSuccessorMessage message{ CommsVersion::V1, pending.m_query, m_id, requestId };
+      m_logger->log(m_logPrefix + "sending FindSuccessorMessage");
+      sent = m_connectionManager->send(destination, message);
+      break;
+    }
+    case MessageType::CHORD_STABILISE_RESPONSE:
+    {
+      auto knownState = destination == m_successorStateSource ? m_successorState : 0;
+      StabiliseMessage message{ CommsVersion::V1, m_id, m_connectionManager->ip(), requestId, knownState };
+      m_logger->log(m_logPrefix + "sending StabiliseMessage");
+      sent = m_connectionManager->send(destination, message);
+      break;
+    }
+    case MessageType::CHORD_CHECK_PREDECESSOR_RESPONSE:
+    {
+      CheckPredecessorMessage message{ CommsVersion::V1, m_id, m_connectionManager->ip(), requestId };
+      m_logger->log(m_logPrefix + "sending CheckPredecessorMessage");
+      sent = m_connectionManager->send(destination, message);
+      break;
+    }
+    case MessageType::CHORD_BOOTSTRAP_RESPONSE:
+    {
+      BootstrapMessage message{ CommsVersion::V1, m_id, requestId };
+      m_logger->log(m_logPrefix + "sending BootstrapMessage");
+      sent = m_connectionManager->send(destination, message);
+      break;
+    }
+    case MessageType::JOIN_RESPONSE:
+    {
+      JoinMessage message{ CommsVersion::V1, m_connectionManager->ip(), requestId };
+      m_connectionManager->send(destination, message);
+
+      // The joining node has no other way of finding the known node's address
+      sent = true;
+      break;
+    }
+    default:
+      sent = true;
+  }
+
+  // The request is sent again once the address is known, its timeout still runs meanwhile
+  if (not sent)
+  {
+    findIp(destination, [this, requestId, destination]
+    {
+      auto it = m_pendingResponses.find(requestId);
+
+      if (it != m_pendingResponses.end() && it->second.m_nodeId == destination)
+      {
+        transmitRequest(requestId, destination);
+      }
+    });
+  }
+}
+
+void ChordNode::handleRequestTimeout(uint32_t requestId)
+{
+  auto it = m_pendingResponses.find(requestId);
+
+  if (it == m_pendingResponses.end()) return;
+
+  auto& pending = it->second;
+  pending.m_timeoutTimer = NO_TIMER;
+
+  m_peerLatency.recordTimeout(pending.m_nodeId);
+
+  m_logger->log(m_logPrefix + "request " + std::to_string(requestId) + " to " + pending.m_nodeId.toString() + " timed out");
+
+  // Find out whether the node is dead rather than slow, while the request is sent elsewhere
+  if (pending.m_type != MessageType::CHORD_CHECK_PREDECESSOR_RESPONSE)
+  {
+    probe(pending.m_nodeId);
+  }
+
+  if (pending.m_attempts > m_config.m_maxRequestRetries)
+  {
+    failRequest(requestId);
+    return;
+  }
+
+  auto destination = pending.m_nodeId;
+
+  // Route around a finger that does not answer, any finger that precedes the ID makes progress
+  if (pending.m_type == MessageType::CHORD_FIND_SUCCESSOR_RESPONSE)
+  {
+    auto alternate = alternateFinger(pending.m_query, pending.m_triedNodes);
+
+    if (alternate != m_id) destination = alternate;
+  }
+
+  sendRequest(requestId, destination);
+}
+
+void ChordNode::hedgeRequest(uint32_t requestId)
+{
+  auto it = m_pendingResponses.find(requestId);
+
+  if (it == m_pendingResponses.end()) return;
+
+  auto& pending = it->second;
+  pending.m_hedgeTimer = NO_TIMER;
+
+  auto alternate = alternateFinger(pending.m_query, pending.m_triedNodes);
+
+  if (alternate == m_id) return;
+
+  m_logger->log(m_logPrefix + "hedging request " + std::to_string(requestId) + " to " + alternate.toString());
+
+  pending.m_hedged = true;
+  pending.m_triedNodes.push_back(alternate);
+  transmitRequest(requestId, alternate);
+}
+
+void ChordNode::completeRequest(uint32_t requestId, const NodeId& responder)
+{
+  auto& pending = m_pendingResponses.at(requestId);
+
+  m_timers.cancel(pending.m_timeoutTimer);
+  m_timers.cancel(pending.m_hedgeTimer);
+  pending.m_timeoutTimer = NO_TIMER;
+  pending.m_hedgeTimer = NO_TIMER;
+
+  heardFrom(responder);
+
+  // Only a response to a request that was sent once says anything about the round trip time
+  if (pending.m_attempts == 1 && responder == pending.m_nodeId)
+  {
+    auto roundTripTime = m_clock->now() - pending.m_sentAt;
+    m_peerLatency.recordSample(responder, std::chrono::duration_cast<PeerLatencyTracker::Duration>(roundTripTime));
+  }
+}
+
+void ChordNode::failRequest(uint32_t requestId)
+{
+  auto it = m_pendingResponses.find(requestId);
+
+  if (it == m_pendingResponses.end()) return;
+
+  m_logger->log(m_logPrefix + "abandoning request " + std::to_string(requestId));
+
+  m_timers.cancel(it->second.m_timeoutTimer);
+  m_timers.cancel(it->second.m_hedgeTimer);
+
+  if (it->second.m_type == MessageType::CHORD_CHECK_PREDECESSOR_RESPONSE)
+  {
+    auto deadNode = it->second.m_nodeId;
+    m_pendingResponses.erase(it);
+    purgeDeadNode(deadNode);
+    return;
+  }
+
+  // The tasks waiting on the futures stop when they cannot find them
+  if (not it->second.m_hasChain)
+  {
+    m_findSuccessorPromises.erase(requestId);
+    m_findSuccessorFutures.erase(requestId);
+
+    if (auto lookup = m_lookups.find(requestId); lookup != m_lookups.end())
+    {
+      auto callback = std::move(lookup->second);
+      m_lookups.erase(lookup);
+
+      callback(std::nullopt, 0);
+    }
+  }
+
+  if (it->second.m_type == MessageType::CHORD_STABILISE_RESPONSE)
+  {
+    m_stabiliseSchedule.recordChange();
+  }
+
+  m_pendingResponses.erase(it);
+}
+
+NodeId ChordNode::alternateFinger(const NodeId& id, const std::vector<NodeId>& triedNodes) const
+{
+  auto untried = [&triedNodes] (const NodeId& nodeId)
+  {
+    return std::find(triedNodes.begin(), triedNodes.end(), nodeId) == triedNodes.end();
+  };
+
+  for (int i = 159; i >= 0; i--)
+  {
+    const auto& finger = m_fingerTable.m_fingers[i].m_nodeId;
+
+    if (containedInOpenInterval(m_id, id, finger) && untried(finger)) return finger;
+  }
+
+  if (m_successor != m_id && untried(m_successor)) return m_successor;
+
+  return m_id;
+}
+
+void ChordNode::heardFrom(const NodeId& nodeId)
+{
+  if (nodeId == m_id) return;
+
+  // A node this one did not know about but should be routing through means the ring has changed
+  // somewhere nearby, so the backed off maintenance rounds are brought forward to find out
+  if (m_lastHeard.count(nodeId) == 0 && improvesRouting(nodeId))
+  {
+    ringChanged();
+  }
+
+  m_lastHeard[nodeId] = m_clock->now();
+  m_purgedNodes.erase(nodeId);
+}
+
+void ChordNode::checkLiveness()
+{
+  auto now = m_clock->now();
+
+  std::unordered_set<NodeId, NodeIdHash> routingPeers;
+  routingPeers.insert(m_successor);
+
+  if (m_hasPredecessor) routingPeers.insert(m_predecessor);
+
+  for (const auto& finger : m_fingerTable.m_fingers)
+  {
+    routingPeers.insert(finger.m_nodeId);
+  }
+
+  routingPeers.erase(m_id);
+
+  // Only the routing peers are tracked, anything else that has been heard from is forgotten
+  for (auto it = m_lastHeard.begin(); it != m_lastHeard.end();)
+  {
+    if (routingPeers.count(it->first) == 0)
+    {
+      it = m_lastHeard.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  for (const auto& peer : routingPeers)
+  {
+    // A new routing peer gets the full silence period before it is probed
+    auto [it, inserted] = m_lastHeard.emplace(peer, now);
+
+    if (not inserted && now - it->second > m_config.m_probeSilentPeersAfter)
+    {
+      probe(peer);
+    }
+  }
+}
+
+void ChordNode::probe(const NodeId& nodeId)
+{
+  // Only routing peers are probed, which also stops a purged node being probed again
+  if (m_lastHeard.count(nodeId) == 0 || not m_probesInFlight.insert(nodeId).second) return;
+
+  m_logger->log(m_logPrefix + "probing " + nodeId.toString());
+
+  auto requestId = getNextAvailableRequestId();
+
+  PendingMessageResponse pending;
+  pending.m_type = MessageType::CHORD_CHECK_PREDECESSOR_RESPONSE;
+  pending.m_nodeId = nodeId;
+  pending.m_hasChain = false;
+
+  m_pendingResponses.emplace(requestId, pending);
+
+  sendRequest(requestId, nodeId);
+}
+
+void ChordNode::handleCheckPredecessor(const CheckPredecessorMessage& message)
+{
+  // Otherwise a node that probes this one before this one has its address is not answered, and
+  // purges this node as dead
+  if (message.sourceNodeIp() != 0) m_connectionManager->insert(message.sourceNodeId(), message.sourceNodeIp(), 0);
+
+  heardFrom(message.sourceNodeId());
+
+  CheckPredecessorResponseMessage response{ CommsVersion::V1, m_id, message.requestId() };
+
+  m_logger->log(m_logPrefix + "sending CheckPredecessorResponse");
+
+  sendOrFindIp(message.sourceNodeId(), response);
+}
+
+void ChordNode::handleCheckPredecessorResponse(const CheckPredecessorResponseMessage& message)
+{
+  auto it = m_pendingResponses.find(message.requestId());
+
+  if (it == m_pendingResponses.end()) return;
+
+  completeRequest(message.requestId(), message.sourceNodeId());
+  m_probesInFlight.erase(it->second.m_nodeId);
+  m_pendingResponses.erase(it);
+}
+
+void ChordNode::purgeDeadNode(const NodeId& nodeId)
+{
+  m_logger->log(m_logPrefix + "purging dead node " + nodeId.toString());
+
+  m_probesInFlight.erase(nodeId);
+  m_lastHeard.erase(nodeId);
+  m_peerLatency.remove(nodeId);
+  m_purgedNodes[nodeId] = m_clock->now() + m_config.m_purgedNodeQuarantine;
+
+  if (m_hasPredecessor && m_predecessor == nodeId)
+  {
+    m_predecessor = NodeId{};
+    m_hasPredecessor = false;
+  }
+
+  // A dead finger is replaced by the next finger after it, which is further round the ring than
+  // the finger should be but is still a valid hop, until fixFingers gets to it
+  auto& fingers = m_fingerTable.m_fingers;
+  NodeId replacement = m_id;
+
+  for (int i = static_cast<int>(fingers.size()) - 1; i >= 0; i--)
+  {
+    if (fingers[i].m_nodeId == nodeId)
+    {
+      fingers[i].m_nodeId = replacement;
+    }
+    else
+    {
+      replacement = fingers[i].m_nodeId;
+    }
+  }
+
+  m_successorList.erase(std::remove(m_successorList.begin(), m_successorList.end(), nodeId), m_successorList.end());
+
+  if (m_successor == nodeId)
+  {
+    m_successor = fingers[0].m_nodeId;
+
+    for (const auto& successor : m_successorList)
+    {
+      if (successor != m_id && not isPurged(successor))
+      {
+        m_successor = successor;
+        break;
+      }
+    }
+
+    if (m_successor == m_id && m_hasPredecessor)
+    {
+      m_successor = m_predecessor;
+    }
+
+    m_logger->log(m_logPrefix + "successor replaced by " + m_successor.toString());
+  }
+
+  m_connectionManager->remove(nodeId);
+  pinRoutingConnections();
+  ringChanged();
+
+  // Find successor requests waiting on the dead node are sent to another finger now rather than when
+  // they time out, anything else is abandoned and will be sent again to the new routing state
+  std::vector<uint32_t> waiting;
+
+  for (const auto& [requestId, pending] : m_pendingResponses)
+  {
+    if (pending.m_nodeId == nodeId) waiting.push_back(requestId);
+  }
+
+  for (auto requestId : waiting)
+  {
+    auto it = m_pendingResponses.find(requestId);
+
+    if (it == m_pendingResponses.end()) continue;
+
+    if (it->second.m_type == MessageType::CHORD_FIND_SUCCESSOR_RESPONSE)
+    {
+      m_timers.cancel(it->second.m_timeoutTimer);
+      handleRequestTimeout(requestId);
+    }
+    else
+    {
+      failRequest(requestId);
+    }
+  }
+}
+
+void ChordNode::bootstrapFrom(const NodeId& successor)
+{
+  auto requestId = getNextAvailableRequestId();
+
+  PendingMessageResponse pending;
+  pending.m_type = MessageType::CHORD_BOOTSTRAP_RESPONSE;
+  pending.m_nodeId = successor;
+  pending.m_hasChain = false;
+
+  m_pendingResponses.emplace(requestId, pending);
+
+  sendRequest(requestId, successor);
+}
+
+void ChordNode::handleBootstrap(const BootstrapMessage& message)
+{
+  heardFrom(message.sourceNodeId());
+
+  std::optional<NodeAddress> predecessor;
+
+  if (m_hasPredecessor && addressOf(m_predecessor).m_ip != 0)
+  {
+    predecessor = addressOf(m_predecessor);
+  }
+
+  std::vector<NodeAddress> successors;
+
+  for (const auto& successor : successorList())
+  {
+    auto address = addressOf(successor);
+
+    if (address.m_ip != 0) successors.push_back(address);
+  }
+
+  std::vector<NodeAddress> fingers;
+  NodeId previous = m_id;
+
+  // Fingers come in runs of the same node, only send each node once
+  for (const auto& finger : m_fingerTable.m_fingers)
+  {
+    if (finger.m_nodeId == previous) continue;
+
+    previous = finger.m_nodeId;
+    auto address = addressOf(finger.m_nodeId);
+
+    if (finger.m_nodeId != m_id && address.m_ip != 0) fingers.push_back(address);
+  }
+
+  BootstrapResponseMessage response{ CommsVersion::V1, m_id, message.requestId(), predecessor, successors, fingers };
+
+  m_logger->log(m_logPrefix + "sending BootstrapResponse");
+
+  sendOrFindIp(message.sourceNodeId(), response);
+}
+
+void ChordNode::handleBootstrapResponse(const BootstrapResponseMessage& message)
+{
+  auto it = m_pendingResponses.find(message.requestId());
+
+  if (it == m_pendingResponses.end()) return;
+
+  completeRequest(message.requestId(), message.sourceNodeId());
+  m_pendingResponses.erase(it);
+
+  std::vector<NodeId> known{ m_id, message.sourceNodeId() };
+
+  auto learn = [this, &known] (const NodeAddress& address)
+  {
+    if (address.m_nodeId == m_id || address.m_ip == 0 || isPurged(address.m_nodeId)) return false;
+
+    m_connectionManager->insert(address.m_nodeId, address.m_ip, 0);
+    known.push_back(address.m_nodeId);
+    return true;
+  };
+
+  m_successorList.assign(1, message.sourceNodeId());
+
+  for (const auto& successor : message.successors())
+  {
+    if (learn(successor) && m_successorList.size() < m_config.m_successorListLength)
+    {
+      m_successorList.push_back(successor.m_nodeId);
+    }
+  }
+
+  for (const auto& finger : message.fingers())
+  {
+    learn(finger);
+  }
+
+  // The successor's predecessor is usually this node's predecessor, if it is wrong the real
+  // predecessor will notify this node soon
+  if (message.predecessor() && learn(*message.predecessor()) && not m_hasPredecessor)
+  {
+    m_predecessor = message.predecessor()->m_nodeId;
+    m_hasPredecessor = true;
+
+    // Check the predecessor is really there rather than waiting for it to go silent. Hearing from
+    // this node also lets a predecessor that has quarantined it, after it left, take it back
+    m_lastHeard.emplace(m_predecessor, m_clock->now());
+    probe(m_predecessor);
+  }
+
+  std::sort(known.begin(), known.end());
+  known.erase(std::unique(known.begin(), known.end()), known.end());
+
+  // Each finger is the first known node at or after its end, which is exact if the successor knows
+  // every node between them, and is corrected by the next finger round otherwise
+  for (auto& finger : m_fingerTable.m_fingers)
+  {
+    auto successor = std::lower_bound(known.begin(), known.end(), finger.m_end);
+
+    finger.m_nodeId = successor == known.end() ? known.front() : *successor;
+  }
+
+  pinRoutingConnections();
+  ringChanged();
+
+  m_logger->log(m_logPrefix + "bootstrapped from " + message.sourceNodeId().toString() + " with " + std::to_string(known.size() - 1) + " known nodes");
+}
+
+void ChordNode::leaveRing()
+{
+  m_logger->log(m_logPrefix + "leaving the ring");
+
+  std::optional<NodeAddress> predecessor;
+
+  if (m_hasPredecessor) predecessor = addressOf(m_predecessor);
+
+  std::vector<NodeAddress> successors;
+
+  for (const auto& successor : successorList())
+  {
+    successors.push_back(addressOf(successor));
+  }
+
+  // Everyone this node routes through or has heard from recently, which includes the nodes that
+  // route through it, as there is no way to know exactly which nodes have it as a finger
+  std::unordered_set<NodeId, NodeIdHash> peers;
+
+  if (m_hasPredecessor) peers.insert(m_predecessor);
+
+  for (const auto& successor : successorList())
+  {
+    peers.insert(successor);
+  }
+
+  for (const auto& finger : m_fingerTable.m_fingers)
+  {
+    peers.insert(finger.m_nodeId);
+  }
+
+  for (const auto& [nodeId, lastHeard] : m_lastHeard)
+  {
+    peers.insert(nodeId);
+  }
+
+  peers.erase(m_id);
+
+  LeaveMessage message{ CommsVersion::V1, m_id, predecessor, successors };
+
+  for (const auto& peer : peers)
+  {
+    m_connectionManager->send(peer, message);
+  }
+
+  // Nothing that is still outstanding is wanted any more, and retrying it would only tell the
+  // other nodes this one is still there
+  for (auto& [requestId, pending] : m_pendingResponses)
+  {
+    m_timers.cancel(pending.m_timeoutTimer);
+    m_timers.cancel(pending.m_hedgeTimer);
+  }
+
+  for (auto& [nodeId, lookup] : m_addressLookups)
+  {
+    m_timers.cancel(lookup.m_timeoutTimer);
+  }
+
+  m_pendingResponses.clear();
+  m_addressLookups.clear();
+  m_findSuccessorPromises.clear();
+  m_findSuccessorFutures.clear();
+  m_joinPromise = std::promise<NodeId>{};
+
+  // Lookups that were waiting are not answered now
+  auto lookups = std::move(m_lookups);
+  m_lookups.clear();
+
+  for (auto& [requestId, callback] : lookups)
+  {
+    callback(std::nullopt, 0);
+  }
+
+  m_lastHeard.clear();
+  m_probesInFlight.clear();
+  m_successorList.clear();
+  m_successorState = 0;
+  m_successorsPredecessor.reset();
+
+  m_predecessor = NodeId{};
+  m_hasPredecessor = false;
+  m_successor = m_id;
+  initialiseFingerTable(m_fingerTable, m_id);
+
+  pinRoutingConnections();
+}
+
+void ChordNode::handleLeave(const LeaveMessage& message)
+{
+  const auto& leaving = message.sourceNodeId();
+
+  if (leaving == m_id) return;
+
+  m_logger->log(m_logPrefix + leaving.toString() + " is leaving");
+
+  bool wasPredecessor = m_hasPredecessor && m_predecessor == leaving;
+  bool wasSuccessor = m_successor == leaving;
+
+  // The leaving node is dropped like a dead one, including the quarantine that stops other nodes'
+  // stale state bringing it back
+  purgeDeadNode(leaving);
+
+  auto learn = [this] (const NodeAddress& address)
+  {
+    if (address.m_nodeId == m_id || address.m_ip == 0 || isPurged(address.m_nodeId)) return false;
+
+    m_connectionManager->insert(address.m_nodeId, address.m_ip, 0);
+    return true;
+  };
+
+  if (wasPredecessor && message.predecessor() && learn(*message.predecessor()))
+  {
+    m_predecessor = message.predecessor()->m_nodeId;
+    m_hasPredecessor = true;
+  }
+
+  if (wasSuccessor)
+  {
+    std::vector<NodeId> successors;
+
+    for (const auto& successor : message.successors())
+    {
+      if (successor.m_nodeId == m_id) break;
+
+      if (learn(successor)) successors.push_back(successor.m_nodeId);
+    }
+
+    if (not successors.empty())
+    {
+      m_successor = successors.front();
+      m_successorList.assign(successors.begin() + 1, successors.end());
+    }
+
+    // The leaving node was the only other node
+    if (not message.successors().empty() && message.successors().front().m_nodeId == m_id)
+    {
+      m_successor = m_id;
+      m_successorList.clear();
+    }
+  }
+
+  // Fingers that pointed at the leaving node now point at the node after it, which is exactly
+  // right when that is the leaving node's successor
+  if (wasSuccessor)
+  {
+    for (auto& finger : m_fingerTable.m_fingers)
+    {
+      if (containedInLeftOpenInterval(m_id, m_successor, finger.m_end)) finger.m_nodeId = m_successor;
+    }
+  }
+
+  pinRoutingConnections();
+}
+
+std::vector<NodeId> ChordNode::successorList() const
+{
+  std::vector<NodeId> successors;
+
+  if (m_successor != m_id) successors.push_back(m_successor);
+
+  for (const auto& successor : m_successorList)
+  {
+    if (successors.size() >= m_config.m_successorListLength) break;
+
+    if (successor != m_id && std::find(successors.begin(), successors.end(), successor) == successors.end())
+    {
+      successors.push_back(successor);
+    }
+  }
+
+  return successors;
+}
+
+void ChordNode::ringChanged()
+{
+  m_stabiliseSchedule.recordChange();
+  m_fingerSchedule.recordChange();
+}
+
+bool ChordNode::improvesRouting(const NodeId& nodeId) const
+{
+  if (m_successor == m_id || containedInOpenInterval(m_id, m_successor, nodeId)) return true;
+
+  if (not m_hasPredecessor || containedInOpenInterval(m_predecessor, m_id, nodeId)) return true;
+
+  for (const auto& finger : m_fingerTable.m_fingers)
+  {
+    if (finger.m_nodeId != finger.m_end &&
+        finger.m_nodeId != nodeId &&
+        containedInRightOpenInterval(finger.m_end, finger.m_nodeId, nodeId))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ChordNode::fingerLookupFinished()
+{
+  m_fingerLookupsOutstanding--;
+
+  if (m_fingerLookupsOutstanding > 0) return;
+
+  if (m_fingerRoundChanged)
+  {
+    m_fingerSchedule.recordChange();
+  }
+  else
+  {
+    m_fingerSchedule.recordUnchanged();
+  }
+}
+
+bool ChordNode::isPurged(const NodeId& nodeId)
+{
+  auto it = m_purgedNodes.find(nodeId);
+
+  if (it == m_purgedNodes.end()) return false;
+
+  if (it->second < m_clock->now())
+  {
+    m_purgedNodes.erase(it);
+    return false;
+  }
+
+  return true;
+}
+
+void ChordNode::pinRoutingConnections()
+{
+  std::vector<NodeId> pinned;
+  pinned.reserve(m_fingerTable.m_fingers.size() + 2);
+
+  pinned.push_back(m_successor);
+
+  if (m_hasPredecessor) pinned.push_back(m_predecessor);
+
+  for (const auto& finger : m_fingerTable.m_fingers)
+  {
+    pinned.push_back(finger.m_nodeId);
+  }
+
+  std::sort(pinned.begin(), pinned.end());
+  pinned.erase(std::unique(pinned.begin(), pinned.end()), pinned.end());
 
+  m_connectionManager->setPinned(pinned);
 }
 
 void ChordNode::log(const std::string& message)
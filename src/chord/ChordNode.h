@@ -1,8 +1,14 @@
 #ifndef CHORD_NODE_H_
 #define CHORD_NODE_H_
 
+#include <atomic>
+#include <bitset>
+#include <chrono>
 #include <future>
+#include <mutex>
 #include <optional>
+#include <unordered_set>
+#include <vector>
 
 #include "../comms/Comms.h"
 #include "../logger/Logger.h"
@@ -11,6 +17,10 @@
 #include "NodeId.h"
 #include "FingerTable.h"
 #include "ConnectionManager.h"
+#include "Executor.h"
+#include "MaintenanceSchedule.h"
+#include "PeerLatency.h"
+#include "TimerQueue.h"
 
 namespace odd::chord {
 
@@ -19,13 +29,66 @@ static constexpr uint8_t NULL_NODE_ID[20] = { 0 };
 using IpAddress = std::string;
 using ConnectionManagerFactory = std::function<std::unique_ptr<ConnectionManager_I>(const NodeId&, uint32_t, uint16_t)>;
 
+struct ChordConfig
+{
+  // Limits of the per peer timeout, which adapts to the round trip times seen for each peer
+  std::chrono::milliseconds m_initialRequestTimeout{ 1000 };
+  std::chrono::milliseconds m_minRequestTimeout{ 50 };
+  std::chrono::milliseconds m_maxRequestTimeout{ 8000 };
+
+  // How many times a request is sent again before it is abandoned, find successor requests are
+  // sent to another finger if there is one
+  std::size_t m_maxRequestRetries = 2;
+
+  // Send a duplicate find successor request to another finger when the response takes longer than
+  // the 95th percentile of the round trip times seen for the peer
+  bool m_hedgeRequests = false;
+
+  // Routing peers (predecessor, successor and fingers) that have not been heard from for this long
+  // are probed with CHORD_CHECK_PREDECESSOR, and purged from the routing state if they do not answer
+  std::chrono::milliseconds m_probeSilentPeersAfter{ 3000 };
+
+  // A purged node is not taken back into the routing state from other nodes' (stale) state for
+  // this long, unless it is heard from directly
+  std::chrono::milliseconds m_purgedNodeQuarantine{ 30000 };
+
+  // The number of nodes following this one that are remembered, to replace a successor that fails
+  std::size_t m_successorListLength = 8;
+
+  // stabilise() and fixFingers() each run this often while the ring is changing. Every round that
+  // changes nothing multiplies the interval by the backoff factor, up to the maximum, and any change
+  // or failure drops it back to the minimum
+  std::chrono::milliseconds m_minMaintenanceInterval{ 1000 };
+  std::chrono::milliseconds m_maxMaintenanceInterval{ 16000 };
+  unsigned m_maintenanceBackoffFactor = 2;
+
+  // A node's address is looked up by routing a FIND_IP towards its ID for at most this many hops.
+  // Sends waiting for the address are dropped if it has not been found within the timeout
+  uint32_t m_addressLookupHopLimit = 32;
+  std::chrono::milliseconds m_addressLookupTimeout{ 2000 };
+};
+
+// The routing state of a node in a ring that has converged, see workload::buildRing
+struct RingState
+{
+  std::optional<NodeAddress> m_predecessor;
+
+  // The successor followed by the nodes after it
+  std::vector<NodeAddress> m_successors;
+
+  // The node each finger points at, in the order of the finger table
+  std::vector<NodeAddress> m_fingers;
+};
+
 class WorkThreadQueue
 {
   public:
     WorkThreadQueue() = default;
 
+    // Work is put from the receive threads as well as from the work thread itself
     bool putWork(std::function<bool()> workItem)
     {
+      std::lock_guard<std::mutex> lock(m_putMutex);
       size_t putIndex = m_tail.load();
       size_t nextIndex = (putIndex + 1) % 100;
 
@@ -39,22 +102,48 @@ class WorkThreadQueue
       return true;
     }
 
-    void doNextWork()
+    // Returns true if there was work and it finished
+    bool doNextWork()
     {
       size_t readIndex = m_head.load();
       size_t nextIndex = (readIndex + 1) % 100;
 
       while (readIndex == m_tail.load())
       {
-        return;
+        return false;
       }
 
-      if (not m_workItems[readIndex]())
+      bool finished = m_workItems[readIndex]();
+
+      // Unfinished work goes to the back of the queue, or is run again from the front if the queue is full
+      if (not finished && not putWork(m_workItems[readIndex]))
       {
-        putWork(std::move(m_workItems[readIndex]));
-        m_workItems[readIndex] = nullptr;
+        return false;
       }
+
+      m_workItems[readIndex] = nullptr;
       m_head.store(nextIndex);
+
+      return finished;
+    }
+
+    // Runs each item that was queued when it was called once, returns how many finished
+    std::size_t doQueuedWork()
+    {
+      std::size_t queued = size();
+      std::size_t finished = 0;
+
+      for (std::size_t i = 0; i < queued; i++)
+      {
+        if (doNextWork()) finished++;
+      }
+
+      return finished;
+    }
+
+    std::size_t size()
+    {
+      return (m_tail.load() + m_ringSize - m_head.load()) % m_ringSize;
     }
 
     bool hasWork()
@@ -67,6 +156,7 @@ class WorkThreadQueue
     size_t m_ringSize = 100;
     std::atomic<size_t> m_head{0};
     std::atomic<size_t> m_tail{0};
+    std::mutex m_putMutex;
 };
 
 class ChordNode
@@ -76,15 +166,40 @@ class ChordNode
               const std::string& ip,
               uint16_t port,
               const ConnectionManagerFactory& factory,
-              std::unique_ptr<logging::Logger> logger);
+              std::unique_ptr<logging::Logger> logger,
+              ChordConfig config = {},
+              std::unique_ptr<Executor_I> executor = nullptr,
+              std::shared_ptr<const Clock_I> clock = nullptr);
 
     ~ChordNode();
     void create();
     void join(const std::string &knownNodeIpAddress);
+
+    // Leaves the ring, telling the predecessor and successor to close the ring around this node and
+    // every other routing peer to forget it. Returns once the messages have been sent, after which
+    // this node is a ring of its own and can join again
+    void leave();
+
+    // Puts the node straight into a ring that has converged, with the routing state every node of
+    // the ring would have ended up with, instead of joining it. Returns once the state is taken
+    void adoptRingState(const RingState& state);
+
     const NodeId& getId() const;
+    uint32_t getIpAddress() const;
 
     const NodeId& getPredecessorId() const;
     const NodeId& getSuccessorId() const;
+    const FingerTable& getFingerTable() const;
+
+    // The successor followed by the nodes after it, at most m_successorListLength long
+    std::vector<NodeId> successorList() const;
+
+    // Called with the node the key belongs to and the number of nodes the lookup was forwarded
+    // through, or with nothing if the lookup failed
+    using LookupCallback = std::function<void(std::optional<NodeId>, uint32_t)>;
+
+    // Finds the node the key belongs to, the callback runs on the node's step
+    void lookup(const NodeId& key, LookupCallback callback);
 
     const NodeId& closestPrecedingFinger(const NodeId& id);
     void receive(uint8_t* message, std::size_t messageLength);
@@ -102,33 +217,99 @@ class ChordNode
 
     void handleNotify(const NotifyMessage& message);
     void handleGetNeighbours(const GetNeighboursMessage& message);
-    void handleGetNeighboursResponse(const GetNeighboursResponseMessage& message);
+
+    // A stabilise round is one StabiliseMessage to the successor, which also notifies it
+    void handleStabilise(const StabiliseMessage& message);
+    void handleStabiliseResponse(const StabiliseResponseMessage& message);
+
+    // Takes the node as predecessor if it is closer than the current one
+    void considerPredecessor(const NodeId& nodeId);
+
+    // Identifies the predecessor and successor list, so a node that already has them can be told
+    // they are unchanged instead of being sent them again
+    uint64_t neighbourhoodState() const;
+
+    NodeAddress addressOf(const NodeId& nodeId) const;
 
     void sendConnect(const NodeId& destination);
     void sendConnect(const NodeId& destination, const NodeId& nodeId, uint32_t ip);
     void handleConnectMessage(const ConnectMessage& message);
 
-    void findIp(const NodeId& nodeId);
+    // Liveness: any message from a node shows it is alive, silent routing peers are probed
+    void heardFrom(const NodeId& nodeId);
+    void checkLiveness();
+    void probe(const NodeId& nodeId);
+    void handleCheckPredecessor(const CheckPredecessorMessage& message);
+    void handleCheckPredecessorResponse(const CheckPredecessorResponseMessage& message);
+
+    // Removes a node that did not answer a probe from the fingers, successor, predecessor and
+    // connections, and re-routes the requests that were waiting for it
+    void purgeDeadNode(const NodeId& nodeId);
+    bool isPurged(const NodeId& nodeId);
+
+    // A newly joined node seeds its fingers, successor list and predecessor from its successor's
+    void bootstrapFrom(const NodeId& successor);
+    void handleBootstrap(const BootstrapMessage& message);
+    void handleBootstrapResponse(const BootstrapResponseMessage& message);
+
+    void leaveRing();
+    void handleLeave(const LeaveMessage& message);
+
+
+    // Churn seen outside the maintenance rounds, brings both of them back to their fastest rate
+    void ringChanged();
+    bool improvesRouting(const NodeId& nodeId) const;
+    void fingerLookupFinished();
+
+    // Sends the message, or holds it until the destination's address has been looked up
+    template <typename MessageT>
+    void sendOrFindIp(const NodeId& destination, const MessageT& message);
+
+    // Looks up the node's address, the send runs once it is known. Lookups for the same node share
+    // the one FIND_IP
+    void findIp(const NodeId& nodeId, std::function<void()> send);
     void handleFindIp(const FindIpMessage& message);
 
+    // Forwards the FIND_IP to the closest preceding finger of the ID it is looking for
+    void routeFindIp(const FindIpMessage& message);
+    void addressFound(const NodeId& nodeId);
+
+    // Starts a round of finger lookups if the previous round has finished
     void fixFingers();
 
+    // Looks up the finger at the index and fills every following finger with the same successor
+    void fixFingersFrom(std::size_t index);
+
     void stabilise();
 
-    void workThread();
+    // Tells the connection manager which connections the routing state depends on
+    void pinRoutingConnections();
+
+    // Does the queued work, runs the expired timers and the maintenance that is due, and returns
+    // when it next needs to run
+    Clock_I::Clock::time_point step();
+
+    // Work from outside the step (received messages, join), the executor is woken to run it
+    void queueWork(std::function<bool()> work);
 
     uint32_t findSuccessor(const NodeId& hash);
     uint32_t findSuccessor(const NodeId& nodeToQuery, const NodeId& hash);
 
-    struct Neighbours
-    {
-      NodeId successor;
-      NodeId predecessor;
-      bool hasPredecessor;
-    };
-    uint32_t getNeighbours(const NodeId& nodeToQuery);
+    // Sends the request described by the pending response with the ID and arms its timers
+    void sendRequest(uint32_t requestId, const NodeId& destination);
+    void transmitRequest(uint32_t requestId, const NodeId& destination);
+
+    void handleRequestTimeout(uint32_t requestId);
+    void hedgeRequest(uint32_t requestId);
 
-    void notify(const NodeId& nodeId);
+    // Cancels the timers of a request that has been answered and records the round trip time
+    void completeRequest(uint32_t requestId, const NodeId& responder);
+
+    // Abandons a request, removing its pending response, promise and future
+    void failRequest(uint32_t requestId);
+
+    // The finger closest to the ID that has not been tried yet, or this node's ID if there is none
+    NodeId alternateFinger(const NodeId& id, const std::vector<NodeId>& triedNodes) const;
 
     static uint32_t convertIpAddressToInteger(const std::string& ipAddress);
 
@@ -141,6 +322,12 @@ class ChordNode
     bool m_hasPredecessor = false;
     NodeId m_predecessor;
     NodeId m_successor;
+    std::vector<NodeId> m_successorList;
+
+    // What the successor last sent in full in a stabilise response
+    NodeId m_successorStateSource;
+    uint64_t m_successorState = 0;
+    std::optional<NodeId> m_successorsPredecessor;
     FingerTable m_fingerTable;
     const uint16_t m_port;
 
@@ -156,25 +343,65 @@ class ChordNode
       NodeId m_nodeId;
       bool m_hasChain;
       NodeId m_chainingDestination;
+
+      // The ID the chaining destination gave the request, which its response has to carry
+      uint32_t m_chainingRequestId = 0;
+
+      // The ID being looked up, for find successor requests
+      NodeId m_query;
+
+      std::vector<NodeId> m_triedNodes;
+      TimerQueue::Clock::time_point m_sentAt;
+      std::size_t m_attempts = 0;
+      bool m_hedged = false;
+      TimerId m_timeoutTimer = NO_TIMER;
+      TimerId m_hedgeTimer = NO_TIMER;
     };
 
     std::unique_ptr<logging::Logger> m_logger;
     const std::string m_logPrefix;
 
+    const ChordConfig m_config;
+    TimerQueue m_timers;
+    PeerLatencyTracker m_peerLatency;
+
+    std::size_t m_fingerLookupsOutstanding = 0;
+    std::bitset<160> m_fingerLookupsIssued;
+    bool m_fingerRoundChanged = false;
+
+    MaintenanceSchedule m_stabiliseSchedule;
+    MaintenanceSchedule m_fingerSchedule;
+
+    std::unordered_map<NodeId, TimerQueue::Clock::time_point, NodeIdHash> m_lastHeard;
+    std::unordered_set<NodeId, NodeIdHash> m_probesInFlight;
+    std::unordered_map<NodeId, TimerQueue::Clock::time_point, NodeIdHash> m_purgedNodes;
+
+    // Sends waiting for an address lookup, the addresses found are kept by the connection manager
+    struct AddressLookup
+    {
+      std::vector<std::function<void()>> m_sends;
+      TimerId m_timeoutTimer = NO_TIMER;
+    };
+
+    std::unordered_map<NodeId, AddressLookup, NodeIdHash> m_addressLookups;
+
     std::unordered_map<uint32_t, PendingMessageResponse> m_pendingResponses;
     std::unordered_map<uint32_t, std::promise<NodeId>> m_findSuccessorPromises;
     std::unordered_map<uint32_t, std::future<NodeId>> m_findSuccessorFutures;
-    std::unordered_map<uint32_t, std::promise<Neighbours>> m_getNeighboursPromises;
-    std::unordered_map<uint32_t, std::future<Neighbours>> m_getNeighboursFutures;
+    std::unordered_map<uint32_t, LookupCallback> m_lookups;
     std::promise<NodeId> m_joinPromise;
 
     WorkThreadQueue m_queue;
     std::future<NodeId> m_joinFuture;
 
-    std::chrono::time_point<std::chrono::high_resolution_clock> m_lastManageTime;
+    Clock_I::Clock::time_point m_lastManageTime;
+
+    std::shared_ptr<const Clock_I> m_clock;
+    std::unique_ptr<Executor_I> m_executor;
 
-    std::thread m_workThread;
-    bool m_running;
+    // Set from leave() until the next create() or join(), a node that has left answers nothing so
+    // that the other nodes do not take it back from answers to requests they sent before it left
+    std::atomic<bool> m_left{ false };
 
 };
 
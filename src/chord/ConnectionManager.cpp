@@ -1,9 +1,15 @@
+
 #include "ConnectionManager.h"
 
 namespace odd::chord {
 
-ConnectionManager::ConnectionManager(const NodeId& nodeId, uint32_t ip, uint16_t port)
+ConnectionManager::ConnectionManager(const NodeId& nodeId,
+                                     uint32_t ip,
+                                     uint16_t port,
+                                     ConnectionCacheConfig cacheConfig)
   : m_server{ip, port},
+    m_cacheConfig(cacheConfig),
+    m_openConnections(0),
     m_localNodeId(nodeId),
     m_localIpAddress(ip),
     m_localPort(port)
@@ -12,71 +18,177 @@ ConnectionManager::ConnectionManager(const NodeId& nodeId, uint32_t ip, uint16_t
 
 bool ConnectionManager::send(const NodeId& nodeId, const Message& message)
 {
-  auto nodeConnection = getNodeConnection(nodeId);
+  auto* peer = m_peers.find(nodeId);
+
+  if (peer == nullptr) return false;
 
-  if (nodeConnection == m_nodeConnections.end()) return false;
-  if (nodeConnection->m_id != nodeId) return false;
+  auto now = Clock::now();
+
+  if (not peer->m_connection)
+  {
+    openConnection(*peer, now);
+  }
+
+  peer->m_lastUsed = now;
 
   auto encoded = message.encode();
 
-  nodeConnection->m_tcpClient->send(encoded.m_message, encoded.m_length);
+  if (auto trace = m_trace.load())
+  {
+    trace->record(io::trace::Direction::SENT,
+                  trace->elapsed(),
+                  m_localIpAddress,
+                  peer->m_ipAddress,
+                  encoded.m_message,
+                  encoded.m_length);
+  }
+
+  peer->m_connection->send(encoded.m_message, encoded.m_length);
 
   return true;
 }
 
 void ConnectionManager::registerReceiveHandler(io::tcp::OnReceiveCallback callback)
 {
-  m_server.subscribeToAll(std::move(callback));
+  // Always wrapped, so that a trace set after the handler is registered still sees what is received
+  m_server.subscribeToAll([this, callback = std::move(callback)] (uint8_t* data, std::size_t length)
+  {
+    if (auto trace = m_trace.load())
+    {
+      trace->record(io::trace::Direction::RECEIVED, trace->elapsed(), 0, m_localIpAddress, data, length);
+    }
+
+    callback(data, length);
+  });
+
+  // The server takes its subscribers before it starts
+  m_server.start();
 }
 
 void ConnectionManager::insert(const NodeId& id, uint32_t ipAddress, uint16_t port)
 {
-  auto nodeConnection = getNodeConnection(id);
+  auto [peer, inserted] = m_peers.insert(id, ipAddress, port);
+
+  if (inserted) return;
 
-  if (nodeConnection == m_nodeConnections.end())
+  // Already known, if the address has changed the open client (if any) is for the old address
+  if (peer->m_ipAddress != ipAddress || (port != 0 && peer->m_port != port))
   {
-    m_nodeConnections.emplace_back(id, ipAddress, port);
-    return;
+    closeConnection(*peer);
+    peer->m_ipAddress = ipAddress;
+    if (port != 0) peer->m_port = port;
   }
-
-  m_nodeConnections.insert(nodeConnection, NodeConnection{id, ipAddress, port});
 }
 
 void ConnectionManager::remove(const NodeId& id)
 {
-  if (m_nodeConnections.empty()) return;
+  auto* peer = m_peers.find(id);
 
-  auto nodeConnection = getNodeConnection(id);
+  if (peer == nullptr) return;
 
-  if (nodeConnection == m_nodeConnections.end()) return;
-  if (nodeConnection->m_id != id) return;
+  closeConnection(*peer);
+  m_peers.remove(id);
+}
+
+void ConnectionManager::setPinned(const std::vector<NodeId>& nodeIds)
+{
+  for (auto& peer : m_peers)
+  {
+    peer.m_pinned = false;
+  }
+
+  for (const auto& nodeId : nodeIds)
+  {
+    auto* peer = m_peers.find(nodeId);
 
-  m_nodeConnections.erase(nodeConnection);
+    if (peer == nullptr) continue;
+
+    peer->m_pinned = true;
+  }
 }
 
-std::vector<ConnectionManager::NodeConnection>::iterator 
-ConnectionManager::getNodeConnection(const NodeId& nodeId)
+void ConnectionManager::stop()
 {
-  return std::lower_bound(m_nodeConnections.begin(),
-                          m_nodeConnections.end(),
-                          nodeId,
-                          [](const NodeConnection& lhs, const NodeId& rhs)
-                          {
-                            return lhs.m_id < rhs;
-                          });
+  m_server.stop();
 }
 
-std::vector<ConnectionManager::NodeConnection>::const_iterator
-ConnectionManager::getNodeConnection(const NodeId& nodeId) const
+void ConnectionManager::setTrace(std::shared_ptr<io::trace::TraceWriter> trace)
 {
-  return const_cast<ConnectionManager*>(this)->getNodeConnection(nodeId);
+  m_trace.store(std::move(trace));
 }
 
-std::size_t ConnectionManager::getClientIndex(const NodeId& nodeId)
+std::size_t ConnectionManager::openConnectionCount() const
 {
-  auto nodeConnection = getNodeConnection(nodeId);
+  return m_openConnections;
+}
+
+bool ConnectionManager::isConnected(const NodeId& nodeId) const
+{
+  const auto* peer = m_peers.find(nodeId);
+
+  return peer != nullptr && peer->m_connection != nullptr;
+}
 
-  return std::distance(m_nodeConnections.begin(), nodeConnection);
+const PeerDirectory& ConnectionManager::peers() const
+{
+  return m_peers;
+}
+
+void ConnectionManager::openConnection(PeerRecord& peer, Clock::time_point now)
+{
+  closeIdleConnections(now);
+
+  if (m_openConnections >= m_cacheConfig.m_maxOpenConnections)
+  {
+    // If every open connection is pinned then the cap is exceeded, the routing state needs them
+    evictLeastRecentlyUsed();
+  }
+
+  peer.m_connection = std::make_unique<io::tcp::Client>(peer.m_ipAddress, peer.m_port);
+  peer.m_connection->start();
+  m_openConnections++;
+}
+
+void ConnectionManager::closeConnection(PeerRecord& peer)
+{
+  if (not peer.m_connection) return;
+
+  peer.m_connection->stop();
+  peer.m_connection.reset();
+  m_openConnections--;
+}
+
+void ConnectionManager::closeIdleConnections(Clock::time_point now)
+{
+  for (auto& peer : m_peers)
+  {
+    if (peer.m_connection &&
+        not peer.m_pinned &&
+        now - peer.m_lastUsed > m_cacheConfig.m_idleTimeout)
+    {
+      closeConnection(peer);
+    }
+  }
+}
+
+bool ConnectionManager::evictLeastRecentlyUsed()
+{
+  PeerRecord* leastRecentlyUsed = nullptr;
+
+  for (auto& peer : m_peers)
+  {
+    if (not peer.m_connection || peer.m_pinned) continue;
+
+    if (leastRecentlyUsed == nullptr || peer.m_lastUsed < leastRecentlyUsed->m_lastUsed)
+    {
+      leastRecentlyUsed = &peer;
+    }
+  }
+
+  if (leastRecentlyUsed == nullptr) return false;
+
+  closeConnection(*leastRecentlyUsed);
+  return true;
 }
 
 [[nodiscard]] uint32_t ConnectionManager::ip() const
@@ -86,11 +198,11 @@ std::size_t ConnectionManager::getClientIndex(const NodeId& nodeId)
 
 [[nodiscard]] uint32_t ConnectionManager::ip(const NodeId& nodeId) const
 {
-  auto it = getNodeConnection(nodeId);
+  const auto* peer = m_peers.find(nodeId);
 
-  if (it == m_nodeConnections.end()) return 0;
+  if (peer == nullptr) return 0;
 
-  return 0;
+  return peer->m_ipAddress;
 }
 
 } // namespace odd::chord
@@ -3,12 +3,22 @@
 
 #include <tcp/Server.h>
 #include <tcp/Client.h>
+#include <trace/TraceWriter.h>
 #include "../comms/Comms.h"
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include "NodeId.h"
+#include "PeerDirectory.h"
 
 namespace odd::chord {
 
+using OnEncodedMessageCallback = std::function<void(EncodedMessage&&)>;
+
 class ConnectionManager_I
 {
   public:
@@ -21,16 +31,43 @@ class ConnectionManager_I
     virtual void stop() = 0;
     [[nodiscard]] virtual uint32_t ip() const = 0;
     [[nodiscard]] virtual uint32_t ip(const NodeId& nodeId) const = 0;
+
+    // The nodes that the routing state depends on (fingers, successor and predecessor), connections
+    // to these nodes should be kept open. Replaces any previously pinned set.
+    virtual void setPinned(const std::vector<NodeId>& /*nodeIds*/) {}
+
+    // Transports that hand over whole message buffers (e.g. between nodes in the same process)
+    // deliver them here rather than copying them through the receive handler.
+    virtual void registerEncodedMessageHandler(OnEncodedMessageCallback /*callback*/) {}
+};
+
+struct ConnectionCacheConfig
+{
+  std::size_t m_maxOpenConnections = 64;
+  std::chrono::milliseconds m_idleTimeout{ 30000 };
 };
 
 /*
  * The ConnectionManager is used for managing the external network connection that this not has to
  * other nodes. The concrete production version will contain a tcp server and multip tcp clients.
+ *
+ * The address of every inserted node is kept in a PeerDirectory, which also answers ip(id) for the
+ * routing layer, but the number of open tcp clients is capped. A client is opened when a message is
+ * first sent to a node, unpinned clients that have not been used for the idle timeout are closed,
+ * and if the cap is reached the least recently used unpinned client is closed to make room. A
+ * closed client is opened again the next time it is needed.
+ *
+ * A trace writer can be set at any time, and from then on records every frame sent and received.
+ * The tcp server starts when the receive handler is registered. It does not say who a frame came
+ * from, so received frames are recorded with a source address of zero.
  */
 class ConnectionManager : public ConnectionManager_I
 {
   public:
-    ConnectionManager(const NodeId& nodeId, uint32_t ip, uint16_t port);
+    ConnectionManager(const NodeId& nodeId,
+                      uint32_t ip,
+                      uint16_t port,
+                      ConnectionCacheConfig cacheConfig = {});
 
     bool send(const NodeId& nodeId, const Message& message) override;
 
@@ -42,32 +79,37 @@ class ConnectionManager : public ConnectionManager_I
 
     void remove(const NodeId& id) override;
 
-    void stop() override { };
+    void stop() override;
 
     [[nodiscard]] uint32_t ip() const override;
 
     [[nodiscard]] uint32_t ip(const NodeId& nodeId) const override;
 
-  private:
+    void setPinned(const std::vector<NodeId>& nodeIds) override;
+
+    void setTrace(std::shared_ptr<io::trace::TraceWriter> trace);
 
-    struct NodeConnection
-    {
-      NodeConnection(const NodeId& id, uint32_t ipAddress, uint16_t port)
-        : m_id(id),
-          m_tcpClient(std::make_unique<io::tcp::Client>(ipAddress, port))
-      {
-      }
-      NodeId m_id;
-      std::unique_ptr<io::tcp::Client_I> m_tcpClient;
-    };
+    [[nodiscard]] std::size_t openConnectionCount() const;
+    [[nodiscard]] bool isConnected(const NodeId& nodeId) const;
+
+    [[nodiscard]] const PeerDirectory& peers() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
 
-    std::vector<NodeConnection>::iterator getNodeConnection(const NodeId& nodeId);
-    std::vector<NodeConnection>::const_iterator getNodeConnection(const NodeId& nodeId) const;
+    void openConnection(PeerRecord& peer, Clock::time_point now);
+    void closeConnection(PeerRecord& peer);
+    void closeIdleConnections(Clock::time_point now);
+    bool evictLeastRecentlyUsed();
 
-    std::size_t getClientIndex(const NodeId& nodeId);
+    // Set and read from different threads, and declared ahead of the server so that it outlives the
+    // server's receive threads
+    std::atomic<std::shared_ptr<io::trace::TraceWriter>> m_trace;
 
     io::tcp::Server m_server;
-    std::vector<NodeConnection> m_nodeConnections;
+    PeerDirectory m_peers;
+    const ConnectionCacheConfig m_cacheConfig;
+    std::size_t m_openConnections;
 
     NodeId m_localNodeId;
     const uint32_t m_localIpAddress;
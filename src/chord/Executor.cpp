@@ -0,0 +1,99 @@
+#include "Executor.h"
+
+#include <future>
+
+namespace odd::chord {
+
+[[nodiscard]] Clock_I::Clock::time_point SteadyClock::now() const
+{
+  return Clock::now();
+}
+
+ThreadExecutor::~ThreadExecutor()
+{
+  stop();
+}
+
+void ThreadExecutor::start(Step step)
+{
+  m_running = true;
+
+  m_thread = std::thread{[this, step = std::move(step)]
+  {
+    while (m_running)
+    {
+      runFunctions();
+      auto next = step();
+
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wakeUp.wait_until(lock, next, [this] { return m_woken || not m_functions.empty() || not m_running; });
+      m_woken = false;
+    }
+  }};
+}
+
+void ThreadExecutor::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running = false;
+  }
+
+  m_wakeUp.notify_one();
+
+  if (m_thread.joinable()) m_thread.join();
+
+  // Anything that was waiting when the thread finished
+  runFunctions();
+}
+
+void ThreadExecutor::wake()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_woken = true;
+  }
+
+  m_wakeUp.notify_one();
+}
+
+void ThreadExecutor::runAndWait(std::function<void()> function)
+{
+  if (not m_running)
+  {
+    function();
+    return;
+  }
+
+  std::promise<void> done;
+  auto finished = done.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_functions.push_back([&function, &done]
+    {
+      function();
+      done.set_value();
+    });
+  }
+
+  m_wakeUp.notify_one();
+  finished.wait();
+}
+
+void ThreadExecutor::runFunctions()
+{
+  std::vector<std::function<void()>> functions;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    functions.swap(m_functions);
+  }
+
+  for (auto& function : functions)
+  {
+    function();
+  }
+}
+
+} // namespace odd::chord
@@ -0,0 +1,86 @@
+#ifndef EXECUTOR_H_
+#define EXECUTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace odd::chord {
+
+// Where a ChordNode's time comes from
+class Clock_I
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~Clock_I() {}
+
+    [[nodiscard]] virtual Clock::time_point now() const = 0;
+};
+
+class SteadyClock : public Clock_I
+{
+  public:
+    [[nodiscard]] Clock::time_point now() const override;
+};
+
+/*
+ * Runs a ChordNode's step: the node's queued work, expired timers and the maintenance that is due.
+ * The step returns when it next needs to run, an executor may run it more often than that but must
+ * run it again once new work is queued (wake) and once that time has passed.
+ */
+class Executor_I
+{
+  public:
+    using Step = std::function<Clock_I::Clock::time_point()>;
+
+    virtual ~Executor_I() {}
+
+    virtual void start(Step step) = 0;
+
+    // Once stop returns the step is not running and will not run again
+    virtual void stop() = 0;
+
+    // Work has been queued for the node
+    virtual void wake() = 0;
+
+    // Runs the function between two steps and returns once it has run
+    virtual void runAndWait(std::function<void()> function) = 0;
+};
+
+/*
+ * Runs the step on a thread of its own. Between steps the thread sleeps until the step's wake up
+ * time, or until work is queued from the receive threads (wake) or a function is given to runAndWait.
+ */
+class ThreadExecutor : public Executor_I
+{
+  public:
+    ThreadExecutor() = default;
+    ~ThreadExecutor() override;
+
+    void start(Step step) override;
+    void stop() override;
+    void wake() override;
+
+    // Must not be called from the step itself
+    void runAndWait(std::function<void()> function) override;
+
+  private:
+    void runFunctions();
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{ false };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    bool m_woken = false;
+    std::vector<std::function<void()>> m_functions;
+};
+
+} // namespace odd::chord
+
+#endif // EXECUTOR_H_
@@ -0,0 +1,273 @@
+#include "LoopbackConnectionManager.h"
+
+namespace odd::chord {
+
+LoopbackInbox::LoopbackInbox()
+  : m_head(new Entry{ EncodedMessage{ std::size_t{ 0 } } }),
+    m_tail(m_head.load()),
+    m_scheduled(false),
+    m_closed(false)
+{
+}
+
+LoopbackInbox::~LoopbackInbox()
+{
+  while (Entry* entry = pop())
+  {
+    (void) entry;
+  }
+
+  delete m_tail;
+}
+
+bool LoopbackInbox::push(EncodedMessage&& message)
+{
+  auto* entry = new Entry{ std::move(message) };
+
+  Entry* previous = m_head.exchange(entry, std::memory_order_acq_rel);
+  previous->m_next.store(entry, std::memory_order_release);
+
+  return not m_scheduled.exchange(true, std::memory_order_acq_rel);
+}
+
+LoopbackInbox::Entry* LoopbackInbox::pop()
+{
+  Entry* next = m_tail->m_next.load(std::memory_order_acquire);
+
+  if (next == nullptr) return nullptr;
+
+  // The popped entry becomes the new stub, its message is moved out by the caller
+  delete m_tail;
+  m_tail = next;
+
+  return next;
+}
+
+bool LoopbackInbox::deliver()
+{
+  std::lock_guard<std::mutex> lock(m_deliveryMutex);
+
+  while (Entry* entry = pop())
+  {
+    if (m_closed) continue;
+
+    if (m_onEncodedMessage)
+    {
+      m_onEncodedMessage(std::move(entry->m_message));
+    }
+    else if (m_onReceive)
+    {
+      m_onReceive(entry->m_message.m_message, entry->m_message.m_length);
+    }
+  }
+
+  m_scheduled.store(false, std::memory_order_seq_cst);
+
+  // A sender that pushed after the last pop but saw the flag still set has not scheduled the inbox
+  if (m_tail->m_next.load(std::memory_order_seq_cst) != nullptr)
+  {
+    return not m_scheduled.exchange(true, std::memory_order_acq_rel);
+  }
+
+  return false;
+}
+
+void LoopbackInbox::setHandlers(io::tcp::OnReceiveCallback onReceive, OnEncodedMessageCallback onEncodedMessage)
+{
+  std::lock_guard<std::mutex> lock(m_deliveryMutex);
+  m_onReceive = std::move(onReceive);
+  m_onEncodedMessage = std::move(onEncodedMessage);
+}
+
+void LoopbackInbox::close()
+{
+  std::lock_guard<std::mutex> lock(m_deliveryMutex);
+  m_closed = true;
+  m_onReceive = nullptr;
+  m_onEncodedMessage = nullptr;
+}
+
+LoopbackHub::LoopbackHub(std::size_t deliveryThreads)
+  : m_running(true)
+{
+  for (std::size_t i = 0; i < deliveryThreads; i++)
+  {
+    m_threads.emplace_back(&LoopbackHub::deliveryThread, this);
+  }
+}
+
+LoopbackHub::~LoopbackHub()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_readyMutex);
+    m_running = false;
+  }
+
+  m_readyCondition.notify_all();
+
+  for (auto& thread : m_threads)
+  {
+    thread.join();
+  }
+}
+
+uint64_t LoopbackHub::addressKey(uint32_t ipAddress, uint16_t port)
+{
+  return (static_cast<uint64_t>(ipAddress) << 16) | port;
+}
+
+void LoopbackHub::attach(uint32_t ipAddress, uint16_t port, std::shared_ptr<LoopbackInbox> inbox)
+{
+  std::unique_lock<std::shared_mutex> lock(m_inboxesMutex);
+  m_inboxes[addressKey(ipAddress, port)] = std::move(inbox);
+}
+
+void LoopbackHub::detach(uint32_t ipAddress, uint16_t port)
+{
+  std::unique_lock<std::shared_mutex> lock(m_inboxesMutex);
+  m_inboxes.erase(addressKey(ipAddress, port));
+}
+
+bool LoopbackHub::post(uint32_t ipAddress, uint16_t port, EncodedMessage&& message)
+{
+  std::shared_ptr<LoopbackInbox> inbox;
+
+  {
+    std::shared_lock<std::shared_mutex> lock(m_inboxesMutex);
+    auto it = m_inboxes.find(addressKey(ipAddress, port));
+
+    if (it == m_inboxes.end()) return false;
+
+    inbox = it->second;
+  }
+
+  if (inbox->push(std::move(message)))
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_readyMutex);
+      m_ready.push_back(std::move(inbox));
+    }
+
+    m_readyCondition.notify_one();
+  }
+
+  return true;
+}
+
+void LoopbackHub::deliveryThread()
+{
+  while (true)
+  {
+    std::shared_ptr<LoopbackInbox> inbox;
+
+    {
+      std::unique_lock<std::mutex> lock(m_readyMutex);
+      m_readyCondition.wait(lock, [this] { return not m_running || not m_ready.empty(); });
+
+      if (not m_running) return;
+
+      inbox = std::move(m_ready.front());
+      m_ready.pop_front();
+    }
+
+    if (inbox->deliver())
+    {
+      // Go to the back of the queue so that a busy node does not starve the others
+      std::lock_guard<std::mutex> lock(m_readyMutex);
+      m_ready.push_back(std::move(inbox));
+    }
+  }
+}
+
+LoopbackConnectionManager::LoopbackConnectionManager(const NodeId& nodeId, uint32_t ip, uint16_t port, LoopbackHub& hub)
+  : m_hub(hub),
+    m_inbox(std::make_shared<LoopbackInbox>()),
+    m_attached(true),
+    m_localNodeId(nodeId),
+    m_localIpAddress(ip),
+    m_localPort(port)
+{
+  m_hub.attach(ip, port, m_inbox);
+}
+
+LoopbackConnectionManager::~LoopbackConnectionManager()
+{
+  stop();
+}
+
+bool LoopbackConnectionManager::send(const NodeId& nodeId, const Message& message)
+{
+  const auto* peer = m_peers.find(nodeId);
+
+  if (peer == nullptr) return false;
+
+  return m_hub.post(peer->m_ipAddress, peer->m_port, message.encode());
+}
+
+bool LoopbackConnectionManager::broadcast(const Message& message)
+{
+  bool sent = false;
+
+  for (const auto& peer : m_peers)
+  {
+    sent = m_hub.post(peer.m_ipAddress, peer.m_port, message.encode()) || sent;
+  }
+
+  return sent;
+}
+
+void LoopbackConnectionManager::registerReceiveHandler(io::tcp::OnReceiveCallback callback)
+{
+  m_onReceive = std::move(callback);
+  m_inbox->setHandlers(m_onReceive, m_onEncodedMessage);
+}
+
+void LoopbackConnectionManager::registerEncodedMessageHandler(OnEncodedMessageCallback callback)
+{
+  m_onEncodedMessage = std::move(callback);
+  m_inbox->setHandlers(m_onReceive, m_onEncodedMessage);
+}
+
+void LoopbackConnectionManager::insert(const NodeId& id, uint32_t ipAddress, uint16_t port)
+{
+  if (port == 0) port = m_localPort;
+
+  auto [peer, inserted] = m_peers.insert(id, ipAddress, port);
+
+  if (not inserted)
+  {
+    peer->m_ipAddress = ipAddress;
+    peer->m_port = port;
+  }
+}
+
+void LoopbackConnectionManager::remove(const NodeId& id)
+{
+  m_peers.remove(id);
+}
+
+void LoopbackConnectionManager::stop()
+{
+  if (m_attached)
+  {
+    m_attached = false;
+    m_hub.detach(m_localIpAddress, m_localPort);
+    m_inbox->close();
+  }
+}
+
+[[nodiscard]] uint32_t LoopbackConnectionManager::ip() const
+{
+  return m_localIpAddress;
+}
+
+[[nodiscard]] uint32_t LoopbackConnectionManager::ip(const NodeId& nodeId) const
+{
+  const auto* peer = m_peers.find(nodeId);
+
+  if (peer == nullptr) return 0;
+
+  return peer->m_ipAddress;
+}
+
+} // namespace odd::chord
@@ -0,0 +1,147 @@
+#ifndef LOOPBACK_CONNECTION_MANAGER_H_
+#define LOOPBACK_CONNECTION_MANAGER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ConnectionManager.h"
+#include "PeerDirectory.h"
+
+namespace odd::chord {
+
+/*
+ * The messages waiting for one in-process node. Any number of senders push encoded messages onto
+ * an intrusive lock-free queue (Vyukov's MPSC queue), and a single delivery thread of the hub pops
+ * them and hands each buffer to the node's handler by moving it, so the bytes written by the
+ * sender's encode are the bytes the receiver decodes.
+ */
+class LoopbackInbox
+{
+  public:
+    LoopbackInbox();
+    ~LoopbackInbox();
+
+    LoopbackInbox(const LoopbackInbox&) = delete;
+    LoopbackInbox& operator=(const LoopbackInbox&) = delete;
+
+    // Returns true if the inbox needs to be scheduled for delivery
+    bool push(EncodedMessage&& message);
+
+    // Delivers every queued message, returns true if more arrived and the inbox is still scheduled
+    bool deliver();
+
+    void setHandlers(io::tcp::OnReceiveCallback onReceive, OnEncodedMessageCallback onEncodedMessage);
+
+    // No handler is called once close returns, messages that arrive later are dropped
+    void close();
+
+  private:
+    struct Entry
+    {
+      explicit Entry(EncodedMessage&& message) : m_message(std::move(message)) {}
+
+      std::atomic<Entry*> m_next{ nullptr };
+      EncodedMessage m_message;
+    };
+
+    Entry* pop();
+
+    alignas(64) std::atomic<Entry*> m_head;
+    alignas(64) Entry* m_tail;
+    std::atomic<bool> m_scheduled;
+
+    std::mutex m_deliveryMutex;
+    io::tcp::OnReceiveCallback m_onReceive;
+    OnEncodedMessageCallback m_onEncodedMessage;
+    bool m_closed;
+};
+
+/*
+ * Connects the LoopbackConnectionManagers of the nodes hosted in one process. Nodes are found by
+ * their address, and inboxes that have messages waiting are delivered by a small fixed set of
+ * threads, so the number of nodes is not limited by the number of threads.
+ */
+class LoopbackHub
+{
+  public:
+    explicit LoopbackHub(std::size_t deliveryThreads = 1);
+    ~LoopbackHub();
+
+    LoopbackHub(const LoopbackHub&) = delete;
+    LoopbackHub& operator=(const LoopbackHub&) = delete;
+
+    void attach(uint32_t ipAddress, uint16_t port, std::shared_ptr<LoopbackInbox> inbox);
+    void detach(uint32_t ipAddress, uint16_t port);
+
+    // Returns false if no node is attached at the address
+    bool post(uint32_t ipAddress, uint16_t port, EncodedMessage&& message);
+
+  private:
+    static uint64_t addressKey(uint32_t ipAddress, uint16_t port);
+
+    void deliveryThread();
+
+    std::shared_mutex m_inboxesMutex;
+    std::unordered_map<uint64_t, std::shared_ptr<LoopbackInbox>> m_inboxes;
+
+    std::mutex m_readyMutex;
+    std::condition_variable m_readyCondition;
+    std::deque<std::shared_ptr<LoopbackInbox>> m_ready;
+
+    std::vector<std::thread> m_threads;
+    bool m_running;
+};
+
+/*
+ * A ConnectionManager for ChordNodes that share a process, messages are encoded once and the buffer
+ * is passed to the receiving node without going through a socket. Peers inserted with a port of
+ * zero are assumed to use the same port as this node.
+ */
+class LoopbackConnectionManager : public ConnectionManager_I
+{
+  public:
+    LoopbackConnectionManager(const NodeId& nodeId, uint32_t ip, uint16_t port, LoopbackHub& hub);
+    ~LoopbackConnectionManager() override;
+
+    bool send(const NodeId& nodeId, const Message& message) override;
+
+    bool broadcast(const Message& message) override;
+
+    void registerReceiveHandler(io::tcp::OnReceiveCallback callback) override;
+
+    void registerEncodedMessageHandler(OnEncodedMessageCallback callback) override;
+
+    void insert(const NodeId& id, uint32_t ipAddress, uint16_t port) override;
+
+    void remove(const NodeId& id) override;
+
+    void stop() override;
+
+    [[nodiscard]] uint32_t ip() const override;
+
+    [[nodiscard]] uint32_t ip(const NodeId& nodeId) const override;
+
+  private:
+    LoopbackHub& m_hub;
+    std::shared_ptr<LoopbackInbox> m_inbox;
+    io::tcp::OnReceiveCallback m_onReceive;
+    OnEncodedMessageCallback m_onEncodedMessage;
+
+    PeerDirectory m_peers;
+    bool m_attached;
+
+    NodeId m_localNodeId;
+    const uint32_t m_localIpAddress;
+    const uint16_t m_localPort;
+};
+
+} // namespace odd::chord
+
+#endif // LOOPBACK_CONNECTION_MANAGER_H_
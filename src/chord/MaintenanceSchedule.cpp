@@ -0,0 +1,49 @@
+#include "MaintenanceSchedule.h"
+
+#include <algorithm>
+
+namespace odd::chord {
+
+MaintenanceSchedule::MaintenanceSchedule(Duration minInterval, Duration maxInterval, unsigned backoffFactor)
+  : m_minInterval(minInterval),
+    m_maxInterval(std::max(minInterval, maxInterval)),
+    m_backoffFactor(std::max(backoffFactor, 1u)),
+    m_interval(minInterval)
+{
+}
+
+bool MaintenanceSchedule::due(Clock::time_point now) const
+{
+  return now >= m_next;
+}
+
+void MaintenanceSchedule::started(Clock::time_point now)
+{
+  m_lastStarted = now;
+  m_next = now + m_interval;
+}
+
+void MaintenanceSchedule::recordUnchanged()
+{
+  // Compare before multiplying so a large maximum cannot overflow
+  m_interval = m_interval > m_maxInterval / m_backoffFactor ? m_maxInterval : m_interval * m_backoffFactor;
+  m_next = m_lastStarted + m_interval;
+}
+
+void MaintenanceSchedule::recordChange()
+{
+  m_interval = m_minInterval;
+  m_next = m_lastStarted + m_interval;
+}
+
+MaintenanceSchedule::Duration MaintenanceSchedule::interval() const
+{
+  return m_interval;
+}
+
+MaintenanceSchedule::Clock::time_point MaintenanceSchedule::next() const
+{
+  return m_next;
+}
+
+} // namespace odd::chord
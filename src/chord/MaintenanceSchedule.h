@@ -0,0 +1,49 @@
+#ifndef MAINTENANCE_SCHEDULE_H_
+#define MAINTENANCE_SCHEDULE_H_
+
+#include <chrono>
+
+namespace odd::chord {
+
+/*
+ * When a periodic maintenance round (stabilise, fix fingers) should next run.
+ *
+ * Each round that finds the routing state unchanged multiplies the interval by the backoff factor,
+ * up to the maximum, so a quiet ring is maintained less and less often. A round that finds a change,
+ * or any other sign of churn, drops the interval straight back to the minimum. The next round is
+ * always measured from when the last one started, so a change brings it forward.
+ */
+class MaintenanceSchedule
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Duration = std::chrono::milliseconds;
+
+    MaintenanceSchedule(Duration minInterval, Duration maxInterval, unsigned backoffFactor);
+
+    [[nodiscard]] bool due(Clock::time_point now) const;
+
+    void started(Clock::time_point now);
+
+    void recordUnchanged();
+
+    void recordChange();
+
+    [[nodiscard]] Duration interval() const;
+
+    // When the next round is due
+    [[nodiscard]] Clock::time_point next() const;
+
+  private:
+    const Duration m_minInterval;
+    const Duration m_maxInterval;
+    const unsigned m_backoffFactor;
+
+    Duration m_interval;
+    Clock::time_point m_lastStarted{};
+    Clock::time_point m_next{};
+};
+
+} // namespace odd::chord
+
+#endif // MAINTENANCE_SCHEDULE_H_
@@ -224,19 +224,15 @@ bool NodeId::operator!=(const NodeId& other) const
 
 bool NodeId::operator<(const NodeId& other) const
 {
-  auto* this_p = &m_id[19];
-  auto* other_p = &other.m_id[19];
-
-  int i{0};
-  while (i < 20)
+  // Compare from the most significant byte down
+  for (std::size_t i = 0; i < 20; i++)
   {
-    if (*this_p < *other_p) return true;
-    if (*this_p > *other_p) return false;
+    auto index = byteIndex(i);
+
+    if (m_id[index] < other.m_id[index]) return true;
+    if (m_id[index] > other.m_id[index]) return false;
 
     // if we get here then these bytes were equal, so we have to check the next bytes
-    this_p++;
-    other_p++;
-    i++;
   }
 
   // if we get here then all of the bytes were equal, return false
@@ -245,19 +241,15 @@ bool NodeId::operator<(const NodeId& other) const
 
 bool NodeId::operator>(const NodeId& other) const
 {
-  auto* this_p = &m_id[19];
-  auto* other_p = &other.m_id[19];
-
-  int i{0};
-  while (i < 20)
+  // Compare from the most significant byte down
+  for (std::size_t i = 0; i < 20; i++)
   {
-    if (*this_p < *other_p) return false;
-    if (*this_p > *other_p) return true;
+    auto index = byteIndex(i);
+
+    if (m_id[index] < other.m_id[index]) return false;
+    if (m_id[index] > other.m_id[index]) return true;
 
     // if we get here then these bytes were equal, so we have to check the next bytes
-    this_p++;
-    other_p++;
-    i++;
   }
 
   // if we get here then all of the bytes were equal, return false
@@ -266,19 +258,15 @@ bool NodeId::operator>(const NodeId& other) const
 
 bool NodeId::operator<=(const NodeId& other) const
 {
-  auto* this_p = &m_id[19];
-  auto* other_p = &other.m_id[19];
-
-  int i{0};
-  while (i < 20)
+  // Compare from the most significant byte down
+  for (std::size_t i = 0; i < 20; i++)
   {
-    if (*this_p < *other_p) return true;
-    if (*this_p > *other_p) return false;
+    auto index = byteIndex(i);
+
+    if (m_id[index] < other.m_id[index]) return true;
+    if (m_id[index] > other.m_id[index]) return false;
 
     // if we get here then these bytes were equal, so we have to check the next bytes
-    this_p++;
-    other_p++;
-    i++;
   }
 
   // if we get here then all of the bytes were equal, return true
@@ -287,19 +275,15 @@ bool NodeId::operator<=(const NodeId& other) const
 
 bool NodeId::operator>=(const NodeId& other) const
 {
-  auto* this_p = &m_id[19];
-  auto* other_p = &other.m_id[19];
-
-  int i{0};
-  while (i < 20)
+  // Compare from the most significant byte down
+  for (std::size_t i = 0; i < 20; i++)
   {
-    if (*this_p < *other_p) return false;
-    if (*this_p > *other_p) return true;
+    auto index = byteIndex(i);
+
+    if (m_id[index] < other.m_id[index]) return false;
+    if (m_id[index] > other.m_id[index]) return true;
 
     // if we get here then these bytes were equal, so we have to check the next bytes
-    this_p++;
-    other_p++;
-    i++;
   }
 
   // if we get here then all of the bytes were equal, return true
@@ -5,7 +5,9 @@
 #include <array>
 #include <cstdint>
 #include <cmath>
+#include <cstring>
 #include <bit>
+#include <string>
 
 namespace odd::chord {
 
@@ -176,6 +178,23 @@ struct NodeId
   hashing::SHA1Hash m_id;
 };
 
+// The first 8 bytes of a NodeId, the ids are SHA1 hashes so this is already well distributed and
+// can be used directly as a hash key.
+inline uint64_t hashKey(const NodeId& nodeId)
+{
+  uint64_t key;
+  std::memcpy(&key, nodeId.data(), sizeof(key));
+  return key;
+}
+
+struct NodeIdHash
+{
+  std::size_t operator()(const NodeId& nodeId) const
+  {
+    return static_cast<std::size_t>(hashKey(nodeId));
+  }
+};
+
 bool intervalWrapsZero(const NodeId& begin, const NodeId& end);
 
 bool containedInClosedInterval(const NodeId& begin, const NodeId& end, const NodeId& value);
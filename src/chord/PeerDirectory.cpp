@@ -0,0 +1,134 @@
+#include "PeerDirectory.h"
+
+namespace odd::chord {
+
+PeerDirectory::PeerDirectory()
+  : m_slots(16, Slot{ 0, EMPTY_SLOT }),
+    m_mask(15)
+{
+}
+
+std::size_t PeerDirectory::homeSlot(uint64_t key) const
+{
+  // Fibonacci hashing, the top bits of the product are the best mixed
+  return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & m_mask;
+}
+
+std::size_t PeerDirectory::findSlot(const NodeId& id, uint64_t key) const
+{
+  auto slot = homeSlot(key);
+
+  while (m_slots[slot].m_recordIndex != EMPTY_SLOT)
+  {
+    if (m_slots[slot].m_key == key && m_records[m_slots[slot].m_recordIndex].m_id == id)
+    {
+      return slot;
+    }
+
+    slot = (slot + 1) & m_mask;
+  }
+
+  return slot;
+}
+
+std::pair<PeerRecord*, bool> PeerDirectory::insert(const NodeId& id, uint32_t ipAddress, uint16_t port)
+{
+  auto key = hashKey(id);
+  auto slot = findSlot(id, key);
+
+  if (m_slots[slot].m_recordIndex != EMPTY_SLOT)
+  {
+    return { &m_records[m_slots[slot].m_recordIndex], false };
+  }
+
+  // Keep the load factor at or below one half
+  if ((m_records.size() + 1) * 2 > m_slots.size())
+  {
+    grow();
+    slot = findSlot(id, key);
+  }
+
+  m_slots[slot] = Slot{ key, static_cast<uint32_t>(m_records.size()) };
+  m_records.emplace_back(id, ipAddress, port);
+
+  return { &m_records.back(), true };
+}
+
+PeerRecord* PeerDirectory::find(const NodeId& id)
+{
+  auto slot = findSlot(id, hashKey(id));
+
+  if (m_slots[slot].m_recordIndex == EMPTY_SLOT) return nullptr;
+
+  return &m_records[m_slots[slot].m_recordIndex];
+}
+
+const PeerRecord* PeerDirectory::find(const NodeId& id) const
+{
+  return const_cast<PeerDirectory*>(this)->find(id);
+}
+
+bool PeerDirectory::remove(const NodeId& id)
+{
+  auto slot = findSlot(id, hashKey(id));
+
+  if (m_slots[slot].m_recordIndex == EMPTY_SLOT) return false;
+
+  auto recordIndex = m_slots[slot].m_recordIndex;
+  auto lastIndex = static_cast<uint32_t>(m_records.size() - 1);
+
+  // Move the last record into the gap so that the records stay dense, and repoint its slot
+  if (recordIndex != lastIndex)
+  {
+    auto lastSlot = findSlot(m_records[lastIndex].m_id, hashKey(m_records[lastIndex].m_id));
+    m_slots[lastSlot].m_recordIndex = recordIndex;
+    m_records[recordIndex] = std::move(m_records[lastIndex]);
+  }
+
+  m_records.pop_back();
+
+  // Backward shift deletion, move later entries of the probe sequence into the emptied slot unless
+  // that would move them before their home slot.
+  auto empty = slot;
+  auto next = (empty + 1) & m_mask;
+
+  while (m_slots[next].m_recordIndex != EMPTY_SLOT)
+  {
+    auto home = homeSlot(m_slots[next].m_key);
+
+    if (((next - home) & m_mask) >= ((next - empty) & m_mask))
+    {
+      m_slots[empty] = m_slots[next];
+      empty = next;
+    }
+
+    next = (next + 1) & m_mask;
+  }
+
+  m_slots[empty] = Slot{ 0, EMPTY_SLOT };
+
+  return true;
+}
+
+void PeerDirectory::grow()
+{
+  std::vector<Slot> oldSlots(m_slots.size() * 2, Slot{ 0, EMPTY_SLOT });
+  std::swap(oldSlots, m_slots);
+  m_mask = m_slots.size() - 1;
+
+  for (const auto& oldSlot : oldSlots)
+  {
+    if (oldSlot.m_recordIndex == EMPTY_SLOT) continue;
+
+    auto slot = homeSlot(oldSlot.m_key);
+
+    while (m_slots[slot].m_recordIndex != EMPTY_SLOT)
+    {
+      slot = (slot + 1) & m_mask;
+    }
+
+    m_slots[slot] = oldSlot;
+  }
+}
+
+} // namespace odd::chord
@@ -0,0 +1,82 @@
+#ifndef PEER_DIRECTORY_H_
+#define PEER_DIRECTORY_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <tcp/Client.h>
+
+#include "NodeId.h"
+
+namespace odd::chord {
+
+struct PeerRecord
+{
+  PeerRecord(const NodeId& id, uint32_t ipAddress, uint16_t port)
+    : m_id(id),
+      m_ipAddress(ipAddress),
+      m_port(port)
+  {
+  }
+
+  NodeId m_id;
+  uint32_t m_ipAddress;
+  uint16_t m_port;
+  bool m_pinned = false;
+  std::chrono::steady_clock::time_point m_lastUsed;
+  std::unique_ptr<io::tcp::Client_I> m_connection;
+};
+
+/*
+ * Maps a NodeId to the address of the node and the connection to it (if one is open).
+ *
+ * The records are stored densely so that they can be iterated quickly, and are indexed by an open
+ * addressing (linear probing) table keyed on the first 8 bytes of the NodeId. Insert, find and
+ * remove are all O(1). Removal uses backward shift deletion, so there are no tombstones and probe
+ * sequences stay short. Pointers to records are invalidated by insert and remove.
+ */
+class PeerDirectory
+{
+  public:
+    PeerDirectory();
+
+    // Returns the record for the id and true if it was inserted, or the existing record and false
+    std::pair<PeerRecord*, bool> insert(const NodeId& id, uint32_t ipAddress, uint16_t port);
+
+    PeerRecord* find(const NodeId& id);
+    [[nodiscard]] const PeerRecord* find(const NodeId& id) const;
+
+    bool remove(const NodeId& id);
+
+    [[nodiscard]] std::size_t size() const { return m_records.size(); }
+    [[nodiscard]] bool empty() const { return m_records.empty(); }
+
+    std::vector<PeerRecord>::iterator begin() { return m_records.begin(); }
+    std::vector<PeerRecord>::iterator end() { return m_records.end(); }
+    [[nodiscard]] std::vector<PeerRecord>::const_iterator begin() const { return m_records.begin(); }
+    [[nodiscard]] std::vector<PeerRecord>::const_iterator end() const { return m_records.end(); }
+
+  private:
+    static constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFF;
+
+    struct Slot
+    {
+      uint64_t m_key;
+      uint32_t m_recordIndex;
+    };
+
+    [[nodiscard]] std::size_t homeSlot(uint64_t key) const;
+    [[nodiscard]] std::size_t findSlot(const NodeId& id, uint64_t key) const;
+    void grow();
+
+    std::vector<Slot> m_slots;
+    std::vector<PeerRecord> m_records;
+    std::size_t m_mask;
+};
+
+} // namespace odd::chord
+
+#endif // PEER_DIRECTORY_H_
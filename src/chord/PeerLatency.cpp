@@ -0,0 +1,85 @@
+#include "PeerLatency.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace odd::chord {
+
+PeerLatencyTracker::PeerLatencyTracker(Duration initialTimeout, Duration minTimeout, Duration maxTimeout)
+  : m_initialTimeout(initialTimeout),
+    m_minTimeout(minTimeout),
+    m_maxTimeout(maxTimeout)
+{
+}
+
+void PeerLatencyTracker::recordSample(const NodeId& nodeId, Duration roundTripTime)
+{
+  auto& peer = m_peers[nodeId];
+
+  if (peer.m_sampleCount == 0)
+  {
+    peer.m_smoothedRoundTripTime = roundTripTime;
+    peer.m_roundTripTimeVariation = roundTripTime / 2;
+  }
+  else
+  {
+    auto deviation = peer.m_smoothedRoundTripTime > roundTripTime ? peer.m_smoothedRoundTripTime - roundTripTime
+                                                                  : roundTripTime - peer.m_smoothedRoundTripTime;
+    peer.m_roundTripTimeVariation = (3 * peer.m_roundTripTimeVariation + deviation) / 4;
+    peer.m_smoothedRoundTripTime = (7 * peer.m_smoothedRoundTripTime + roundTripTime) / 8;
+  }
+
+  peer.m_samples[peer.m_sampleCount % SAMPLE_COUNT] = roundTripTime;
+  peer.m_sampleCount++;
+  peer.m_backoff = 0;
+}
+
+void PeerLatencyTracker::recordTimeout(const NodeId& nodeId)
+{
+  auto& peer = m_peers[nodeId];
+
+  if (peer.m_backoff < 16) peer.m_backoff++;
+}
+
+void PeerLatencyTracker::remove(const NodeId& nodeId)
+{
+  m_peers.erase(nodeId);
+}
+
+PeerLatencyTracker::Duration PeerLatencyTracker::timeout(const NodeId& nodeId) const
+{
+  auto it = m_peers.find(nodeId);
+
+  if (it == m_peers.end()) return m_initialTimeout;
+
+  const auto& peer = it->second;
+  auto timeout = peer.m_sampleCount == 0 ? m_initialTimeout
+                                         : peer.m_smoothedRoundTripTime + 4 * peer.m_roundTripTimeVariation;
+
+  timeout = std::clamp(timeout, m_minTimeout, m_maxTimeout);
+
+  for (unsigned i = 0; i < peer.m_backoff && timeout < m_maxTimeout; i++)
+  {
+    timeout *= 2;
+  }
+
+  return std::min(timeout, m_maxTimeout);
+}
+
+PeerLatencyTracker::Duration PeerLatencyTracker::hedgeDelay(const NodeId& nodeId) const
+{
+  auto it = m_peers.find(nodeId);
+
+  if (it == m_peers.end() || it->second.m_sampleCount < MIN_HEDGE_SAMPLES) return timeout(nodeId) / 2;
+
+  const auto& peer = it->second;
+  std::vector<Duration> samples(peer.m_samples.begin(),
+                                peer.m_samples.begin() + std::min(peer.m_sampleCount, SAMPLE_COUNT));
+
+  auto percentile = samples.begin() + (samples.size() * 95) / 100;
+  std::nth_element(samples.begin(), percentile, samples.end());
+
+  return *percentile;
+}
+
+} // namespace odd::chord
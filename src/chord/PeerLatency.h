@@ -0,0 +1,64 @@
+#ifndef PEER_LATENCY_H_
+#define PEER_LATENCY_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <unordered_map>
+
+#include "NodeId.h"
+
+namespace odd::chord {
+
+/*
+ * Round trip times observed for each peer, used to decide how long to wait for a response.
+ *
+ * The timeout follows TCP's retransmission timer (RFC 6298): a smoothed round trip time plus four
+ * times its mean deviation, clamped to the configured limits, and doubled for each consecutive
+ * timeout until a response arrives. Peers that have not answered yet use the initial timeout.
+ *
+ * The hedge delay is the 95th percentile of the most recent samples, after which it is worth
+ * sending a duplicate request elsewhere rather than waiting for a slow peer.
+ */
+class PeerLatencyTracker
+{
+  public:
+    using Duration = std::chrono::microseconds;
+
+    PeerLatencyTracker(Duration initialTimeout, Duration minTimeout, Duration maxTimeout);
+
+    void recordSample(const NodeId& nodeId, Duration roundTripTime);
+
+    void recordTimeout(const NodeId& nodeId);
+
+    void remove(const NodeId& nodeId);
+
+    [[nodiscard]] Duration timeout(const NodeId& nodeId) const;
+
+    [[nodiscard]] Duration hedgeDelay(const NodeId& nodeId) const;
+
+  private:
+    static constexpr std::size_t SAMPLE_COUNT = 32;
+
+    // Fewer samples than this give a meaningless percentile
+    static constexpr std::size_t MIN_HEDGE_SAMPLES = 8;
+
+    struct PeerLatency
+    {
+      Duration m_smoothedRoundTripTime{ 0 };
+      Duration m_roundTripTimeVariation{ 0 };
+      unsigned m_backoff = 0;
+      std::array<Duration, SAMPLE_COUNT> m_samples{};
+      std::size_t m_sampleCount = 0;
+    };
+
+    const Duration m_initialTimeout;
+    const Duration m_minTimeout;
+    const Duration m_maxTimeout;
+
+    std::unordered_map<NodeId, PeerLatency, NodeIdHash> m_peers;
+};
+
+} // namespace odd::chord
+
+#endif // PEER_LATENCY_H_
@@ -0,0 +1,452 @@
+#include "ShmConnectionManager.h"
+
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace odd::chord {
+
+namespace {
+
+sockaddr_un abstractAddress(uint32_t ipAddress, uint16_t port, socklen_t& length)
+{
+  auto name = "odd-chord-shm-" + std::to_string(ipAddress) + "-" + std::to_string(port);
+
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  address.sun_path[0] = '\0';
+  std::memcpy(address.sun_path + 1, name.data(), name.size());
+  length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + name.size());
+
+  return address;
+}
+
+void setReceiveTimeout(int fd, std::chrono::milliseconds timeout)
+{
+  timeval value{};
+  value.tv_sec = timeout.count() / 1000;
+  value.tv_usec = (timeout.count() % 1000) * 1000;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value));
+}
+
+} // namespace
+
+ShmConnectionManager::ShmConnectionManager(const NodeId& nodeId,
+                                           uint32_t ip,
+                                           uint16_t port,
+                                           std::unique_ptr<ConnectionManager_I> streamTransport,
+                                           ShmTransportConfig config)
+  : m_streamTransport(std::move(streamTransport)),
+    m_config(config),
+    m_listenFd(socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)),
+    m_wakeupFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+    m_running(false),
+    m_localNodeId(nodeId),
+    m_localIpAddress(ip),
+    m_localPort(port)
+{
+  socklen_t length;
+  auto address = abstractAddress(ip, port, length);
+
+  if (bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), length) < 0 || listen(m_listenFd, 64) < 0)
+  {
+    std::cerr << "ShmConnectionManager could not listen: " << std::strerror(errno) << std::endl;
+    return;
+  }
+
+  m_running = true;
+  m_thread = std::thread{&ShmConnectionManager::threadFunction, this};
+}
+
+ShmConnectionManager::~ShmConnectionManager()
+{
+  stop();
+
+  close(m_listenFd);
+  close(m_wakeupFd);
+}
+
+bool ShmConnectionManager::send(const NodeId& nodeId, const Message& message)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto it = m_peers.find(nodeId);
+
+  if (it == m_peers.end()) return false;
+
+  if (it->second.m_sameHost && not it->second.m_channel && not it->second.m_connecting && Clock::now() >= it->second.m_nextAttempt)
+  {
+    auto ipAddress = it->second.m_ipAddress;
+    auto port = it->second.m_port;
+
+    it->second.m_connecting = true;
+    it->second.m_nextAttempt = Clock::now() + m_config.m_reconnectInterval;
+
+    lock.unlock();
+    auto connection = connectTo(ipAddress, port);
+    lock.lock();
+
+    // The peer may have been removed or moved to another address in the meantime
+    it = m_peers.find(nodeId);
+    bool current = it != m_peers.end() && it->second.m_connecting && it->second.m_ipAddress == ipAddress && it->second.m_port == port;
+
+    if (current)
+    {
+      it->second.m_connecting = false;
+    }
+
+    if (connection && current)
+    {
+      it->second.m_controlFd = connection->m_controlFd;
+      it->second.m_channel = std::move(connection->m_channel);
+    }
+    else if (connection)
+    {
+      close(connection->m_controlFd);
+    }
+  }
+
+  if (it != m_peers.end() && it->second.m_channel)
+  {
+    auto& peer = it->second;
+    auto encoded = message.encode();
+
+    if (peer.m_channel->send(encoded.m_message, encoded.m_length)) return true;
+
+    // A full ring may mean that the peer has gone, check before falling back to the stream
+    pollfd controlPoll{ peer.m_controlFd, POLLIN, 0 };
+
+    if (poll(&controlPoll, 1, 0) > 0)
+    {
+      disconnect(peer);
+    }
+  }
+
+  lock.unlock();
+
+  return m_streamTransport ? m_streamTransport->send(nodeId, message) : false;
+}
+
+bool ShmConnectionManager::broadcast(const Message& message)
+{
+  std::vector<NodeId> nodeIds;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    nodeIds.reserve(m_peers.size());
+
+    for (const auto& [id, peer] : m_peers)
+    {
+      nodeIds.push_back(id);
+    }
+  }
+
+  bool sent = false;
+
+  for (const auto& nodeId : nodeIds)
+  {
+    sent = send(nodeId, message) || sent;
+  }
+
+  return sent;
+}
+
+void ShmConnectionManager::registerReceiveHandler(io::tcp::OnReceiveCallback callback)
+{
+  if (m_streamTransport)
+  {
+    m_streamTransport->registerReceiveHandler(callback);
+  }
+
+  m_onReceive.store(std::make_shared<const io::tcp::OnReceiveCallback>(std::move(callback)));
+}
+
+void ShmConnectionManager::insert(const NodeId& id, uint32_t ipAddress, uint16_t port)
+{
+  if (m_streamTransport)
+  {
+    m_streamTransport->insert(id, ipAddress, port);
+  }
+
+  if (port == 0) port = m_localPort;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& peer = m_peers[id];
+
+  if (peer.m_channel && (peer.m_ipAddress != ipAddress || peer.m_port != port))
+  {
+    disconnect(peer);
+  }
+
+  peer.m_ipAddress = ipAddress;
+  peer.m_port = port;
+  peer.m_sameHost = isSameHost(ipAddress) && not (ipAddress == m_localIpAddress && port == m_localPort);
+}
+
+void ShmConnectionManager::remove(const NodeId& id)
+{
+  if (m_streamTransport)
+  {
+    m_streamTransport->remove(id);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_peers.find(id);
+
+  if (it == m_peers.end()) return;
+
+  disconnect(it->second);
+  m_peers.erase(it);
+}
+
+void ShmConnectionManager::stop()
+{
+  if (m_running)
+  {
+    m_running = false;
+
+    uint64_t one = 1;
+    auto result = write(m_wakeupFd, &one, sizeof(one));
+    (void) result;
+
+    m_thread.join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto& [id, peer] : m_peers)
+    {
+      disconnect(peer);
+    }
+
+    for (auto& inbound : m_inbound)
+    {
+      close(inbound.m_controlFd);
+    }
+
+    for (auto& accepting : m_accepting)
+    {
+      close(accepting.m_controlFd);
+    }
+
+    m_inbound.clear();
+    m_accepting.clear();
+  }
+
+  if (m_streamTransport)
+  {
+    m_streamTransport->stop();
+  }
+}
+
+[[nodiscard]] uint32_t ShmConnectionManager::ip() const
+{
+  return m_localIpAddress;
+}
+
+[[nodiscard]] uint32_t ShmConnectionManager::ip(const NodeId& nodeId) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_peers.find(nodeId);
+
+  if (it == m_peers.end()) return 0;
+
+  return it->second.m_ipAddress;
+}
+
+void ShmConnectionManager::setPinned(const std::vector<NodeId>& nodeIds)
+{
+  if (m_streamTransport)
+  {
+    m_streamTransport->setPinned(nodeIds);
+  }
+}
+
+bool ShmConnectionManager::isSharedMemoryPeer(const NodeId& nodeId)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_peers.find(nodeId);
+
+  return it != m_peers.end() && it->second.m_channel != nullptr;
+}
+
+bool ShmConnectionManager::isSameHost(uint32_t ipAddress) const
+{
+  return ipAddress == m_localIpAddress || (ntohl(ipAddress) >> 24) == 127;
+}
+
+std::optional<ShmConnectionManager::InboundPeer> ShmConnectionManager::connectTo(uint32_t ipAddress, uint16_t port) const
+{
+  int controlFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  socklen_t length;
+  auto address = abstractAddress(ipAddress, port, length);
+
+  if (connect(controlFd, reinterpret_cast<sockaddr*>(&address), length) < 0)
+  {
+    // Not a ChordNode with a shared memory transport on this host, use the stream transport
+    close(controlFd);
+    return std::nullopt;
+  }
+
+  setReceiveTimeout(controlFd, m_config.m_reconnectInterval);
+
+  auto channel = io::shm::Channel::create(m_config.m_ringCapacity);
+  int wakeupFd = -1;
+
+  if (channel && io::shm::sendFileDescriptor(controlFd, channel->memoryFd()))
+  {
+    wakeupFd = io::shm::receiveFileDescriptor(controlFd);
+  }
+
+  if (wakeupFd < 0)
+  {
+    close(controlFd);
+    return std::nullopt;
+  }
+
+  channel->setWakeupFd(wakeupFd);
+
+  return InboundPeer{ controlFd, std::move(channel) };
+}
+
+void ShmConnectionManager::disconnect(OutboundPeer& peer)
+{
+  if (peer.m_controlFd >= 0)
+  {
+    close(peer.m_controlFd);
+    peer.m_controlFd = -1;
+  }
+
+  peer.m_channel.reset();
+}
+
+void ShmConnectionManager::threadFunction()
+{
+  std::vector<pollfd> pollFds;
+
+  while (m_running)
+  {
+    auto onReceive = m_onReceive.load();
+
+    // Without a handler the frames are left in the rings until one is registered
+    if (onReceive)
+    {
+      drainInbound(*onReceive);
+    }
+
+    // Frames pushed after the drain but before the waiting flag was set are not followed by a
+    // wakeup, so poll without blocking if any ring has filled up again in the meantime.
+    bool canSleep = true;
+
+    for (auto& inbound : m_inbound)
+    {
+      canSleep = (not onReceive || inbound.m_channel->ring().prepareToWait()) && canSleep;
+    }
+
+    pollFds.clear();
+    pollFds.push_back(pollfd{ m_listenFd, POLLIN, 0 });
+    pollFds.push_back(pollfd{ m_wakeupFd, POLLIN, 0 });
+
+    for (const auto& inbound : m_inbound)
+    {
+      pollFds.push_back(pollfd{ inbound.m_controlFd, POLLIN, 0 });
+    }
+
+    for (const auto& accepting : m_accepting)
+    {
+      pollFds.push_back(pollfd{ accepting.m_controlFd, POLLIN, 0 });
+    }
+
+    poll(pollFds.data(), pollFds.size(), canSleep ? 100 : 0);
+
+    if (pollFds[1].revents & POLLIN)
+    {
+      uint64_t count;
+      auto result = read(m_wakeupFd, &count, sizeof(count));
+      (void) result;
+    }
+
+    const auto* acceptingPolls = pollFds.data() + 2 + m_inbound.size();
+
+    // Any activity on a control socket means that the producer has closed it
+    for (std::size_t i = m_inbound.size(); i > 0; i--)
+    {
+      if (pollFds[i + 1].revents == 0) continue;
+
+      auto& inbound = m_inbound[i - 1];
+
+      if (onReceive)
+      {
+        inbound.m_channel->ring().drain(*onReceive);
+      }
+
+      close(inbound.m_controlFd);
+      m_inbound.erase(m_inbound.begin() + static_cast<std::ptrdiff_t>(i - 1));
+    }
+
+    // The producer passes its memfd straight after connecting, give up on the ones that never do
+    auto now = Clock::now();
+
+    for (std::size_t i = m_accepting.size(); i > 0; i--)
+    {
+      auto revents = acceptingPolls[i - 1].revents;
+
+      if (revents == 0 && now < m_accepting[i - 1].m_deadline) continue;
+
+      auto controlFd = m_accepting[i - 1].m_controlFd;
+      m_accepting.erase(m_accepting.begin() + static_cast<std::ptrdiff_t>(i - 1));
+
+      if (revents & POLLIN)
+      {
+        completeAccept(controlFd);
+      }
+      else
+      {
+        close(controlFd);
+      }
+    }
+
+    if (pollFds[0].revents & POLLIN)
+    {
+      acceptPeer();
+    }
+  }
+}
+
+void ShmConnectionManager::acceptPeer()
+{
+  int controlFd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+
+  if (controlFd < 0) return;
+
+  // The io thread does not wait for the memfd here, the control socket is polled until it arrives
+  m_accepting.push_back(AcceptingPeer{ controlFd, Clock::now() + m_config.m_reconnectInterval });
+}
+
+void ShmConnectionManager::completeAccept(int controlFd)
+{
+  int memoryFd = io::shm::receiveFileDescriptor(controlFd);
+  auto channel = memoryFd >= 0 ? io::shm::Channel::attach(memoryFd) : nullptr;
+
+  if (not channel || not io::shm::sendFileDescriptor(controlFd, m_wakeupFd))
+  {
+    close(controlFd);
+    return;
+  }
+
+  m_inbound.push_back(InboundPeer{ controlFd, std::move(channel) });
+}
+
+void ShmConnectionManager::drainInbound(const io::tcp::OnReceiveCallback& onReceive)
+{
+  for (auto& inbound : m_inbound)
+  {
+    inbound.m_channel->ring().drain(onReceive);
+  }
+}
+
+} // namespace odd::chord
@@ -0,0 +1,136 @@
+#ifndef SHM_CONNECTION_MANAGER_H_
+#define SHM_CONNECTION_MANAGER_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <shm/Channel.h>
+
+#include "ConnectionManager.h"
+
+namespace odd::chord {
+
+struct ShmTransportConfig
+{
+  // The size of the ring used for each peer, frames larger than half of this use the stream transport
+  std::size_t m_ringCapacity = 1 << 20;
+  std::chrono::milliseconds m_reconnectInterval{ 1000 };
+};
+
+/*
+ * Exchanges messages with ChordNodes in other processes on the same host through shared memory.
+ * Each node listens on an abstract unix socket named after its address. To send to a same host
+ * peer a node creates a Ring in a memfd segment, connects to the peer's socket and passes the
+ * memfd, and the peer replies with the eventfd that wakes its io thread. After that every message
+ * is a copy into the ring, and a system call only when the peer's io thread is asleep.
+ *
+ * Peers on other hosts, peers whose rings are full and frames that are too large go to the stream
+ * transport (e.g. tcp). Peers inserted with a port of zero are assumed to use the same port as this
+ * node. Addresses are in network byte order, as ChordNode gives them.
+ *
+ * The handshake is run without holding the lock, two nodes that send to each other for the first
+ * time at the same moment each need the other's io thread to answer.
+ */
+class ShmConnectionManager : public ConnectionManager_I
+{
+  public:
+    ShmConnectionManager(const NodeId& nodeId,
+                         uint32_t ip,
+                         uint16_t port,
+                         std::unique_ptr<ConnectionManager_I> streamTransport,
+                         ShmTransportConfig config = {});
+    ~ShmConnectionManager() override;
+
+    bool send(const NodeId& nodeId, const Message& message) override;
+
+    bool broadcast(const Message& message) override;
+
+    void registerReceiveHandler(io::tcp::OnReceiveCallback callback) override;
+
+    void insert(const NodeId& id, uint32_t ipAddress, uint16_t port) override;
+
+    void remove(const NodeId& id) override;
+
+    void stop() override;
+
+    [[nodiscard]] uint32_t ip() const override;
+
+    [[nodiscard]] uint32_t ip(const NodeId& nodeId) const override;
+
+    void setPinned(const std::vector<NodeId>& nodeIds) override;
+
+    // True if messages to the node currently go through shared memory
+    [[nodiscard]] bool isSharedMemoryPeer(const NodeId& nodeId);
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct OutboundPeer
+    {
+      uint32_t m_ipAddress;
+      uint16_t m_port;
+      bool m_sameHost;
+      bool m_connecting = false;
+      int m_controlFd = -1;
+      std::unique_ptr<io::shm::Channel> m_channel;
+      Clock::time_point m_nextAttempt;
+    };
+
+    struct InboundPeer
+    {
+      int m_controlFd;
+      std::unique_ptr<io::shm::Channel> m_channel;
+    };
+
+    // An accepted control socket whose producer has not passed its memfd yet
+    struct AcceptingPeer
+    {
+      int m_controlFd;
+      Clock::time_point m_deadline;
+    };
+
+    [[nodiscard]] bool isSameHost(uint32_t ipAddress) const;
+
+    // Runs the handshake with the peer's io thread, must be called without holding the lock
+    [[nodiscard]] std::optional<InboundPeer> connectTo(uint32_t ipAddress, uint16_t port) const;
+    void disconnect(OutboundPeer& peer);
+
+    void threadFunction();
+    void acceptPeer();
+    void completeAccept(int controlFd);
+    void drainInbound(const io::tcp::OnReceiveCallback& onReceive);
+
+    std::unique_ptr<ConnectionManager_I> m_streamTransport;
+    const ShmTransportConfig m_config;
+
+    int m_listenFd;
+    int m_wakeupFd;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<NodeId, OutboundPeer, NodeIdHash> m_peers;
+
+    // Read by the io thread on every loop without taking the lock
+    std::atomic<std::shared_ptr<const io::tcp::OnReceiveCallback>> m_onReceive;
+
+    // Only used by the io thread
+    std::vector<InboundPeer> m_inbound;
+    std::vector<AcceptingPeer> m_accepting;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+
+    NodeId m_localNodeId;
+    const uint32_t m_localIpAddress;
+    const uint16_t m_localPort;
+};
+
+} // namespace odd::chord
+
+#endif // SHM_CONNECTION_MANAGER_H_
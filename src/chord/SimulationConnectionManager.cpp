@@ -0,0 +1,114 @@
+#include "SimulationConnectionManager.h"
+
+namespace odd::chord {
+
+void SimulationTraffic::record(MessageType type, std::size_t bytes)
+{
+  m_bytes[type] += bytes;
+  m_messages[type]++;
+}
+
+[[nodiscard]] uint64_t SimulationTraffic::bytes() const
+{
+  uint64_t total = 0;
+
+  for (const auto& [type, bytes] : m_bytes)
+  {
+    total += bytes;
+  }
+
+  return total;
+}
+
+[[nodiscard]] uint64_t SimulationTraffic::messages() const
+{
+  uint64_t total = 0;
+
+  for (const auto& [type, messages] : m_messages)
+  {
+    total += messages;
+  }
+
+  return total;
+}
+
+SimulationConnectionManager::SimulationConnectionManager(io::simulation::Node& node, SimulationTraffic* traffic)
+  : m_node(node),
+    m_traffic(traffic)
+{
+}
+
+SimulationConnectionManager::~SimulationConnectionManager()
+{
+  stop();
+}
+
+bool SimulationConnectionManager::send(const NodeId& nodeId, const Message& message)
+{
+  auto it = m_addresses.find(nodeId);
+
+  if (it == m_addresses.end()) return false;
+
+  sendTo(it->second, message);
+
+  return true;
+}
+
+bool SimulationConnectionManager::broadcast(const Message& message)
+{
+  for (const auto& [nodeId, ipAddress] : m_addresses)
+  {
+    sendTo(ipAddress, message);
+  }
+
+  return true;
+}
+
+void SimulationConnectionManager::registerReceiveHandler(io::tcp::OnReceiveCallback callback)
+{
+  m_onReceive = std::move(callback);
+
+  m_node.registerReceiveHandler([this] (uint32_t, uint8_t* message, std::size_t messageLength)
+  {
+    if (m_onReceive) m_onReceive(message, messageLength);
+  });
+}
+
+void SimulationConnectionManager::insert(const NodeId& id, uint32_t ipAddress, uint16_t)
+{
+  m_addresses.insert_or_assign(id, ipAddress);
+}
+
+void SimulationConnectionManager::remove(const NodeId& id)
+{
+  m_addresses.erase(id);
+}
+
+void SimulationConnectionManager::stop()
+{
+  m_node.cancelReceiveHandler();
+  m_onReceive = nullptr;
+}
+
+[[nodiscard]] uint32_t SimulationConnectionManager::ip() const
+{
+  return m_node.ip();
+}
+
+[[nodiscard]] uint32_t SimulationConnectionManager::ip(const NodeId& nodeId) const
+{
+  auto it = m_addresses.find(nodeId);
+
+  return it == m_addresses.end() ? 0 : it->second;
+}
+
+void SimulationConnectionManager::sendTo(uint32_t ipAddress, const Message& message)
+{
+  auto encoded = message.encode();
+
+  if (m_traffic != nullptr) m_traffic->record(message.type(), encoded.m_length);
+
+  m_node.sendMessage(ipAddress, encoded.m_message, encoded.m_length);
+}
+
+} // namespace odd::chord
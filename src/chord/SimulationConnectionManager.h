@@ -0,0 +1,62 @@
+#ifndef SIMULATION_CONNECTION_MANAGER_H_
+#define SIMULATION_CONNECTION_MANAGER_H_
+
+#include <simulation/Node.h>
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+
+#include "ConnectionManager.h"
+
+namespace odd::chord {
+
+// What the nodes of a simulation have sent, by message type
+struct SimulationTraffic
+{
+  std::map<MessageType, uint64_t> m_bytes;
+  std::map<MessageType, uint64_t> m_messages;
+
+  void record(MessageType type, std::size_t bytes);
+
+  [[nodiscard]] uint64_t bytes() const;
+  [[nodiscard]] uint64_t messages() const;
+};
+
+/*
+ * Sends a ChordNode's messages through a node of a simulated network. The addresses it has been
+ * told are kept in a map, there are no connections to open or close. Not thread safe, the node and
+ * the network run on the simulation's thread.
+ */
+class SimulationConnectionManager : public ConnectionManager_I
+{
+  public:
+    // The traffic, if given, is counted for every message sent
+    SimulationConnectionManager(io::simulation::Node& node, SimulationTraffic* traffic = nullptr);
+    ~SimulationConnectionManager() override;
+
+    bool send(const NodeId& nodeId, const Message& message) override;
+    bool broadcast(const Message& message) override;
+    void registerReceiveHandler(io::tcp::OnReceiveCallback callback) override;
+    void insert(const NodeId& id, uint32_t ipAddress, uint16_t port) override;
+    void remove(const NodeId& id) override;
+
+    // Messages that arrive after this are dropped, as they are for a node that has failed
+    void stop() override;
+
+    [[nodiscard]] uint32_t ip() const override;
+    [[nodiscard]] uint32_t ip(const NodeId& nodeId) const override;
+
+  private:
+    void sendTo(uint32_t ipAddress, const Message& message);
+
+    io::simulation::Node& m_node;
+    SimulationTraffic* m_traffic;
+
+    std::unordered_map<NodeId, uint32_t, NodeIdHash> m_addresses;
+    io::tcp::OnReceiveCallback m_onReceive;
+};
+
+} // namespace odd::chord
+
+#endif // SIMULATION_CONNECTION_MANAGER_H_
@@ -0,0 +1,82 @@
+#include "SimulationExecutor.h"
+
+namespace odd::chord {
+
+SimulationClock::SimulationClock(const io::simulation::Scheduler& scheduler)
+  : m_scheduler(scheduler)
+{
+}
+
+[[nodiscard]] Clock_I::Clock::time_point SimulationClock::now() const
+{
+  return toTimePoint(m_scheduler.now());
+}
+
+[[nodiscard]] Clock_I::Clock::time_point SimulationClock::toTimePoint(io::simulation::SimTime time)
+{
+  return Clock::time_point{} + std::chrono::duration_cast<Clock::duration>(time);
+}
+
+[[nodiscard]] io::simulation::SimTime SimulationClock::toSimTime(Clock::time_point timePoint)
+{
+  return std::chrono::duration_cast<io::simulation::SimTime>(timePoint.time_since_epoch());
+}
+
+SimulationExecutor::SimulationExecutor(io::simulation::Scheduler& scheduler)
+  : m_scheduler(scheduler)
+{
+}
+
+SimulationExecutor::~SimulationExecutor()
+{
+  stop();
+}
+
+void SimulationExecutor::start(Step step)
+{
+  m_step = std::move(step);
+  m_running = true;
+
+  wake();
+}
+
+void SimulationExecutor::stop()
+{
+  m_running = false;
+
+  m_scheduler.cancel(m_stepEvent);
+  m_stepEvent = io::simulation::NO_EVENT;
+}
+
+void SimulationExecutor::wake()
+{
+  runAt(m_scheduler.now());
+}
+
+void SimulationExecutor::runAndWait(std::function<void()> function)
+{
+  function();
+  wake();
+}
+
+void SimulationExecutor::runAt(io::simulation::SimTime time)
+{
+  if (not m_running) return;
+
+  // The step that is already scheduled runs soon enough
+  if (m_stepEvent != io::simulation::NO_EVENT && m_stepTime <= time) return;
+
+  m_scheduler.cancel(m_stepEvent);
+
+  m_stepTime = time;
+  m_stepEvent = m_scheduler.schedule(time, [this]
+  {
+    m_stepEvent = io::simulation::NO_EVENT;
+
+    auto next = m_step();
+
+    runAt(std::max(SimulationClock::toSimTime(next), m_scheduler.now()));
+  });
+}
+
+} // namespace odd::chord
@@ -0,0 +1,57 @@
+#ifndef SIMULATION_EXECUTOR_H_
+#define SIMULATION_EXECUTOR_H_
+
+#include <simulation/Scheduler.h>
+
+#include "Executor.h"
+
+namespace odd::chord {
+
+// The virtual time of a simulation, as the time points the ChordNode uses
+class SimulationClock : public Clock_I
+{
+  public:
+    explicit SimulationClock(const io::simulation::Scheduler& scheduler);
+
+    [[nodiscard]] Clock::time_point now() const override;
+
+    [[nodiscard]] static Clock::time_point toTimePoint(io::simulation::SimTime time);
+    [[nodiscard]] static io::simulation::SimTime toSimTime(Clock::time_point timePoint);
+
+  private:
+    const io::simulation::Scheduler& m_scheduler;
+};
+
+/*
+ * Runs a node's step as events of a simulation's scheduler, on the thread that runs the
+ * simulation. There is at most one step event per node: it is scheduled for when the step asked to
+ * run again, and brought forward to the current time when work is queued. Every node of a
+ * simulation shares the one thread and virtual clock, so a run is deterministic.
+ */
+class SimulationExecutor : public Executor_I
+{
+  public:
+    explicit SimulationExecutor(io::simulation::Scheduler& scheduler);
+    ~SimulationExecutor() override;
+
+    void start(Step step) override;
+    void stop() override;
+    void wake() override;
+
+    // Runs the function straight away, the caller is the simulation's thread
+    void runAndWait(std::function<void()> function) override;
+
+  private:
+    void runAt(io::simulation::SimTime time);
+
+    io::simulation::Scheduler& m_scheduler;
+    Step m_step;
+    bool m_running = false;
+
+    io::simulation::EventId m_stepEvent = io::simulation::NO_EVENT;
+    io::simulation::SimTime m_stepTime{ 0 };
+};
+
+} // namespace odd::chord
+
+#endif // SIMULATION_EXECUTOR_H_
@@ -0,0 +1,56 @@
+#include "TimerQueue.h"
+
+namespace odd::chord {
+
+TimerId TimerQueue::schedule(Clock::time_point deadline, std::function<void()> callback)
+{
+  auto id = m_nextId++;
+
+  m_heap.push(Timer{ deadline, id });
+  m_callbacks.emplace(id, std::move(callback));
+
+  return id;
+}
+
+void TimerQueue::cancel(TimerId id)
+{
+  m_callbacks.erase(id);
+}
+
+std::size_t TimerQueue::runExpired(Clock::time_point now)
+{
+  std::size_t run = 0;
+
+  while (not m_heap.empty() && m_heap.top().m_deadline <= now)
+  {
+    auto id = m_heap.top().m_id;
+    m_heap.pop();
+
+    auto it = m_callbacks.find(id);
+
+    if (it == m_callbacks.end()) continue;
+
+    // The callback may schedule or cancel timers, so take it out of the map before running it
+    auto callback = std::move(it->second);
+    m_callbacks.erase(it);
+
+    callback();
+    run++;
+  }
+
+  return run;
+}
+
+std::size_t TimerQueue::size() const
+{
+  return m_callbacks.size();
+}
+
+std::optional<TimerQueue::Clock::time_point> TimerQueue::nextDeadline() const
+{
+  if (m_heap.empty()) return std::nullopt;
+
+  return m_heap.top().m_deadline;
+}
+
+} // namespace odd::chord
@@ -0,0 +1,60 @@
+#ifndef TIMER_QUEUE_H_
+#define TIMER_QUEUE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace odd::chord {
+
+using TimerId = uint64_t;
+
+// Zero is never returned by schedule, so it can be used for "no timer"
+static constexpr TimerId NO_TIMER = 0;
+
+/*
+ * Callbacks that run once their deadline has passed. The queue is not thread safe, it is owned by
+ * the thread that calls runExpired (the ChordNode work thread). Cancelled timers are removed from
+ * the heap lazily when they reach the top.
+ */
+class TimerQueue
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    TimerId schedule(Clock::time_point deadline, std::function<void()> callback);
+
+    void cancel(TimerId id);
+
+    // Runs the callbacks of every timer that has expired, returns how many were run
+    std::size_t runExpired(Clock::time_point now);
+
+    [[nodiscard]] std::size_t size() const;
+
+    // The deadline of the first timer, which may have been cancelled, if there are any
+    [[nodiscard]] std::optional<Clock::time_point> nextDeadline() const;
+
+  private:
+    struct Timer
+    {
+      Clock::time_point m_deadline;
+      TimerId m_id;
+
+      bool operator>(const Timer& rhs) const
+      {
+        return m_deadline > rhs.m_deadline || (m_deadline == rhs.m_deadline && m_id > rhs.m_id);
+      }
+    };
+
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_heap;
+    std::unordered_map<TimerId, std::function<void()>> m_callbacks;
+    TimerId m_nextId = 1;
+};
+
+} // namespace odd::chord
+
+#endif // TIMER_QUEUE_H_
@@ -0,0 +1,393 @@
+#include "UdpConnectionManager.h"
+#include "../comms/CommsCoder.h"
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace odd::chord {
+
+namespace {
+
+uint32_t randomEpoch()
+{
+  std::random_device device;
+  std::uniform_int_distribution<uint32_t> distribution;
+
+  return distribution(device);
+}
+
+} // namespace
+
+UdpConnectionManager::UdpConnectionManager(const NodeId& nodeId,
+                                           uint32_t ip,
+                                           uint16_t port,
+                                           std::unique_ptr<ConnectionManager_I> streamTransport,
+                                           UdpTransportConfig config)
+  : m_socket{ip, port},
+    m_wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+    m_streamTransport(std::move(streamTransport)),
+    m_config(config),
+    m_nextWindowExpiry(Clock::now() + config.m_receiveWindowTimeout),
+    m_epoch(randomEpoch()),
+    m_nextSequence(1),
+    m_running(false),
+    m_localNodeId(nodeId),
+    m_localIpAddress(ip),
+    m_localPort(port)
+{
+  if (not m_socket.open())
+  {
+    std::cerr << "UdpConnectionManager could not open socket" << std::endl;
+    return;
+  }
+
+  m_running = true;
+  m_thread = std::thread{&UdpConnectionManager::threadFunction, this};
+}
+
+UdpConnectionManager::~UdpConnectionManager()
+{
+  stop();
+
+  if (m_wakeFd >= 0)
+  {
+    close(m_wakeFd);
+  }
+}
+
+bool UdpConnectionManager::send(const NodeId& nodeId, const Message& message)
+{
+  auto* peer = m_peers.find(nodeId);
+
+  if (peer == nullptr) return false;
+
+  auto encoded = message.encode();
+
+  if (encoded.m_length + HEADER_SIZE > std::min(m_config.m_maxDatagramSize, io::udp::MAX_DATAGRAM_SIZE))
+  {
+    return m_streamTransport ? m_streamTransport->send(nodeId, message) : false;
+  }
+
+  PendingDatagram pending;
+  pending.m_timeout = m_config.m_retransmitTimeout;
+  pending.m_deadline = Clock::now() + pending.m_timeout;
+  pending.m_transmissions = 1;
+
+  auto sequence = m_nextSequence++;
+  auto kind = DatagramKind::DATA;
+
+  auto& datagram = pending.m_datagram;
+  datagram.m_ipAddress = peer->m_ipAddress;
+  datagram.m_port = peer->m_port;
+  datagram.m_length = HEADER_SIZE + encoded.m_length;
+  encodeSingleValue(reinterpret_cast<const uint8_t*>(&kind), &datagram.m_data[0]);
+  encodeSingleValue(&m_epoch, &datagram.m_data[EPOCH_OFFSET]);
+  encodeSingleValue(&sequence, &datagram.m_data[SEQUENCE_OFFSET]);
+  std::memcpy(&datagram.m_data[HEADER_SIZE], encoded.m_message, encoded.m_length);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_outbox.push_back(datagram);
+    m_pending.emplace(sequence, std::move(pending));
+  }
+
+  wake();
+  return true;
+}
+
+bool UdpConnectionManager::broadcast(const Message& message)
+{
+  std::vector<NodeId> nodeIds;
+  nodeIds.reserve(m_peers.size());
+
+  for (const auto& peer : m_peers)
+  {
+    nodeIds.push_back(peer.m_id);
+  }
+
+  bool sent = false;
+
+  for (const auto& nodeId : nodeIds)
+  {
+    sent = send(nodeId, message) || sent;
+  }
+
+  return sent;
+}
+
+void UdpConnectionManager::registerReceiveHandler(io::tcp::OnReceiveCallback callback)
+{
+  if (m_streamTransport)
+  {
+    m_streamTransport->registerReceiveHandler(callback);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_onReceive = std::move(callback);
+}
+
+void UdpConnectionManager::insert(const NodeId& id, uint32_t ipAddress, uint16_t port)
+{
+  if (m_streamTransport)
+  {
+    m_streamTransport->insert(id, ipAddress, port);
+  }
+
+  if (port == 0) port = m_localPort;
+
+  auto [peer, inserted] = m_peers.insert(id, ipAddress, port);
+
+  if (not inserted)
+  {
+    peer->m_ipAddress = ipAddress;
+    peer->m_port = port;
+  }
+}
+
+void UdpConnectionManager::remove(const NodeId& id)
+{
+  if (m_streamTransport)
+  {
+    m_streamTransport->remove(id);
+  }
+
+  m_peers.remove(id);
+}
+
+void UdpConnectionManager::stop()
+{
+  if (m_running)
+  {
+    m_running = false;
+    wake();
+    m_thread.join();
+    m_socket.close();
+  }
+
+  if (m_streamTransport)
+  {
+    m_streamTransport->stop();
+  }
+}
+
+[[nodiscard]] uint32_t UdpConnectionManager::ip() const
+{
+  return m_localIpAddress;
+}
+
+[[nodiscard]] uint32_t UdpConnectionManager::ip(const NodeId& nodeId) const
+{
+  const auto* peer = m_peers.find(nodeId);
+
+  if (peer == nullptr) return 0;
+
+  return peer->m_ipAddress;
+}
+
+void UdpConnectionManager::setPinned(const std::vector<NodeId>& nodeIds)
+{
+  if (m_streamTransport)
+  {
+    m_streamTransport->setPinned(nodeIds);
+  }
+}
+
+std::size_t UdpConnectionManager::unacknowledgedCount()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pending.size();
+}
+
+void UdpConnectionManager::wake()
+{
+  uint64_t one = 1;
+  auto result = write(m_wakeFd, &one, sizeof(one));
+  (void) result;
+}
+
+void UdpConnectionManager::threadFunction()
+{
+  std::vector<io::udp::Datagram> received(m_config.m_receiveBatchSize);
+
+  while (m_running)
+  {
+    pollfd pollFds[2] = { pollfd{ m_socket.fd(), POLLIN, 0 }, pollfd{ m_wakeFd, POLLIN, 0 } };
+
+    int timeout;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      timeout = m_pending.empty() ? 100 : 10;
+    }
+
+    poll(pollFds, 2, timeout);
+
+    if (pollFds[1].revents & POLLIN)
+    {
+      uint64_t count;
+      auto result = read(m_wakeFd, &count, sizeof(count));
+      (void) result;
+    }
+
+    if (pollFds[0].revents & POLLIN)
+    {
+      auto receivedCount = m_socket.receiveBatch(received);
+
+      for (std::size_t i = 0; i < receivedCount; i++)
+      {
+        handleDatagram(received[i]);
+      }
+    }
+
+    auto now = Clock::now();
+
+    retransmitExpired(now);
+    expireReceiveWindows(now);
+    flushOutbox();
+  }
+}
+
+void UdpConnectionManager::handleDatagram(const io::udp::Datagram& datagram)
+{
+  if (datagram.m_length < HEADER_SIZE) return;
+
+  uint8_t kind;
+  uint32_t epoch;
+  uint32_t sequence;
+  decodeSingleValue(const_cast<uint8_t*>(&datagram.m_data[0]), &kind);
+  decodeSingleValue(const_cast<uint8_t*>(&datagram.m_data[EPOCH_OFFSET]), &epoch);
+  decodeSingleValue(const_cast<uint8_t*>(&datagram.m_data[SEQUENCE_OFFSET]), &sequence);
+
+  if (static_cast<DatagramKind>(kind) == DatagramKind::ACK)
+  {
+    // An acknowledgement of what an earlier instance on this port sent
+    if (epoch != m_epoch) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.erase(sequence);
+    return;
+  }
+
+  if (static_cast<DatagramKind>(kind) != DatagramKind::DATA) return;
+
+  io::tcp::OnReceiveCallback onReceive;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    onReceive = m_onReceive;
+  }
+
+  // Without a handler the datagram is not acknowledged, so the sender will send it again
+  if (not onReceive) return;
+
+  io::udp::Datagram ack;
+  auto ackKind = DatagramKind::ACK;
+  ack.m_ipAddress = datagram.m_ipAddress;
+  ack.m_port = datagram.m_port;
+  ack.m_length = HEADER_SIZE;
+  encodeSingleValue(reinterpret_cast<const uint8_t*>(&ackKind), &ack.m_data[0]);
+  encodeSingleValue(&epoch, &ack.m_data[EPOCH_OFFSET]);
+  encodeSingleValue(&sequence, &ack.m_data[SEQUENCE_OFFSET]);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_outbox.push_back(ack);
+  }
+
+  if (isDuplicate(datagram, epoch, sequence, Clock::now())) return;
+
+  onReceive(const_cast<uint8_t*>(&datagram.m_data[HEADER_SIZE]), datagram.m_length - HEADER_SIZE);
+}
+
+bool UdpConnectionManager::isDuplicate(const io::udp::Datagram& datagram,
+                                       uint32_t epoch,
+                                       uint32_t sequence,
+                                       Clock::time_point now)
+{
+  uint64_t source = (static_cast<uint64_t>(datagram.m_ipAddress) << 16) | datagram.m_port;
+
+  auto [it, inserted] = m_receiveWindows.try_emplace(source);
+  auto& window = it->second;
+
+  // The source has restarted, nothing it sent before is coming again
+  if (inserted || window.m_epoch != epoch)
+  {
+    window.m_epoch = epoch;
+    window.m_order.clear();
+    window.m_seen.clear();
+  }
+
+  window.m_lastHeard = now;
+
+  if (not window.m_seen.insert(sequence).second) return true;
+
+  window.m_order.push_back(sequence);
+
+  if (window.m_order.size() > m_config.m_duplicateWindow)
+  {
+    window.m_seen.erase(window.m_order.front());
+    window.m_order.pop_front();
+  }
+
+  return false;
+}
+
+void UdpConnectionManager::expireReceiveWindows(Clock::time_point now)
+{
+  if (now < m_nextWindowExpiry) return;
+
+  m_nextWindowExpiry = now + m_config.m_receiveWindowTimeout;
+
+  std::erase_if(m_receiveWindows, [this, now] (const auto& entry)
+  {
+    return now - entry.second.m_lastHeard > m_config.m_receiveWindowTimeout;
+  });
+}
+
+void UdpConnectionManager::retransmitExpired(Clock::time_point now)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  for (auto it = m_pending.begin(); it != m_pending.end();)
+  {
+    auto& pending = it->second;
+
+    if (pending.m_deadline > now)
+    {
+      ++it;
+      continue;
+    }
+
+    if (pending.m_transmissions >= m_config.m_maxTransmissions)
+    {
+      it = m_pending.erase(it);
+      continue;
+    }
+
+    pending.m_transmissions++;
+    pending.m_timeout *= 2;
+    pending.m_deadline = now + pending.m_timeout;
+    m_outbox.push_back(pending.m_datagram);
+    ++it;
+  }
+}
+
+void UdpConnectionManager::flushOutbox()
+{
+  std::vector<io::udp::Datagram> toSend;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::swap(toSend, m_outbox);
+  }
+
+  if (toSend.empty()) return;
+
+  // Anything that does not fit in the socket buffer is dropped, unacknowledged DATA will be sent
+  // again and a lost ACK causes the DATA to be sent again.
+  m_socket.sendBatch(toSend.data(), toSend.size());
+}
+
+} // namespace odd::chord
@@ -0,0 +1,151 @@
+#ifndef UDP_CONNECTION_MANAGER_H_
+#define UDP_CONNECTION_MANAGER_H_
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <udp/Socket.h>
+
+#include "ConnectionManager.h"
+#include "PeerDirectory.h"
+
+namespace odd::chord {
+
+struct UdpTransportConfig
+{
+  // Messages that would not fit in a datagram of this size are sent with the stream transport
+  std::size_t m_maxDatagramSize = 1200;
+  std::chrono::milliseconds m_retransmitTimeout{ 200 };
+  std::size_t m_maxTransmissions = 5;
+
+  // The number of sequence numbers remembered per source to suppress duplicates
+  std::size_t m_duplicateWindow = 1024;
+
+  // A source not heard from for this long is forgotten, longer than a datagram is retransmitted for
+  std::chrono::seconds m_receiveWindowTimeout{ 30 };
+  std::size_t m_receiveBatchSize = 32;
+};
+
+/*
+ * Sends small Chord messages as UDP datagrams, so that a node can send to any peer without setting
+ * up or holding a connection. Each datagram carries a header of a kind, an epoch and a sequence
+ * number:
+ *
+ * Kind 1 byte (DATA or ACK)
+ * Epoch 4 bytes
+ * Sequence 4 bytes
+ * payload (the encoded Message, DATA only)
+ *
+ * The epoch is picked at random by each instance and an ACK carries the epoch of the DATA it
+ * acknowledges. The receiver acknowledges every DATA datagram and drops any sequence number it has
+ * already seen from the same source in the same epoch, a new epoch from a source (the peer has
+ * restarted) starts its window again. The sender retransmits a DATA datagram, doubling the timeout each time,
+ * until it is acknowledged or it has been sent m_maxTransmissions times. Datagrams are sent and
+ * received in batches by a single io thread. Messages that are too large for a datagram, and
+ * anything the stream transport is needed for, are passed to the stream transport (e.g. tcp).
+ *
+ * Peers inserted with a port of zero are assumed to listen on the same port as this node.
+ */
+class UdpConnectionManager : public ConnectionManager_I
+{
+  public:
+    enum class DatagramKind : uint8_t
+    {
+      DATA = 0x01,
+      ACK  = 0x02,
+    };
+
+    static constexpr std::size_t EPOCH_OFFSET = sizeof(DatagramKind);
+    static constexpr std::size_t SEQUENCE_OFFSET = EPOCH_OFFSET + sizeof(uint32_t);
+    static constexpr std::size_t HEADER_SIZE = SEQUENCE_OFFSET + sizeof(uint32_t);
+
+    UdpConnectionManager(const NodeId& nodeId,
+                         uint32_t ip,
+                         uint16_t port,
+                         std::unique_ptr<ConnectionManager_I> streamTransport,
+                         UdpTransportConfig config = {});
+    ~UdpConnectionManager() override;
+
+    bool send(const NodeId& nodeId, const Message& message) override;
+
+    bool broadcast(const Message& message) override;
+
+    void registerReceiveHandler(io::tcp::OnReceiveCallback callback) override;
+
+    void insert(const NodeId& id, uint32_t ipAddress, uint16_t port) override;
+
+    void remove(const NodeId& id) override;
+
+    void stop() override;
+
+    [[nodiscard]] uint32_t ip() const override;
+
+    [[nodiscard]] uint32_t ip(const NodeId& nodeId) const override;
+
+    void setPinned(const std::vector<NodeId>& nodeIds) override;
+
+    [[nodiscard]] std::size_t unacknowledgedCount();
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingDatagram
+    {
+      io::udp::Datagram m_datagram;
+      Clock::time_point m_deadline;
+      std::chrono::milliseconds m_timeout;
+      std::size_t m_transmissions;
+    };
+
+    struct ReceiveWindow
+    {
+      uint32_t m_epoch;
+      Clock::time_point m_lastHeard;
+      std::deque<uint32_t> m_order;
+      std::unordered_set<uint32_t> m_seen;
+    };
+
+    void threadFunction();
+    void handleDatagram(const io::udp::Datagram& datagram);
+    bool isDuplicate(const io::udp::Datagram& datagram, uint32_t epoch, uint32_t sequence, Clock::time_point now);
+    void expireReceiveWindows(Clock::time_point now);
+    void retransmitExpired(Clock::time_point now);
+    void flushOutbox();
+    void wake();
+
+    io::udp::Socket m_socket;
+    int m_wakeFd;
+    std::unique_ptr<ConnectionManager_I> m_streamTransport;
+    const UdpTransportConfig m_config;
+
+    PeerDirectory m_peers;
+
+    std::mutex m_mutex;
+    std::vector<io::udp::Datagram> m_outbox;
+    std::unordered_map<uint32_t, PendingDatagram> m_pending;
+
+    // Only used by the io thread
+    std::unordered_map<uint64_t, ReceiveWindow> m_receiveWindows;
+    Clock::time_point m_nextWindowExpiry;
+
+    io::tcp::OnReceiveCallback m_onReceive;
+    const uint32_t m_epoch;
+    std::atomic<uint32_t> m_nextSequence;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+
+    NodeId m_localNodeId;
+    const uint32_t m_localIpAddress;
+    const uint16_t m_localPort;
+};
+
+} // namespace odd::chord
+
+#endif // UDP_CONNECTION_MANAGER_H_
@@ -1,14 +1,27 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <bit>
 
 #include "../ChordNode.h"
 #include "../ChordMessaging.h"
+#include "../ConnectionManager.h"
+#include "../Executor.h"
+#include "../MaintenanceSchedule.h"
 #include "../NodeId.h"
+#include "../PeerDirectory.h"
+#include "../PeerLatency.h"
+#include "../SimulationExecutor.h"
+#include "../TimerQueue.h"
 #include <simulation/Network.h>
+#include <simulation/Scheduler.h>
+#include <tcp/Server.h>
 
 namespace odd::chord::test {
 
@@ -34,6 +47,8 @@ class MockConnectionManager : public ConnectionManager_I
       uint32_t ip{ 0 };
       bool foundNode{ false };
 
+      std::unique_lock<std::mutex> lock(m_mutex);
+
       for (const auto& idIpPair : m_nodeIdToIp)
       {
         if (idIpPair.first == nodeId)
@@ -49,6 +64,8 @@ class MockConnectionManager : public ConnectionManager_I
         m_logger->log(m_logPrefix + "could not find node " + nodeId.toString() + " failed to send message");
         return false;
       }
+
+      lock.unlock();
       m_logger->log(m_logPrefix + "found ip for " + nodeId.toString() + " sending message to " + std::to_string(ip));
 
       auto encoded = message.encode();
@@ -61,6 +78,10 @@ class MockConnectionManager : public ConnectionManager_I
     bool broadcast(const Message& message) override
     {
       m_logger->log(m_logPrefix + "broadcasting message");
+      m_broadcasts++;
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+
       for (const auto& idIpPair : m_nodeIdToIp)
       {
         auto encoded = message.encode();
@@ -89,6 +110,8 @@ class MockConnectionManager : public ConnectionManager_I
 
     void insert(const NodeId& id, uint32_t ipAddress, uint16_t port) override
     {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
       for (const auto& idIpPair : m_nodeIdToIp)
       {
         // There is already a connection to this node
@@ -115,6 +138,8 @@ class MockConnectionManager : public ConnectionManager_I
 
     [[nodiscard]] uint32_t ip(const NodeId& nodeId) const override
     {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
       for (const auto& idIpPair : m_nodeIdToIp)
       {
         if (idIpPair.first == nodeId)
@@ -126,17 +151,42 @@ class MockConnectionManager : public ConnectionManager_I
       return 0;
     }
 
+    // Drops the node's address, as if this node had never been told it
+    void forget(const NodeId& nodeId)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      std::erase_if(m_nodeIdToIp, [&nodeId] (const auto& idIpPair) { return idIpPair.first == nodeId; });
+    }
+
+    [[nodiscard]] std::size_t broadcasts() const
+    {
+      return m_broadcasts;
+    }
+
   private:
     NodeId m_nodeId;
     io::simulation::Node& m_simulatedNode;
 
+    // The node's work thread sends while the test thread may be forgetting addresses
+    mutable std::mutex m_mutex;
     std::vector<std::pair<NodeId, uint32_t>> m_nodeIdToIp;
+    std::atomic<std::size_t> m_broadcasts{ 0 };
 
     io::tcp::OnReceiveCallback m_onReceive;
     std::unique_ptr<logging::Logger> m_logger;
     const std::string m_logPrefix;
 };
 
+// Gives every node a MockConnectionManager on a node of its own in the simulated network
+ConnectionManagerFactory mockConnectionManagerFactory(io::simulation::Network& network, logging::Log& log)
+{
+  return [&network, &log] (const NodeId& nodeId, uint32_t ipAddress, uint16_t)
+  {
+    return std::make_unique<MockConnectionManager>(nodeId, network.addNode(ipAddress), log.makeLogger("CONMAN"));
+  };
+}
+
 class Timer {
   private:
     std::chrono::time_point<std::chrono::high_resolution_clock> start_timepoint;
@@ -226,10 +276,7 @@ TEST_CASE("Test the creation of a chord node")
   io::simulation::Network network;
   logging::Log log;
 
-  ConnectionManagerFactory factory = [&network, &log] (const NodeId& nodeId, uint32_t ipAddress, uint16_t port)
-  {
-    return std::make_unique<MockConnectionManager>(nodeId, network.addNode(ipAddress), log.makeLogger("CONMAN"));
-  };
+  auto factory = mockConnectionManagerFactory(network, log);
 
   ChordNode node0{"node0", "200.178.0.1", 0, factory, log.makeLogger("CHORDNODE")};
   node0.create();
@@ -249,10 +296,7 @@ TEST_CASE("Create a chord ring with 6 nodes")
   io::simulation::Network network;
   logging::Log log;
 
-  ConnectionManagerFactory factory = [&network, &log] (const NodeId& nodeId, uint32_t ipAddress, uint16_t port)
-  {
-    return std::make_unique<MockConnectionManager>(nodeId, network.addNode(ipAddress), log.makeLogger("CONMAN"));
-  };
+  auto factory = mockConnectionManagerFactory(network, log);
 
   ChordNode node0{"node0", "200.178.0.1", 0, factory, log.makeLogger("CHORDNODE")};
   node0.create();
@@ -304,6 +348,351 @@ TEST_CASE("Create a chord ring with 6 nodes")
   CHECK(node5.getSuccessorId() == node3.getId());
 }
 
+TEST_CASE("A node that stops answering is purged from the routing state of the others")
+{
+  io::simulation::Network network;
+  logging::Log log;
+
+  auto factory = mockConnectionManagerFactory(network, log);
+
+  ChordConfig config;
+  config.m_probeSilentPeersAfter = std::chrono::milliseconds{ 1500 };
+  config.m_initialRequestTimeout = std::chrono::milliseconds{ 300 };
+
+  ChordNode node0{"node0", "200.178.0.1", 0, factory, log.makeLogger("CHORDNODE"), config};
+  node0.create();
+
+  ChordNode node1{"node1", "200.178.0.5", 0, factory, log.makeLogger("CHORDNODE"), config};
+  node1.join("200.178.0.1");
+  std::this_thread::sleep_for(std::chrono::seconds{8});
+
+  auto node2 = std::make_unique<ChordNode>("node2", "200.178.0.10", 0, factory, log.makeLogger("CHORDNODE"), config);
+  node2->join("200.178.0.5");
+  std::this_thread::sleep_for(std::chrono::seconds{8});
+
+  auto node2Id = node2->getId();
+  REQUIRE((node0.getSuccessorId() == node2Id || node1.getSuccessorId() == node2Id));
+
+  // Stopping the node cancels its receive handler, so messages to it are silently dropped
+  node2.reset();
+  std::this_thread::sleep_for(std::chrono::seconds{10});
+
+  CHECK(node0.getSuccessorId() == node1.getId());
+  CHECK(node1.getSuccessorId() == node0.getId());
+  CHECK(node0.getPredecessorId() != node2Id);
+  CHECK(node1.getPredecessorId() != node2Id);
+}
+
+TEST_CASE("A node that leaves is spliced out of the ring straight away and can join again")
+{
+  io::simulation::Network network;
+  logging::Log log;
+
+  auto factory = mockConnectionManagerFactory(network, log);
+
+  ChordNode node0{"node0", "200.178.0.1", 0, factory, log.makeLogger("CHORDNODE")};
+  node0.create();
+
+  ChordNode node1{"node1", "200.178.0.5", 0, factory, log.makeLogger("CHORDNODE")};
+  node1.join("200.178.0.1");
+  std::this_thread::sleep_for(std::chrono::seconds{5});
+
+  ChordNode node2{"node2", "200.178.0.10", 0, factory, log.makeLogger("CHORDNODE")};
+  node2.join("200.178.0.5");
+  std::this_thread::sleep_for(std::chrono::seconds{8});
+
+  auto node2Id = node2.getId();
+  REQUIRE((node0.getSuccessorId() == node2Id || node1.getSuccessorId() == node2Id));
+
+  node2.leave();
+
+  // Well inside any timeout or probe, so only the leave messages can have repaired the ring
+  std::this_thread::sleep_for(std::chrono::milliseconds{200});
+
+  CHECK(node0.getSuccessorId() == node1.getId());
+  CHECK(node1.getSuccessorId() == node0.getId());
+  CHECK(node0.getPredecessorId() == node1.getId());
+  CHECK(node1.getPredecessorId() == node0.getId());
+
+  for (const auto* node : { &node0, &node1 })
+  {
+    const auto& fingers = node->getFingerTable().m_fingers;
+    CHECK(std::none_of(fingers.begin(), fingers.end(), [&node2Id] (const auto& finger) { return finger.m_nodeId == node2Id; }));
+  }
+
+  CHECK(node2.getSuccessorId() == node2Id);
+
+  node2.join("200.178.0.1");
+  std::this_thread::sleep_for(std::chrono::seconds{5});
+
+  CHECK((node0.getSuccessorId() == node2Id || node1.getSuccessorId() == node2Id));
+}
+
+TEST_CASE("A reply to a node whose address is not known waits for a routed address lookup")
+{
+  io::simulation::Network network;
+  logging::Log log;
+
+  std::map<NodeId, MockConnectionManager*> managers;
+
+  ConnectionManagerFactory factory = [&network, &log, &managers] (const NodeId& nodeId, uint32_t ipAddress, uint16_t)
+  {
+    auto manager = std::make_unique<MockConnectionManager>(nodeId, network.addNode(ipAddress), log.makeLogger("CONMAN"));
+    managers[nodeId] = manager.get();
+    return manager;
+  };
+
+  ChordNode node0{"node0", "200.178.0.1", 0, factory, log.makeLogger("CHORDNODE")};
+  node0.create();
+
+  ChordNode node1{"node1", "200.178.0.5", 0, factory, log.makeLogger("CHORDNODE")};
+  node1.join("200.178.0.1");
+  std::this_thread::sleep_for(std::chrono::seconds{5});
+
+  ChordNode node2{"node2", "200.178.0.10", 0, factory, log.makeLogger("CHORDNODE")};
+  node2.join("200.178.0.5");
+  std::this_thread::sleep_for(std::chrono::seconds{8});
+
+  // node0 -> node1 -> node2 -> node0
+  REQUIRE(node1.getSuccessorId() == node2.getId());
+  REQUIRE(node2.getSuccessorId() == node0.getId());
+
+  // node0 has to answer node2's stabilise requests, and has to ask node1 where node2 is first
+  managers[node0.getId()]->forget(node2.getId());
+  std::this_thread::sleep_for(std::chrono::seconds{3});
+
+  CHECK(managers[node0.getId()]->ip(node2.getId()) != 0);
+  CHECK(node2.getSuccessorId() == node0.getId());
+  CHECK(node0.getPredecessorId() == node2.getId());
+
+  for (const auto& [nodeId, manager] : managers)
+  {
+    CHECK(manager->broadcasts() == 0);
+  }
+}
+
+TEST_CASE("A ring runs in deterministic virtual time without threads of its own")
+{
+  using namespace std::chrono_literals;
+
+  // Returns every node's successor list and fingers after half an hour
+  auto simulate = [] (uint64_t seed)
+  {
+    constexpr std::size_t nodeCount = 12;
+
+    io::simulation::Scheduler scheduler;
+    io::simulation::Network network{ scheduler, io::simulation::LinkModel{ seed, io::simulation::LinkProfile{ 5ms, 5ms, 0.0 } } };
+    logging::Log log;
+
+    auto clock = std::make_shared<SimulationClock>(scheduler);
+
+    auto factory = mockConnectionManagerFactory(network, log);
+
+    std::vector<std::unique_ptr<ChordNode>> nodes;
+
+    for (std::size_t i = 0; i < nodeCount; i++)
+    {
+      nodes.push_back(std::make_unique<ChordNode>("node" + std::to_string(i),
+                                                  "10.0.0." + std::to_string(i + 1),
+                                                  0,
+                                                  factory,
+                                                  log.makeLogger("CHORDNODE"),
+                                                  ChordConfig{},
+                                                  std::make_unique<SimulationExecutor>(scheduler),
+                                                  clock));
+
+      if (i == 0)
+      {
+        nodes[i]->create();
+      }
+      else
+      {
+        nodes[i]->join("10.0.0." + std::to_string(i));
+      }
+
+      scheduler.runFor(2s);
+    }
+
+    scheduler.runFor(30min);
+
+    CHECK(scheduler.now() == 30min + 2s * nodeCount);
+
+    std::vector<NodeId> ids;
+
+    for (const auto& node : nodes)
+    {
+      ids.push_back(node->getId());
+    }
+
+    std::sort(ids.begin(), ids.end());
+
+    std::vector<std::vector<NodeId>> state;
+
+    for (const auto& node : nodes)
+    {
+      auto position = std::lower_bound(ids.begin(), ids.end(), node->getId()) - ids.begin();
+      const auto& successor = ids[(position + 1) % ids.size()];
+      const auto& predecessor = ids[(position + ids.size() - 1) % ids.size()];
+
+      CHECK(node->getSuccessorId() == successor);
+      CHECK(node->getPredecessorId() == predecessor);
+
+      auto nodeState = node->successorList();
+
+      for (const auto& finger : node->getFingerTable().m_fingers)
+      {
+        nodeState.push_back(finger.m_nodeId);
+      }
+
+      state.push_back(nodeState);
+    }
+
+    return state;
+  };
+
+  auto first = simulate(5);
+  auto second = simulate(5);
+
+  CHECK(first == second);
+}
+
+TEST_CASE("Every finger is correct a few seconds after the ring forms")
+{
+  io::simulation::Network network;
+  logging::Log log;
+
+  auto factory = mockConnectionManagerFactory(network, log);
+
+  ChordNode node0{"node0", "200.178.0.1", 0, factory, log.makeLogger("CHORDNODE")};
+  node0.create();
+
+  ChordNode node1{"node1", "200.178.0.5", 0, factory, log.makeLogger("CHORDNODE")};
+  node1.join("200.178.0.1");
+  std::this_thread::sleep_for(std::chrono::seconds{5});
+
+  ChordNode node2{"node2", "200.178.0.10", 0, factory, log.makeLogger("CHORDNODE")};
+  node2.join("200.178.0.5");
+  std::this_thread::sleep_for(std::chrono::seconds{8});
+
+  std::vector<NodeId> ring{ node0.getId(), node1.getId(), node2.getId() };
+  std::sort(ring.begin(), ring.end());
+
+  auto successorOf = [&ring] (const NodeId& id)
+  {
+    auto it = std::lower_bound(ring.begin(), ring.end(), id);
+    return it == ring.end() ? ring.front() : *it;
+  };
+
+  auto nextOf = [&ring] (const NodeId& id)
+  {
+    auto it = std::upper_bound(ring.begin(), ring.end(), id);
+    return it == ring.end() ? ring.front() : *it;
+  };
+
+  for (const auto* node : { &node0, &node1, &node2 })
+  {
+    const auto& fingers = node->getFingerTable().m_fingers;
+    std::size_t wrongFingers = 0;
+
+    for (const auto& finger : fingers)
+    {
+      if (finger.m_nodeId != successorOf(finger.m_end)) wrongFingers++;
+    }
+
+    CHECK(wrongFingers == 0);
+
+    // Stabilise passes the successor list back along the ring
+    auto successors = node->successorList();
+    REQUIRE(successors.size() == 2);
+    CHECK(successors[0] == nextOf(node->getId()));
+    CHECK(successors[1] == nextOf(successors[0]));
+  }
+
+  // A node that joins the formed ring takes its fingers from its successor
+  ChordNode node3{"node3", "200.178.0.20", 0, factory, log.makeLogger("CHORDNODE")};
+  node3.join("200.178.0.1");
+  std::this_thread::sleep_for(std::chrono::seconds{2});
+
+  ring.push_back(node3.getId());
+  std::sort(ring.begin(), ring.end());
+
+  std::size_t wrongFingers = 0;
+
+  for (const auto& finger : node3.getFingerTable().m_fingers)
+  {
+    if (finger.m_nodeId != successorOf(finger.m_end)) wrongFingers++;
+  }
+
+  CHECK(wrongFingers == 0);
+}
+
+TEST_CASE("Bootstrap response messaging test")
+{
+  NodeId sourceNodeId { "87654321-abcdabcd-eff00ffe-dcbadcba-12345678" };
+  NodeAddress predecessor{ NodeId{ "00000001-00000000-00000000-00000000-00000000" }, 0x0a000001 };
+  std::vector<NodeAddress> successors{ { NodeId{ "90000000-00000000-00000000-00000000-00000000" }, 0x0a000002 } };
+  std::vector<NodeAddress> fingers{ successors[0], { NodeId{ "a0000000-00000000-00000000-00000000-00000000" }, 0x0a000003 } };
+
+  BootstrapResponseMessage message{ CommsVersion::V1, sourceNodeId, 42, predecessor, successors, fingers };
+  BootstrapResponseMessage decoded{ CommsVersion::V1 };
+
+  decoded.decode(message.encode());
+
+  REQUIRE(decoded.sourceNodeId() == sourceNodeId);
+  REQUIRE(decoded.requestId() == 42);
+  REQUIRE(decoded.predecessor());
+  REQUIRE(decoded.predecessor()->m_nodeId == predecessor.m_nodeId);
+  REQUIRE(decoded.predecessor()->m_ip == predecessor.m_ip);
+  REQUIRE(decoded.successors().size() == 1);
+  REQUIRE(decoded.successors()[0].m_nodeId == successors[0].m_nodeId);
+  REQUIRE(decoded.fingers().size() == 2);
+  REQUIRE(decoded.fingers()[1].m_nodeId == fingers[1].m_nodeId);
+  REQUIRE(decoded.fingers()[1].m_ip == fingers[1].m_ip);
+
+  BootstrapResponseMessage empty{ CommsVersion::V1, sourceNodeId, 43, std::nullopt, {}, {} };
+  decoded.decode(empty.encode());
+
+  REQUIRE(not decoded.predecessor());
+  REQUIRE(decoded.successors().empty());
+  REQUIRE(decoded.fingers().empty());
+}
+
+TEST_CASE("Stabilise response messaging test")
+{
+  NodeId sourceNodeId { "87654321-abcdabcd-eff00ffe-dcbadcba-12345678" };
+  NodeAddress predecessor{ NodeId{ "00000001-00000000-00000000-00000000-00000000" }, 0x0a000001 };
+  std::vector<NodeAddress> successors{ { NodeId{ "90000000-00000000-00000000-00000000-00000000" }, 0x0a000002 },
+                                       { NodeId{ "a0000000-00000000-00000000-00000000-00000000" }, 0x0a000003 } };
+
+  StabiliseResponseMessage full{ CommsVersion::V1, sourceNodeId, 7, 0x1234567890abcdef, predecessor, successors };
+  StabiliseResponseMessage decoded{ CommsVersion::V1 };
+
+  decoded.decode(full.encode());
+
+  REQUIRE(decoded.sourceNodeId() == sourceNodeId);
+  REQUIRE(decoded.requestId() == 7);
+  REQUIRE(decoded.state() == 0x1234567890abcdef);
+  REQUIRE(not decoded.unchanged());
+  REQUIRE(decoded.predecessor());
+  REQUIRE(decoded.predecessor()->m_nodeId == predecessor.m_nodeId);
+  REQUIRE(decoded.successors().size() == 2);
+  REQUIRE(decoded.successors()[1].m_nodeId == successors[1].m_nodeId);
+  REQUIRE(decoded.successors()[1].m_ip == successors[1].m_ip);
+
+  // When nothing has changed only the state is sent back
+  StabiliseResponseMessage unchanged{ CommsVersion::V1, sourceNodeId, 8, 0x1234567890abcdef };
+  auto encoded = unchanged.encode();
+
+  REQUIRE(encoded.m_length < full.encode().m_length);
+
+  decoded.decode(std::move(encoded));
+
+  REQUIRE(decoded.requestId() == 8);
+  REQUIRE(decoded.unchanged());
+  REQUIRE(not decoded.predecessor());
+  REQUIRE(decoded.successors().empty());
+}
+
 TEST_CASE("Chord messaging test")
 {
   NodeId nodeId { "12345678-abcdabcd-effeeffe-dcbadcba-87654321" };
@@ -322,5 +711,214 @@ TEST_CASE("Chord messaging test")
   REQUIRE(decodedMessage.requestId() == 3987);
 }
 
-} // namespace odd::chord::test
+TEST_CASE("PeerDirectory finds the records that are inserted and not removed")
+{
+  PeerDirectory directory;
+  std::vector<NodeId> nodeIds;
+
+  for (uint32_t ip = 1; ip <= 1000; ip++)
+  {
+    nodeIds.emplace_back(ip);
+    auto [peer, inserted] = directory.insert(nodeIds.back(), ip, 0);
+    CHECK(inserted);
+    CHECK(peer->m_ipAddress == ip);
+  }
+
+  REQUIRE(directory.size() == 1000);
+
+  // Inserting an existing id returns the existing record
+  auto [existing, inserted] = directory.insert(nodeIds[10], 12345, 0);
+  CHECK_FALSE(inserted);
+  CHECK(existing->m_ipAddress == 11);
+
+  // Remove every other node
+  for (std::size_t i = 0; i < nodeIds.size(); i += 2)
+  {
+    CHECK(directory.remove(nodeIds[i]));
+  }
+
+  CHECK_FALSE(directory.remove(nodeIds[0]));
+  REQUIRE(directory.size() == 500);
+
+  for (std::size_t i = 0; i < nodeIds.size(); i++)
+  {
+    auto* peer = directory.find(nodeIds[i]);
+
+    if (i % 2 == 0)
+    {
+      CHECK(peer == nullptr);
+    }
+    else
+    {
+      REQUIRE(peer != nullptr);
+      CHECK(peer->m_id == nodeIds[i]);
+      CHECK(peer->m_ipAddress == i + 1);
+    }
+  }
+}
+
+TEST_CASE("ConnectionManager caps the number of open connections")
+{
+  constexpr uint32_t localhost = 0x7F000001;
+
+  io::tcp::Server server0{localhost, 54101};
+  io::tcp::Server server1{localhost, 54102};
+  io::tcp::Server server2{localhost, 54103};
+  server0.start();
+  server1.start();
+  server2.start();
+
+  ConnectionCacheConfig config;
+  config.m_maxOpenConnections = 2;
+
+  ConnectionManager connectionManager{NodeId{ localhost }, localhost, 54100, config};
+
+  NodeId nodeId0{ "00000000-00000000-00000000-00000000-00000001" };
+  NodeId nodeId1{ "00000000-00000000-00000000-00000000-00000002" };
+  NodeId nodeId2{ "00000000-00000000-00000000-00000000-00000003" };
+
+  connectionManager.insert(nodeId0, localhost, 54101);
+  connectionManager.insert(nodeId1, localhost, 54102);
+  connectionManager.insert(nodeId2, localhost, 54103);
+
+  CHECK(connectionManager.openConnectionCount() == 0);
+  CHECK(connectionManager.ip(nodeId1) == localhost);
+
+  NotifyMessage message{ CommsVersion::V1, nodeId0 };
+
+  connectionManager.setPinned({ nodeId0 });
+
+  CHECK(connectionManager.send(nodeId0, message));
+  CHECK(connectionManager.send(nodeId1, message));
+  CHECK(connectionManager.openConnectionCount() == 2);
+
+  // The cap has been reached, the least recently used unpinned connection is closed
+  CHECK(connectionManager.send(nodeId2, message));
+  CHECK(connectionManager.openConnectionCount() == 2);
+  CHECK(connectionManager.isConnected(nodeId0));
+  CHECK_FALSE(connectionManager.isConnected(nodeId1));
+  CHECK(connectionManager.isConnected(nodeId2));
+
+  // The closed connection is opened again when it is next used
+  CHECK(connectionManager.send(nodeId1, message));
+  CHECK(connectionManager.isConnected(nodeId1));
+  CHECK_FALSE(connectionManager.isConnected(nodeId2));
+}
+
+TEST_CASE("TimerQueue runs expired timers in deadline order and skips cancelled ones")
+{
+  TimerQueue timers;
+  std::vector<int> order;
+  auto start = TimerQueue::Clock::now();
+
+  timers.schedule(start + std::chrono::milliseconds(30), [&] { order.push_back(3); });
+  timers.schedule(start + std::chrono::milliseconds(10), [&] { order.push_back(1); });
+  auto cancelled = timers.schedule(start + std::chrono::milliseconds(20), [&] { order.push_back(2); });
+  timers.schedule(start + std::chrono::milliseconds(100), [&] { order.push_back(4); });
+
+  timers.cancel(cancelled);
+
+  CHECK(timers.runExpired(start) == 0);
+  CHECK(timers.runExpired(start + std::chrono::milliseconds(50)) == 2);
+  CHECK(order == std::vector<int>{ 1, 3 });
+  CHECK(timers.size() == 1);
+}
+
+TEST_CASE("ThreadExecutor sleeps until the step's wake up time or until it is woken")
+{
+  using namespace std::chrono_literals;
 
+  std::atomic<int> steps{ 0 };
+  std::atomic<bool> soon{ false };
+
+  ThreadExecutor executor;
+
+  executor.start([&]
+  {
+    steps++;
+    return Clock_I::Clock::now() + (soon ? 20ms : 1h);
+  });
+
+  std::this_thread::sleep_for(100ms);
+  CHECK(steps == 1);
+
+  executor.wake();
+  std::this_thread::sleep_for(50ms);
+  CHECK(steps == 2);
+
+  int ran = 0;
+  executor.runAndWait([&] { ran = steps; });
+  CHECK(ran == 2);
+
+  // Woken by the function, so the step runs after it
+  std::this_thread::sleep_for(50ms);
+  CHECK(steps == 3);
+
+  soon = true;
+  executor.wake();
+  std::this_thread::sleep_for(200ms);
+  executor.stop();
+
+  CHECK(steps > 5);
+  CHECK(steps < 20);
+}
+
+TEST_CASE("MaintenanceSchedule backs off while nothing changes and snaps back on a change")
+{
+  using namespace std::chrono_literals;
+
+  MaintenanceSchedule schedule{ 1000ms, 5000ms, 2 };
+  auto start = MaintenanceSchedule::Clock::now();
+
+  CHECK(schedule.due(start));
+
+  schedule.started(start);
+  CHECK(not schedule.due(start + 999ms));
+  CHECK(schedule.due(start + 1000ms));
+
+  schedule.recordUnchanged();
+  CHECK(schedule.interval() == 2000ms);
+  CHECK(not schedule.due(start + 1999ms));
+
+  schedule.recordUnchanged();
+  schedule.recordUnchanged();
+  CHECK(schedule.interval() == 5000ms);
+
+  // A change part way through the backed off interval makes the next round due a minimum
+  // interval after the last one started
+  schedule.started(start + 10s);
+  schedule.recordChange();
+  CHECK(schedule.interval() == 1000ms);
+  CHECK(schedule.due(start + 11s));
+}
+
+TEST_CASE("PeerLatencyTracker adapts the timeout to the round trip times of each peer")
+{
+  using namespace std::chrono_literals;
+
+  PeerLatencyTracker tracker{ 1000ms, 10ms, 8000ms };
+  NodeId fast{ "00000000-00000000-00000000-00000000-00000001" };
+  NodeId unknown{ "00000000-00000000-00000000-00000000-00000002" };
+
+  CHECK(tracker.timeout(unknown) == 1000ms);
+
+  for (int i = 0; i < 19; i++)
+  {
+    tracker.recordSample(fast, 2ms);
+  }
+
+  tracker.recordSample(fast, 40ms);
+
+  CHECK(tracker.timeout(fast) < 1000ms);
+  CHECK(tracker.timeout(fast) >= 10ms);
+  CHECK(tracker.hedgeDelay(fast) == 40ms);
+
+  auto timeout = tracker.timeout(fast);
+  tracker.recordTimeout(fast);
+  CHECK(tracker.timeout(fast) == 2 * timeout);
+
+  tracker.recordTimeout(unknown);
+  CHECK(tracker.timeout(unknown) == 2000ms);
+}
+
+} // namespace odd::chord::test
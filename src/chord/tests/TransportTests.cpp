@@ -0,0 +1,365 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "../ChordMessaging.h"
+#include "../ChordNode.h"
+#include "../ConnectionManager.h"
+#include "../LoopbackConnectionManager.h"
+#include "../NodeId.h"
+#include "../ShmConnectionManager.h"
+#include "../UdpConnectionManager.h"
+#include "../../comms/CommsCoder.h"
+#include <trace/TraceReader.h>
+#include <trace/TraceWriter.h>
+#include <udp/Socket.h>
+
+namespace odd::chord::test {
+
+namespace {
+
+constexpr uint32_t localhost = 0x7F000001;
+
+template <typename Predicate>
+bool waitFor(Predicate predicate)
+{
+  for (int attempt = 0; attempt < 200; attempt++)
+  {
+    if (predicate()) return true;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  return predicate();
+}
+
+io::udp::Datagram makeDatagram(uint16_t port, uint32_t epoch, uint32_t sequence, const EncodedMessage& encoded)
+{
+  auto kind = UdpConnectionManager::DatagramKind::DATA;
+
+  io::udp::Datagram datagram;
+  datagram.m_ipAddress = localhost;
+  datagram.m_port = port;
+  datagram.m_length = UdpConnectionManager::HEADER_SIZE + encoded.m_length;
+  encodeSingleValue(reinterpret_cast<const uint8_t*>(&kind), &datagram.m_data[0]);
+  encodeSingleValue(&epoch, &datagram.m_data[UdpConnectionManager::EPOCH_OFFSET]);
+  encodeSingleValue(&sequence, &datagram.m_data[UdpConnectionManager::SEQUENCE_OFFSET]);
+  std::memcpy(&datagram.m_data[UdpConnectionManager::HEADER_SIZE], encoded.m_message, encoded.m_length);
+
+  return datagram;
+}
+
+} // namespace
+
+TEST_CASE("UdpConnectionManager delivers a message and it is acknowledged")
+{
+  NodeId sender{ "00000000-00000000-00000000-00000000-00000001" };
+  NodeId receiver{ "00000000-00000000-00000000-00000000-00000002" };
+
+  UdpConnectionManager senderTransport{sender, localhost, 54401, nullptr};
+  UdpConnectionManager receiverTransport{receiver, localhost, 54402, nullptr};
+
+  std::atomic<int> receivedCount{0};
+  NodeId receivedNodeId;
+
+  receiverTransport.registerReceiveHandler([&](uint8_t* data, std::size_t length) {
+    NotifyMessage notify{CommsVersion::V1};
+    notify.decode(EncodedMessage{data, length});
+    receivedNodeId = notify.nodeId();
+    receivedCount++;
+  });
+  senderTransport.registerReceiveHandler([](uint8_t*, std::size_t) {});
+
+  senderTransport.insert(receiver, localhost, 54402);
+
+  REQUIRE(senderTransport.send(receiver, NotifyMessage{CommsVersion::V1, sender}));
+  REQUIRE(waitFor([&] { return receivedCount == 1; }));
+  CHECK(receivedNodeId == sender);
+  CHECK(waitFor([&] { return senderTransport.unacknowledgedCount() == 0; }));
+  CHECK_FALSE(senderTransport.send(NodeId{}, NotifyMessage{CommsVersion::V1, sender}));
+}
+
+TEST_CASE("UdpConnectionManager delivers a repeated datagram once")
+{
+  NodeId receiver{ "00000000-00000000-00000000-00000000-00000002" };
+  UdpConnectionManager receiverTransport{receiver, localhost, 54403, nullptr};
+
+  std::atomic<int> receivedCount{0};
+  receiverTransport.registerReceiveHandler([&](uint8_t*, std::size_t) { receivedCount++; });
+
+  io::udp::Socket rawSocket{localhost, 54404};
+  REQUIRE(rawSocket.open());
+
+  auto encoded = NotifyMessage{CommsVersion::V1, receiver}.encode();
+  auto datagram = makeDatagram(54403, 3, 7, encoded);
+
+  io::udp::Datagram batch[2] = { datagram, datagram };
+  REQUIRE(rawSocket.sendBatch(batch, 2) == 2);
+
+  std::vector<io::udp::Datagram> acks(4);
+  std::size_t ackCount = 0;
+  REQUIRE(waitFor([&] {
+    ackCount += rawSocket.receiveBatch(acks);
+    return ackCount == 2;
+  }));
+
+  CHECK(receivedCount == 1);
+}
+
+TEST_CASE("UdpConnectionManager delivers the first datagrams of a peer that has restarted")
+{
+  NodeId sender{ "00000000-00000000-00000000-00000000-00000001" };
+  NodeId receiver{ "00000000-00000000-00000000-00000000-00000002" };
+
+  UdpConnectionManager receiverTransport{receiver, localhost, 54406, nullptr};
+
+  std::atomic<int> receivedCount{0};
+  receiverTransport.registerReceiveHandler([&](uint8_t*, std::size_t) { receivedCount++; });
+
+  // Each instance of the sender starts its sequence numbers from the same place
+  for (int instance = 1; instance <= 3; instance++)
+  {
+    UdpConnectionManager senderTransport{sender, localhost, 54405, nullptr};
+    senderTransport.registerReceiveHandler([](uint8_t*, std::size_t) {});
+    senderTransport.insert(receiver, localhost, 54406);
+
+    REQUIRE(senderTransport.send(receiver, NotifyMessage{CommsVersion::V1, sender}));
+    REQUIRE(waitFor([&] { return receivedCount == instance; }));
+    CHECK(waitFor([&] { return senderTransport.unacknowledgedCount() == 0; }));
+  }
+
+  // The same sequence number is only a duplicate within an epoch
+  io::udp::Socket rawSocket{localhost, 54407};
+  REQUIRE(rawSocket.open());
+
+  auto encoded = NotifyMessage{CommsVersion::V1, sender}.encode();
+  io::udp::Datagram first[2] = { makeDatagram(54406, 1, 1, encoded), makeDatagram(54406, 1, 1, encoded) };
+  REQUIRE(rawSocket.sendBatch(first, 2) == 2);
+  REQUIRE(waitFor([&] { return receivedCount == 4; }));
+
+  io::udp::Datagram restarted[1] = { makeDatagram(54406, 2, 1, encoded) };
+  REQUIRE(rawSocket.sendBatch(restarted, 1) == 1);
+  REQUIRE(waitFor([&] { return receivedCount == 5; }));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CHECK(receivedCount == 5);
+}
+
+TEST_CASE("ConnectionManager records what it sends and receives to a trace set at any time")
+{
+  NodeId sender{ "00000000-00000000-00000000-00000000-00000001" };
+  NodeId receiver{ "00000000-00000000-00000000-00000000-00000002" };
+
+  auto path = (std::filesystem::temp_directory_path() / ("odd-transport-" + std::to_string(getpid()) + ".trace")).string();
+
+  {
+    auto trace = std::shared_ptr<io::trace::TraceWriter>(io::trace::TraceWriter::create(path, 4096));
+    REQUIRE(trace);
+
+    ConnectionManager senderTransport{sender, localhost, 54451};
+    ConnectionManager receiverTransport{receiver, localhost, 54452};
+
+    std::atomic<int> receivedCount{0};
+
+    // The receive handler is registered before the trace is set
+    receiverTransport.registerReceiveHandler([&](uint8_t*, std::size_t) { receivedCount++; });
+    senderTransport.registerReceiveHandler([](uint8_t*, std::size_t) {});
+
+    senderTransport.setTrace(trace);
+    receiverTransport.setTrace(trace);
+
+    senderTransport.insert(receiver, localhost, 54452);
+
+    REQUIRE(senderTransport.send(receiver, NotifyMessage{CommsVersion::V1, sender}));
+    REQUIRE(waitFor([&] { return receivedCount == 1; }));
+    CHECK(trace->records() == 2);
+
+    senderTransport.stop();
+    receiverTransport.stop();
+  }
+
+  auto reader = io::trace::TraceReader::open(path);
+  REQUIRE(reader);
+
+  std::vector<io::trace::Direction> directions;
+  io::trace::TraceRecord record{};
+
+  while (reader->next(record))
+  {
+    directions.push_back(record.m_direction);
+    CHECK(record.m_destinationIpAddress == localhost);
+
+    NotifyMessage notify{CommsVersion::V1};
+    notify.decode(EncodedMessage{record.m_frame, record.m_length});
+    CHECK(notify.nodeId() == sender);
+  }
+
+  CHECK(directions == std::vector<io::trace::Direction>{ io::trace::Direction::SENT, io::trace::Direction::RECEIVED });
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("ShmConnectionManager delivers messages to a peer on the same host through shared memory")
+{
+  NodeId sender{ "00000000-00000000-00000000-00000000-00000001" };
+  NodeId receiver{ "00000000-00000000-00000000-00000000-00000002" };
+
+  ShmConnectionManager senderTransport{sender, localhost, 54501, nullptr};
+  ShmConnectionManager receiverTransport{receiver, localhost, 54502, nullptr};
+
+  std::atomic<int> receivedCount{0};
+  std::atomic<bool> inOrder{true};
+
+  receiverTransport.registerReceiveHandler([&](uint8_t* data, std::size_t length) {
+    NotifyMessage notify{CommsVersion::V1};
+    notify.decode(EncodedMessage{data, length});
+    inOrder = inOrder && notify.nodeId() == sender;
+    receivedCount++;
+  });
+
+  senderTransport.insert(receiver, localhost, 54502);
+  senderTransport.insert(NodeId{ "00000000-00000000-00000000-00000000-00000003" }, localhost, 54503);
+
+  for (int i = 0; i < 1000; i++)
+  {
+    REQUIRE(senderTransport.send(receiver, NotifyMessage{CommsVersion::V1, sender}));
+  }
+
+  CHECK(senderTransport.isSharedMemoryPeer(receiver));
+  REQUIRE(waitFor([&] { return receivedCount == 1000; }));
+  CHECK(inOrder);
+
+  // Nothing listens on 54503 and there is no stream transport to fall back to
+  CHECK_FALSE(senderTransport.send(NodeId{ "00000000-00000000-00000000-00000000-00000003" }, NotifyMessage{CommsVersion::V1, sender}));
+}
+
+TEST_CASE("ShmConnectionManager connects two peers that send to each other first at the same time")
+{
+  NodeId first{ "00000000-00000000-00000000-00000000-00000001" };
+  NodeId second{ "00000000-00000000-00000000-00000000-00000002" };
+
+  ShmConnectionManager firstTransport{first, localhost, 54504, nullptr};
+  ShmConnectionManager secondTransport{second, localhost, 54505, nullptr};
+
+  std::atomic<int> firstReceived{0};
+  std::atomic<int> secondReceived{0};
+
+  firstTransport.registerReceiveHandler([&](uint8_t*, std::size_t) { firstReceived++; });
+  secondTransport.registerReceiveHandler([&](uint8_t*, std::size_t) { secondReceived++; });
+
+  firstTransport.insert(second, localhost, 54505);
+  secondTransport.insert(first, localhost, 54504);
+
+  // Each handshake needs the other side's io thread while that side is in its own handshake
+  std::atomic<bool> go{false};
+  std::atomic<bool> firstSent{false};
+
+  std::thread firstSender{[&] {
+    while (not go) {}
+    firstSent = firstTransport.send(second, NotifyMessage{CommsVersion::V1, first});
+  }};
+
+  go = true;
+  bool secondSent = secondTransport.send(first, NotifyMessage{CommsVersion::V1, second});
+  firstSender.join();
+
+  CHECK(firstSent);
+  CHECK(secondSent);
+  CHECK(firstTransport.isSharedMemoryPeer(second));
+  CHECK(secondTransport.isSharedMemoryPeer(first));
+  CHECK(waitFor([&] { return firstReceived == 1 && secondReceived == 1; }));
+}
+
+TEST_CASE("ShmConnectionManager finds a peer on the same host from the address a ChordNode gives it")
+{
+  logging::WorkThreadQueue discardedLogs;
+  std::vector<ShmConnectionManager*> transports;
+
+  // No stream transport, the nodes can only reach each other through shared memory
+  ConnectionManagerFactory factory = [&transports] (const NodeId& nodeId, uint32_t ipAddress, uint16_t port)
+  {
+    auto transport = std::make_unique<ShmConnectionManager>(nodeId, ipAddress, port, nullptr);
+    transports.push_back(transport.get());
+    return transport;
+  };
+
+  ChordNode first{"first", "127.0.0.1", 54506, factory, std::make_unique<logging::Logger>(discardedLogs, "CHORDNODE")};
+  first.create();
+
+  ChordNode second{"second", "127.0.0.2", 54506, factory, std::make_unique<logging::Logger>(discardedLogs, "CHORDNODE")};
+  second.join("127.0.0.1");
+
+  CHECK(waitFor([&] { return second.getSuccessorId() == first.getId() && first.getPredecessorId() == second.getId(); }));
+  CHECK(transports[1]->isSharedMemoryPeer(first.getId()));
+}
+
+TEST_CASE("LoopbackConnectionManager hands every message to the node at the destination address")
+{
+  constexpr std::size_t nodeCount = 200;
+  constexpr int roundCount = 50;
+
+  LoopbackHub hub{2};
+  std::vector<std::unique_ptr<LoopbackConnectionManager>> managers;
+  std::vector<NodeId> nodeIds;
+  std::atomic<int> receivedCount{0};
+  std::atomic<int> byteHandlerCount{0};
+
+  for (std::size_t i = 0; i < nodeCount; i++)
+  {
+    auto ip = localhost + static_cast<uint32_t>(i);
+    nodeIds.emplace_back(ip);
+    managers.push_back(std::make_unique<LoopbackConnectionManager>(nodeIds.back(), ip, 54600, hub));
+
+    managers.back()->registerReceiveHandler([&](uint8_t*, std::size_t) { byteHandlerCount++; });
+    managers.back()->registerEncodedMessageHandler([&, expected = nodeIds.back()](EncodedMessage&& encoded) {
+      NotifyMessage notify{CommsVersion::V1};
+      notify.decode(std::move(encoded));
+
+      if (notify.nodeId() == expected) receivedCount++;
+    });
+  }
+
+  for (std::size_t i = 0; i < nodeCount; i++)
+  {
+    auto next = (i + 1) % nodeCount;
+    managers[i]->insert(nodeIds[next], localhost + static_cast<uint32_t>(next), 0);
+  }
+
+  std::vector<std::thread> senders;
+
+  for (std::size_t i = 0; i < nodeCount; i += nodeCount / 4)
+  {
+    senders.emplace_back([&, first = i] {
+      for (int round = 0; round < roundCount; round++)
+      {
+        for (std::size_t j = first; j < first + nodeCount / 4; j++)
+        {
+          auto next = (j + 1) % nodeCount;
+          managers[j]->send(nodeIds[next], NotifyMessage{CommsVersion::V1, nodeIds[next]});
+        }
+      }
+    });
+  }
+
+  for (auto& sender : senders)
+  {
+    sender.join();
+  }
+
+  REQUIRE(waitFor([&] { return receivedCount == static_cast<int>(nodeCount) * roundCount; }));
+  CHECK(byteHandlerCount == 0);
+
+  managers[1]->stop();
+  CHECK_FALSE(managers[0]->send(nodeIds[1], NotifyMessage{CommsVersion::V1, nodeIds[1]}));
+}
+
+} // namespace odd::chord::test
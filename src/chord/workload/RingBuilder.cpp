@@ -0,0 +1,61 @@
+#include "RingBuilder.h"
+
+#include <algorithm>
+
+namespace odd::chord::workload {
+
+void buildRing(const std::vector<ChordNode*>& nodes, std::size_t successorListLength)
+{
+  std::vector<std::pair<NodeAddress, ChordNode*>> ring;
+  ring.reserve(nodes.size());
+
+  for (auto* node : nodes)
+  {
+    ring.emplace_back(NodeAddress{ node->getId(), node->getIpAddress() }, node);
+  }
+
+  std::sort(ring.begin(), ring.end(), [] (const auto& left, const auto& right)
+  {
+    return left.first.m_nodeId < right.first.m_nodeId;
+  });
+
+  auto count = ring.size();
+
+  // The first node at or after the ID, going round past the top of the ring
+  auto successorOf = [&ring] (const NodeId& id) -> const NodeAddress&
+  {
+    auto it = std::lower_bound(ring.begin(), ring.end(), id, [] (const auto& entry, const NodeId& value)
+    {
+      return entry.first.m_nodeId < value;
+    });
+
+    return it == ring.end() ? ring.front().first : it->first;
+  };
+
+  RingState state;
+
+  for (std::size_t i = 0; i < count; i++)
+  {
+    auto& [address, node] = ring[i];
+
+    state.m_predecessor.reset();
+    state.m_successors.clear();
+    state.m_fingers.clear();
+
+    if (count > 1) state.m_predecessor = ring[(i + count - 1) % count].first;
+
+    for (std::size_t j = 1; j < count && state.m_successors.size() < successorListLength; j++)
+    {
+      state.m_successors.push_back(ring[(i + j) % count].first);
+    }
+
+    for (const auto& finger : node->getFingerTable().m_fingers)
+    {
+      state.m_fingers.push_back(successorOf(finger.m_end));
+    }
+
+    node->adoptRingState(state);
+  }
+}
+
+} // namespace odd::chord::workload
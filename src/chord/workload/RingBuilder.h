@@ -0,0 +1,24 @@
+#ifndef CHORD_WORKLOAD_RING_BUILDER_H_
+#define CHORD_WORKLOAD_RING_BUILDER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "../ChordNode.h"
+
+namespace odd::chord::workload {
+
+/*
+ * Puts the nodes straight into the ring they form together, each with the predecessor, successor
+ * list, fingers and peer addresses it would have once the ring had converged, so tests and
+ * benchmarks of large rings do not have to wait for every node to join and fix its fingers.
+ *
+ * The IDs are sorted once and every node's state is found by binary search, O(n log n) for the
+ * ring. The nodes should not have joined a ring already, and their maintenance carries on from the
+ * converged state.
+ */
+void buildRing(const std::vector<ChordNode*>& nodes, std::size_t successorListLength = ChordConfig{}.m_successorListLength);
+
+} // namespace odd::chord::workload
+
+#endif // CHORD_WORKLOAD_RING_BUILDER_H_
@@ -0,0 +1,178 @@
+#include <simulation/LinkModel.h>
+#include <simulation/Network.h>
+#include <simulation/Scheduler.h>
+#include <simulation/TraceReplay.h>
+#include <trace/TraceReader.h>
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../logger/Logger.h"
+#include "../ChordNode.h"
+#include "../SimulationConnectionManager.h"
+#include "../SimulationExecutor.h"
+
+/*
+ * Builds a simulated ring out of the addresses in a trace and feeds the trace into it. The ring is
+ * built and left to settle before the replay starts, then the frames are replayed at the speed
+ * given, either as fast as the events can be processed or paced against the wall clock.
+ */
+
+namespace {
+
+using namespace odd;
+using io::simulation::SimTime;
+
+void printUsage()
+{
+  std::cerr << "usage: ChordTraceReplay trace [--speed factor] [--received] [--no-sent] [--realtime]\n"
+               "                        [--settle seconds] [--latency ms] [--jitter ms]\n";
+}
+
+std::string toString(uint32_t ipAddress)
+{
+  char text[INET_ADDRSTRLEN] = {};
+  inet_ntop(AF_INET, &ipAddress, text, sizeof(text));
+
+  return text;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  using namespace std::chrono_literals;
+
+  if (argc < 2)
+  {
+    printUsage();
+    return 1;
+  }
+
+  io::simulation::ReplayConfig replayConfig;
+  io::simulation::LinkProfile link{ 20ms, 10ms, 0.0 };
+  SimTime settle = 5min;
+  bool realTime = false;
+
+  for (int i = 2; i < argc; i++)
+  {
+    std::string option = argv[i];
+
+    if (option == "--received") replayConfig.m_replayReceived = true;
+    else if (option == "--no-sent") replayConfig.m_replaySent = false;
+    else if (option == "--realtime") realTime = true;
+    else if (i + 1 < argc && option == "--speed") replayConfig.m_speed = std::strtod(argv[++i], nullptr);
+    else if (i + 1 < argc && option == "--settle")
+    {
+      settle = std::chrono::duration_cast<SimTime>(std::chrono::duration<double>(std::strtod(argv[++i], nullptr)));
+    }
+    else if (i + 1 < argc && option == "--latency")
+    {
+      link.m_latency = std::chrono::duration_cast<SimTime>(std::chrono::duration<double, std::milli>(std::strtod(argv[++i], nullptr)));
+    }
+    else if (i + 1 < argc && option == "--jitter")
+    {
+      link.m_jitter = std::chrono::duration_cast<SimTime>(std::chrono::duration<double, std::milli>(std::strtod(argv[++i], nullptr)));
+    }
+    else
+    {
+      printUsage();
+      return 1;
+    }
+  }
+
+  auto reader = io::trace::TraceReader::open(argv[1]);
+
+  if (not reader) return 1;
+
+  // Every address the trace mentions is a node of the ring, a source of zero is an unknown sender
+  std::set<uint32_t> addresses;
+  io::trace::TraceRecord record{};
+
+  while (reader->next(record))
+  {
+    if (record.m_sourceIpAddress != 0) addresses.insert(record.m_sourceIpAddress);
+    if (record.m_destinationIpAddress != 0) addresses.insert(record.m_destinationIpAddress);
+  }
+
+  reader->rewind();
+
+  io::simulation::Scheduler scheduler;
+  io::simulation::Network network{ scheduler, io::simulation::LinkModel{ 1, link } };
+  auto clock = std::make_shared<chord::SimulationClock>(scheduler);
+
+  // The nodes' logs are not printed, the queue is never emptied so log statements are dropped
+  logging::WorkThreadQueue discardedLogs;
+  std::vector<std::unique_ptr<chord::ChordNode>> nodes;
+
+  chord::ConnectionManagerFactory factory = [&network] (const chord::NodeId&, uint32_t ip, uint16_t)
+  {
+    return std::make_unique<chord::SimulationConnectionManager>(network.addNode(ip));
+  };
+
+  // The joins are spread over the first half of the settling time
+  auto joinSpacing = settle / (2 * std::max<std::size_t>(addresses.size(), 1));
+  std::string firstIpAddress = addresses.empty() ? "" : toString(*addresses.begin());
+
+  std::size_t joins = 0;
+
+  for (auto address : addresses)
+  {
+    scheduler.schedule(joinSpacing * joins, [&, address, index = joins]
+    {
+      auto& node = *nodes.emplace_back(std::make_unique<chord::ChordNode>("node" + std::to_string(index),
+                                                                          toString(address),
+                                                                          0,
+                                                                          factory,
+                                                                          std::make_unique<logging::Logger>(discardedLogs, "CHORDNODE"),
+                                                                          chord::ChordConfig{},
+                                                                          std::make_unique<chord::SimulationExecutor>(scheduler),
+                                                                          clock));
+
+      if (index == 0) node.create();
+      else node.join(firstIpAddress);
+    });
+
+    joins++;
+  }
+
+  scheduler.runUntil(settle);
+
+  io::simulation::TraceReplay replay{ network, scheduler, *reader, replayConfig };
+
+  auto replayStart = scheduler.now();
+  auto wallStart = std::chrono::steady_clock::now();
+
+  replay.start();
+
+  // The nodes' maintenance never stops, so the run ends with the last frame
+  while (not replay.finished())
+  {
+    scheduler.runFor(10ms);
+
+    if (realTime) std::this_thread::sleep_until(wallStart + (scheduler.now() - replayStart));
+  }
+
+  auto wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  auto simulatedTime = std::chrono::duration<double>(scheduler.now() - replayStart).count();
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "ring: " << nodes.size() << " nodes\n";
+  std::cout << "frames: " << replay.replayed() << " replayed, " << replay.skipped() << " skipped, "
+            << replay.bytes() << " bytes\n";
+  std::cout << "time: " << simulatedTime << " s simulated in " << wallTime << " s, "
+            << (wallTime > 0.0 ? static_cast<double>(replay.replayed()) / wallTime : 0.0) << " frames per second\n";
+
+  // The nodes use the scheduler, network and logs
+  nodes.clear();
+
+  return 0;
+}
@@ -0,0 +1,313 @@
+#include "Workload.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace odd::chord::workload {
+
+[[nodiscard]] double WorkloadReport::successRate() const
+{
+  return m_lookups == 0 ? 0.0 : static_cast<double>(m_lookupsCorrect) / static_cast<double>(m_lookups);
+}
+
+[[nodiscard]] SimTime WorkloadReport::latencyPercentile(double fraction) const
+{
+  if (m_latencies.empty()) return SimTime{ 0 };
+
+  auto index = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(m_latencies.size())));
+
+  return m_latencies[std::clamp<std::size_t>(index, 1, m_latencies.size()) - 1];
+}
+
+void WorkloadReport::print(std::ostream& output) const
+{
+  auto milliseconds = [] (SimTime time)
+  {
+    return std::chrono::duration<double, std::milli>(time).count();
+  };
+
+  output << std::fixed << std::setprecision(2);
+
+  output << "churn: " << m_joins << " joins, " << m_leaves << " leaves, " << m_failures << " failures\n";
+  output << "lookups: " << m_lookups << " issued, " << m_lookupsAnswered << " answered, "
+         << m_lookupsCorrect << " correct, success rate " << successRate() * 100.0 << "%\n";
+
+  output << "hops:";
+
+  for (std::size_t hops = 0; hops < m_hopCounts.size(); hops++)
+  {
+    if (m_hopCounts[hops] > 0) output << " " << hops << "=" << m_hopCounts[hops];
+  }
+
+  output << "\n";
+
+  output << "latency: p50 " << milliseconds(latencyPercentile(0.5)) << " ms, p90 "
+         << milliseconds(latencyPercentile(0.9)) << " ms, p99 " << milliseconds(latencyPercentile(0.99)) << " ms\n";
+  output << "maintenance: " << m_maintenanceBytesPerNodePerSecond << " bytes per node per second\n";
+  output << "queues: " << m_queueDrops << " dropped, mean wait " << milliseconds(m_meanQueueingDelay) << " ms\n";
+
+  if (m_timeToConverge)
+  {
+    output << "converged: " << std::chrono::duration<double>(*m_timeToConverge).count() << " s after the churn\n";
+  }
+  else
+  {
+    output << "converged: no\n";
+  }
+}
+
+Workload::Workload(WorkloadConfig config)
+  : m_config(std::move(config)),
+    m_network(m_scheduler, io::simulation::LinkModel{ m_config.m_seed, m_config.m_link }),
+    m_clock(std::make_shared<SimulationClock>(m_scheduler)),
+    m_random(m_config.m_seed)
+{
+  std::vector<double> weights;
+
+  for (std::size_t rank = 1; rank <= m_config.m_keys; rank++)
+  {
+    m_keys.emplace_back(static_cast<uint32_t>(rank));
+    weights.push_back(1.0 / std::pow(static_cast<double>(rank), m_config.m_zipfExponent));
+  }
+
+  m_keyRanks = std::discrete_distribution<std::size_t>(weights.begin(), weights.end());
+
+  m_network.bandwidth().setDefault(m_config.m_capacity);
+
+  if (not m_config.m_tracePath.empty())
+  {
+    m_network.setTrace(io::trace::TraceWriter::create(m_config.m_tracePath));
+  }
+}
+
+Workload::~Workload()
+{
+  // The nodes use the scheduler, network and logs
+  m_members.clear();
+}
+
+WorkloadReport Workload::run()
+{
+  using namespace std::chrono_literals;
+
+  m_report = WorkloadReport{};
+
+  auto joinSpacing = m_config.m_warmUp / (2 * std::max<std::size_t>(m_config.m_initialNodes, 1));
+
+  if (m_config.m_buildRing)
+  {
+    std::vector<ChordNode*> nodes;
+
+    for (std::size_t i = 0; i < m_config.m_initialNodes; i++)
+    {
+      addNode(false);
+      nodes.push_back(m_members.back().m_node.get());
+    }
+
+    buildRing(nodes, m_config.m_chord.m_successorListLength);
+  }
+  else
+  {
+    for (std::size_t i = 0; i < m_config.m_initialNodes; i++)
+    {
+      m_scheduler.schedule(joinSpacing * i, [this] { addNode(); });
+    }
+  }
+
+  m_scheduler.runUntil(m_config.m_warmUp);
+
+  auto churnStart = m_scheduler.now();
+  m_churnEnd = churnStart + m_config.m_churnDuration;
+  auto bytesAtStart = m_traffic.bytes();
+
+  schedulePoisson(m_config.m_joinRate, [this] { addNode(); m_report.m_joins++; });
+  schedulePoisson(m_config.m_leaveRate, [this] { leaveNode(true); });
+  schedulePoisson(m_config.m_failRate, [this] { leaveNode(false); });
+  schedulePoisson(m_config.m_lookupRate, [this] { issueLookup(); });
+
+  // The number of nodes changes during the churn, so the traffic is shared out by node seconds
+  double nodeSeconds = 0.0;
+  auto checkSeconds = std::chrono::duration<double>(m_config.m_checkInterval).count();
+
+  while (m_scheduler.now() < m_churnEnd)
+  {
+    auto until = std::min(m_scheduler.now() + m_config.m_checkInterval, m_churnEnd);
+    auto liveNodes = static_cast<double>(m_liveIds.size());
+
+    m_scheduler.runUntil(until);
+
+    nodeSeconds += liveNodes * checkSeconds;
+  }
+
+  auto churnBytes = static_cast<double>(m_traffic.bytes() - bytesAtStart);
+
+  if (nodeSeconds > 0.0)
+  {
+    m_report.m_maintenanceBytesPerNodePerSecond = std::max(churnBytes - static_cast<double>(m_lookupBytes), 0.0) / nodeSeconds;
+  }
+
+  for (;;)
+  {
+    if (ringIsCorrect())
+    {
+      m_report.m_timeToConverge = m_scheduler.now() - m_churnEnd;
+      break;
+    }
+
+    if (m_scheduler.now() - m_churnEnd >= m_config.m_convergenceTimeout) break;
+
+    m_scheduler.runFor(m_config.m_checkInterval);
+  }
+
+  std::sort(m_report.m_latencies.begin(), m_report.m_latencies.end());
+
+  m_report.m_queueDrops = m_network.bandwidth().dropped();
+  m_report.m_meanQueueingDelay = m_network.bandwidth().meanQueueingDelay();
+
+  return m_report;
+}
+
+void Workload::addNode(bool joinRing)
+{
+  auto address = m_nextAddress++;
+  auto ipAddress = "10." + std::to_string((address >> 16) & 0xff) + "." +
+                   std::to_string((address >> 8) & 0xff) + "." + std::to_string(address & 0xff);
+
+  ConnectionManagerFactory factory = [this] (const NodeId&, uint32_t ip, uint16_t)
+  {
+    return std::make_unique<SimulationConnectionManager>(m_network.addNode(ip), &m_traffic);
+  };
+
+  auto node = std::make_unique<ChordNode>("node" + std::to_string(address),
+                                          ipAddress,
+                                          0,
+                                          factory,
+                                          std::make_unique<logging::Logger>(m_discardedLogs, "CHORDNODE"),
+                                          m_config.m_chord,
+                                          std::make_unique<SimulationExecutor>(m_scheduler),
+                                          m_clock);
+
+  if (joinRing && m_members.empty())
+  {
+    node->create();
+  }
+  else if (joinRing)
+  {
+    node->join(m_members[pickMember()].m_ipAddress);
+  }
+
+  m_liveIds.insert(node->getId());
+  m_members.push_back(Member{ std::move(node), ipAddress });
+}
+
+void Workload::leaveNode(bool graceful)
+{
+  if (m_members.size() <= m_config.m_minimumNodes) return;
+
+  auto index = pickMember();
+  auto member = std::move(m_members[index]);
+
+  m_members[index] = std::move(m_members.back());
+  m_members.pop_back();
+
+  m_liveIds.erase(member.m_node->getId());
+
+  if (graceful)
+  {
+    member.m_node->leave();
+    m_report.m_leaves++;
+  }
+  else
+  {
+    m_report.m_failures++;
+  }
+
+  // A failed node just stops, the messages still on their way to it are dropped
+}
+
+void Workload::issueLookup()
+{
+  if (m_members.empty()) return;
+
+  auto index = m_lookups.size();
+  const auto& key = m_keys[m_keyRanks(m_random)];
+
+  m_lookups.push_back(Lookup{ key, m_scheduler.now() });
+  m_report.m_lookups++;
+
+  m_members[pickMember()].m_node->lookup(key, [this, index] (std::optional<NodeId> result, uint32_t hops)
+  {
+    lookupFinished(index, result, hops);
+  });
+}
+
+void Workload::lookupFinished(std::size_t lookup, std::optional<NodeId> result, uint32_t hops)
+{
+  if (not result) return;
+
+  static const auto requestBytes = FindSuccessorMessage{ CommsVersion::V1, NodeId{}, NodeId{}, 0 }.encode().m_length;
+  static const auto responseBytes = FindSuccessorResponseMessage{ CommsVersion::V1 }.encode().m_length;
+
+  // Each hop is a request forwarded on and a response passed back
+  if (m_scheduler.now() <= m_churnEnd) m_lookupBytes += hops * (requestBytes + responseBytes);
+
+  m_report.m_lookupsAnswered++;
+
+  if (*result == owner(m_lookups[lookup].m_key)) m_report.m_lookupsCorrect++;
+
+  if (m_report.m_hopCounts.size() <= hops) m_report.m_hopCounts.resize(hops + 1, 0);
+
+  m_report.m_hopCounts[hops]++;
+  m_report.m_latencies.push_back(m_scheduler.now() - m_lookups[lookup].m_issued);
+}
+
+[[nodiscard]] NodeId Workload::owner(const NodeId& key) const
+{
+  auto it = m_liveIds.lower_bound(key);
+
+  return it == m_liveIds.end() ? *m_liveIds.begin() : *it;
+}
+
+[[nodiscard]] bool Workload::ringIsCorrect() const
+{
+  if (m_liveIds.size() < 2) return true;
+
+  for (const auto& member : m_members)
+  {
+    const auto& id = member.m_node->getId();
+
+    auto next = std::next(m_liveIds.find(id));
+    auto successor = next == m_liveIds.end() ? *m_liveIds.begin() : *next;
+
+    auto previous = m_liveIds.find(id);
+    auto predecessor = previous == m_liveIds.begin() ? *m_liveIds.rbegin() : *std::prev(previous);
+
+    if (member.m_node->getSuccessorId() != successor || member.m_node->getPredecessorId() != predecessor) return false;
+  }
+
+  return true;
+}
+
+void Workload::schedulePoisson(double rate, std::function<void()> action)
+{
+  if (rate <= 0.0) return;
+
+  std::exponential_distribution<double> interval{ rate };
+  auto at = m_scheduler.now() + std::chrono::duration_cast<SimTime>(std::chrono::duration<double>(interval(m_random)));
+
+  if (at > m_churnEnd) return;
+
+  m_scheduler.schedule(at, [this, rate, action = std::move(action)]
+  {
+    action();
+    schedulePoisson(rate, action);
+  });
+}
+
+[[nodiscard]] std::size_t Workload::pickMember()
+{
+  return std::uniform_int_distribution<std::size_t>{ 0, m_members.size() - 1 }(m_random);
+}
+
+} // namespace odd::chord::workload
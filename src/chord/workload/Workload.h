@@ -0,0 +1,183 @@
+#ifndef CHORD_WORKLOAD_H_
+#define CHORD_WORKLOAD_H_
+
+#include <simulation/BandwidthModel.h>
+#include <simulation/LinkModel.h>
+#include <simulation/Network.h>
+#include <simulation/Scheduler.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../../logger/Logger.h"
+#include "../ChordNode.h"
+#include "../SimulationConnectionManager.h"
+#include "../SimulationExecutor.h"
+#include "RingBuilder.h"
+
+namespace odd::chord::workload {
+
+using io::simulation::SimTime;
+
+struct WorkloadConfig
+{
+  uint64_t m_seed = 1;
+
+  // The ring that is built before the churn starts, the joins are spread over the first half of the
+  // warm up and the second half lets the ring settle
+  std::size_t m_initialNodes = 64;
+  SimTime m_warmUp{ std::chrono::minutes{ 5 } };
+
+  // Puts the initial nodes straight into a converged ring instead, see buildRing, so the warm up
+  // only needs to be as long as the ring should run before the churn
+  bool m_buildRing = false;
+
+  // Poisson rates across the whole ring, in events per second of simulated time. Leaves and
+  // failures stop when the ring is down to the minimum size
+  double m_joinRate = 0.1;
+  double m_leaveRate = 0.05;
+  double m_failRate = 0.05;
+  double m_lookupRate = 10.0;
+  std::size_t m_minimumNodes = 8;
+
+  // Lookups are for one of this many keys, the key of rank r with probability proportional to
+  // 1 / r^exponent
+  std::size_t m_keys = 10000;
+  double m_zipfExponent = 1.0;
+
+  SimTime m_churnDuration{ std::chrono::minutes{ 10 } };
+
+  // Once the churn stops the ring is checked this often until it is correct or the timeout passes
+  SimTime m_checkInterval{ std::chrono::seconds{ 1 } };
+  SimTime m_convergenceTimeout{ std::chrono::minutes{ 10 } };
+
+  // Every message of the run is recorded to this trace file if it is set
+  std::string m_tracePath;
+
+  io::simulation::LinkProfile m_link{ std::chrono::milliseconds{ 20 }, std::chrono::milliseconds{ 10 }, 0.0 };
+
+  // Every node's access link, unlimited by default
+  io::simulation::NodeCapacity m_capacity;
+  ChordConfig m_chord;
+};
+
+struct WorkloadReport
+{
+  std::size_t m_joins = 0;
+  std::size_t m_leaves = 0;
+  std::size_t m_failures = 0;
+
+  // A lookup succeeds if it is answered with the node the key belonged to when it was answered
+  std::size_t m_lookups = 0;
+  std::size_t m_lookupsAnswered = 0;
+  std::size_t m_lookupsCorrect = 0;
+
+  // How many answered lookups took each number of hops
+  std::vector<std::size_t> m_hopCounts;
+
+  // Of the answered lookups, sorted
+  std::vector<SimTime> m_latencies;
+
+  // Everything the nodes sent during the churn except the lookups' own messages
+  double m_maintenanceBytesPerNodePerSecond = 0.0;
+
+  // Messages dropped by full uplink or downlink queues, and how long the queued ones waited
+  std::size_t m_queueDrops = 0;
+  SimTime m_meanQueueingDelay{ 0 };
+
+  // From the end of the churn until every node's successor and predecessor are right
+  std::optional<SimTime> m_timeToConverge;
+
+  [[nodiscard]] double successRate() const;
+
+  // The latency below which the given fraction of the answered lookups fall
+  [[nodiscard]] SimTime latencyPercentile(double fraction) const;
+
+  void print(std::ostream& output) const;
+};
+
+/*
+ * Drives a simulated ring through churn and lookups and measures how well it copes. Every node is a
+ * ChordNode on simulated time, so the whole run is deterministic for a seed and runs as fast as the
+ * events can be processed.
+ *
+ * The workload keeps the set of live nodes as the oracle the lookups and the ring are checked
+ * against: a node is live from when it is told to join until it leaves or fails.
+ */
+class Workload
+{
+  public:
+    explicit Workload(WorkloadConfig config);
+    ~Workload();
+
+    Workload(const Workload&) = delete;
+    Workload& operator=(const Workload&) = delete;
+
+    WorkloadReport run();
+
+  private:
+    struct Member
+    {
+      std::unique_ptr<ChordNode> m_node;
+      std::string m_ipAddress;
+    };
+
+    struct Lookup
+    {
+      NodeId m_key;
+      SimTime m_issued;
+    };
+
+    // A node that does not join is left for buildRing
+    void addNode(bool joinRing = true);
+    void leaveNode(bool graceful);
+    void issueLookup();
+
+    void lookupFinished(std::size_t lookup, std::optional<NodeId> result, uint32_t hops);
+
+    // The live node the key belongs to
+    [[nodiscard]] NodeId owner(const NodeId& key) const;
+    [[nodiscard]] bool ringIsCorrect() const;
+
+    // Runs the action at exponentially distributed intervals until the churn ends
+    void schedulePoisson(double rate, std::function<void()> action);
+
+    [[nodiscard]] std::size_t pickMember();
+
+    const WorkloadConfig m_config;
+
+    io::simulation::Scheduler m_scheduler;
+    io::simulation::Network m_network;
+    std::shared_ptr<SimulationClock> m_clock;
+    std::mt19937_64 m_random;
+
+    // The nodes' logs are not printed, the queue is never emptied so log statements are dropped
+    logging::WorkThreadQueue m_discardedLogs;
+
+    SimulationTraffic m_traffic;
+
+    std::vector<Member> m_members;
+    std::set<NodeId> m_liveIds;
+    uint32_t m_nextAddress = 1;
+
+    std::vector<NodeId> m_keys;
+    std::discrete_distribution<std::size_t> m_keyRanks;
+
+    std::vector<Lookup> m_lookups;
+    SimTime m_churnEnd{ 0 };
+
+    // Traffic that was part of the lookups, which is taken off the maintenance traffic
+    uint64_t m_lookupBytes = 0;
+
+    WorkloadReport m_report;
+};
+
+} // namespace odd::chord::workload
+
+#endif // CHORD_WORKLOAD_H_
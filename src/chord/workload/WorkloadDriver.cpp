@@ -0,0 +1,81 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "Workload.h"
+
+namespace {
+
+void printUsage()
+{
+  std::cerr << "usage: ChordWorkloadDriver [--seed n] [--nodes n] [--warm-up seconds] [--churn seconds]\n"
+               "                           [--join-rate r] [--leave-rate r] [--fail-rate r] [--lookup-rate r]\n"
+               "                           [--keys n] [--zipf exponent] [--latency ms] [--jitter ms] [--loss p]\n"
+               "                           [--uplink bytes/s] [--downlink bytes/s] [--queue-limit bytes]\n"
+               "                           [--build-ring 0|1] [--trace path]\n";
+}
+
+std::chrono::nanoseconds seconds(double value)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(value));
+}
+
+std::chrono::nanoseconds milliseconds(double value)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double, std::milli>(value));
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  odd::chord::workload::WorkloadConfig config;
+
+  for (int i = 1; i < argc; i += 2)
+  {
+    std::string option = argv[i];
+
+    if (i + 1 >= argc)
+    {
+      printUsage();
+      return 1;
+    }
+
+    if (option == "--trace")
+    {
+      config.m_tracePath = argv[i + 1];
+      continue;
+    }
+
+    auto value = std::strtod(argv[i + 1], nullptr);
+
+    if (option == "--seed") config.m_seed = static_cast<uint64_t>(value);
+    else if (option == "--nodes") config.m_initialNodes = static_cast<std::size_t>(value);
+    else if (option == "--build-ring") config.m_buildRing = value != 0.0;
+    else if (option == "--warm-up") config.m_warmUp = seconds(value);
+    else if (option == "--churn") config.m_churnDuration = seconds(value);
+    else if (option == "--join-rate") config.m_joinRate = value;
+    else if (option == "--leave-rate") config.m_leaveRate = value;
+    else if (option == "--fail-rate") config.m_failRate = value;
+    else if (option == "--lookup-rate") config.m_lookupRate = value;
+    else if (option == "--keys") config.m_keys = static_cast<std::size_t>(value);
+    else if (option == "--zipf") config.m_zipfExponent = value;
+    else if (option == "--latency") config.m_link.m_latency = milliseconds(value);
+    else if (option == "--jitter") config.m_link.m_jitter = milliseconds(value);
+    else if (option == "--loss") config.m_link.m_lossProbability = value;
+    else if (option == "--uplink") config.m_capacity.m_uplink = value;
+    else if (option == "--downlink") config.m_capacity.m_downlink = value;
+    else if (option == "--queue-limit") config.m_capacity.m_queueLimit = static_cast<std::size_t>(value);
+    else
+    {
+      printUsage();
+      return 1;
+    }
+  }
+
+  odd::chord::workload::Workload workload{ config };
+
+  workload.run().print(std::cout);
+
+  return 0;
+}
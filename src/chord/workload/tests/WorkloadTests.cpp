@@ -0,0 +1,160 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+#include "../RingBuilder.h"
+#include "../Workload.h"
+
+namespace odd::chord::workload {
+
+TEST_CASE("A churn workload reports the ring's health and is the same for the same seed")
+{
+  using namespace std::chrono_literals;
+
+  WorkloadConfig config;
+  config.m_seed = 11;
+  config.m_initialNodes = 24;
+  config.m_warmUp = 2min;
+  config.m_churnDuration = 3min;
+  config.m_joinRate = 0.05;
+  config.m_leaveRate = 0.02;
+  config.m_failRate = 0.02;
+  config.m_lookupRate = 5.0;
+  config.m_keys = 1000;
+
+  auto report = Workload{ config }.run();
+
+  CHECK(report.m_joins > 0);
+  CHECK(report.m_leaves + report.m_failures > 0);
+
+  // About five lookups a second for three minutes
+  CHECK(report.m_lookups > 700);
+  CHECK(report.m_lookups < 1100);
+  CHECK(report.successRate() > 0.9);
+
+  CHECK(std::accumulate(report.m_hopCounts.begin(), report.m_hopCounts.end(), std::size_t{ 0 }) == report.m_lookupsAnswered);
+  CHECK(report.m_latencies.size() == report.m_lookupsAnswered);
+  CHECK(report.latencyPercentile(0.5) <= report.latencyPercentile(0.99));
+
+  CHECK(report.m_maintenanceBytesPerNodePerSecond > 0.0);
+  CHECK(report.m_timeToConverge);
+
+  auto again = Workload{ config }.run();
+
+  CHECK(again.m_lookupsCorrect == report.m_lookupsCorrect);
+  CHECK(again.m_hopCounts == report.m_hopCounts);
+  CHECK(again.m_latencies == report.m_latencies);
+  CHECK(again.m_timeToConverge == report.m_timeToConverge);
+}
+
+TEST_CASE("A ring that nodes join in quick succession converges without any churn")
+{
+  using namespace std::chrono_literals;
+
+  // A join every 0.3 s, much faster than the maintenance rounds settle each join, so the ring is
+  // wired up wrongly in places and has to be put right by stabilise alone
+  WorkloadConfig config;
+  config.m_initialNodes = 100;
+  config.m_warmUp = 1min;
+  config.m_churnDuration = 10s;
+  config.m_joinRate = 0.0;
+  config.m_leaveRate = 0.0;
+  config.m_failRate = 0.0;
+  config.m_lookupRate = 5.0;
+  config.m_convergenceTimeout = 2min;
+
+  auto report = Workload{ config }.run();
+
+  CHECK(report.m_timeToConverge);
+  CHECK(report.successRate() > 0.95);
+}
+
+TEST_CASE("A built ring has converged straight away and stays converged")
+{
+  using namespace std::chrono_literals;
+
+  constexpr std::size_t nodeCount = 500;
+
+  io::simulation::Scheduler scheduler;
+  io::simulation::Network network{ scheduler, io::simulation::LinkModel{ 3, io::simulation::LinkProfile{ 20ms, 10ms, 0.0 } } };
+  auto clock = std::make_shared<SimulationClock>(scheduler);
+  logging::WorkThreadQueue discardedLogs;
+
+  ConnectionManagerFactory factory = [&network] (const NodeId&, uint32_t ip, uint16_t)
+  {
+    return std::make_unique<SimulationConnectionManager>(network.addNode(ip));
+  };
+
+  std::vector<std::unique_ptr<ChordNode>> nodes;
+  std::vector<ChordNode*> ring;
+  std::vector<NodeId> ids;
+
+  for (std::size_t i = 0; i < nodeCount; i++)
+  {
+    nodes.push_back(std::make_unique<ChordNode>("node" + std::to_string(i),
+                                                "10.0." + std::to_string(i / 250) + "." + std::to_string(i % 250 + 1),
+                                                0,
+                                                factory,
+                                                std::make_unique<logging::Logger>(discardedLogs, "CHORDNODE"),
+                                                ChordConfig{},
+                                                std::make_unique<SimulationExecutor>(scheduler),
+                                                clock));
+    ring.push_back(nodes.back().get());
+    ids.push_back(nodes.back()->getId());
+  }
+
+  std::sort(ids.begin(), ids.end());
+
+  auto successorOf = [&ids] (const NodeId& id)
+  {
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    return it == ids.end() ? ids.front() : *it;
+  };
+
+  auto checkRing = [&]
+  {
+    for (const auto& node : nodes)
+    {
+      auto position = std::lower_bound(ids.begin(), ids.end(), node->getId()) - ids.begin();
+
+      REQUIRE(node->getPredecessorId() == ids[(position + nodeCount - 1) % nodeCount]);
+
+      auto successors = node->successorList();
+      REQUIRE(successors.size() == ChordConfig{}.m_successorListLength);
+
+      for (std::size_t i = 0; i < successors.size(); i++)
+      {
+        REQUIRE(successors[i] == ids[(position + i + 1) % nodeCount]);
+      }
+
+      for (const auto& finger : node->getFingerTable().m_fingers)
+      {
+        REQUIRE(finger.m_nodeId == successorOf(finger.m_end));
+      }
+    }
+  };
+
+  buildRing(ring);
+  checkRing();
+
+  // The maintenance finds nothing to change, and lookups are answered right away
+  std::size_t correct = 0;
+
+  for (uint32_t key = 1; key <= 100; key++)
+  {
+    nodes[key % nodeCount]->lookup(NodeId{ key * 7919 }, [&correct, &successorOf, key] (std::optional<NodeId> result, uint32_t)
+    {
+      if (result && *result == successorOf(NodeId{ key * 7919 })) correct++;
+    });
+  }
+
+  scheduler.runFor(30s);
+
+  CHECK(correct == 100);
+  checkRing();
+
+  nodes.clear();
+}
+
+} // namespace odd::chord::workload
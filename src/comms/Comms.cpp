@@ -34,6 +34,9 @@ EncodedMessage::EncodedMessage(EncodedMessage&& rhs) noexcept
 
 EncodedMessage& EncodedMessage::operator=(EncodedMessage&& rhs) noexcept
 {
+  if (this == &rhs) return *this;
+
+  delete[] m_message;
   m_message = rhs.m_message;
   m_length = rhs.m_length;
   rhs.m_message = nullptr;
@@ -57,6 +57,11 @@ enum class MessageType : uint32_t
   CHORD_CHECK_PREDECESSOR        = 0x00000206,
   CHORD_GET_NEIGHBOURS           = 0x00000207,
   CHORD_GET_NEIGHBOURS_RESPONSE  = 0x00000208,
+  CHORD_CHECK_PREDECESSOR_RESPONSE = 0x00000209,
+  CHORD_BOOTSTRAP                = 0x0000020A,
+  CHORD_BOOTSTRAP_RESPONSE       = 0x0000020B,
+  CHORD_STABILISE_RESPONSE       = 0x0000020C,
+  CHORD_LEAVE                    = 0x0000020D,
 };
 
 class EncodedMessage
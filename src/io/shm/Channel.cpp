@@ -0,0 +1,156 @@
+#include "Channel.h"
+
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace odd::io::shm {
+
+std::unique_ptr<Channel> Channel::create(std::size_t capacity)
+{
+  auto mappingSize = Ring::requiredSize(capacity);
+  int memoryFd = memfd_create("odd-shm-ring", MFD_CLOEXEC);
+
+  if (memoryFd < 0)
+  {
+    std::cerr << "memfd_create failed: " << std::strerror(errno) << std::endl;
+    return nullptr;
+  }
+
+  if (ftruncate(memoryFd, static_cast<off_t>(mappingSize)) < 0)
+  {
+    std::cerr << "ftruncate failed: " << std::strerror(errno) << std::endl;
+    close(memoryFd);
+    return nullptr;
+  }
+
+  void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+
+  if (mapping == MAP_FAILED)
+  {
+    std::cerr << "mmap failed: " << std::strerror(errno) << std::endl;
+    close(memoryFd);
+    return nullptr;
+  }
+
+  return std::make_unique<Channel>(memoryFd, mapping, mappingSize, true, capacity);
+}
+
+std::unique_ptr<Channel> Channel::attach(int memoryFd)
+{
+  off_t mappingSize = lseek(memoryFd, 0, SEEK_END);
+
+  if (mappingSize <= 0)
+  {
+    close(memoryFd);
+    return nullptr;
+  }
+
+  void* mapping = mmap(nullptr, static_cast<std::size_t>(mappingSize), PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+
+  if (mapping == MAP_FAILED)
+  {
+    std::cerr << "mmap failed: " << std::strerror(errno) << std::endl;
+    close(memoryFd);
+    return nullptr;
+  }
+
+  return std::make_unique<Channel>(memoryFd, mapping, static_cast<std::size_t>(mappingSize), false, 0);
+}
+
+Channel::Channel(int memoryFd, void* mapping, std::size_t mappingSize, bool initialise, std::size_t capacity)
+  : m_memoryFd(memoryFd),
+    m_wakeupFd(-1),
+    m_mapping(mapping),
+    m_mappingSize(mappingSize),
+    m_ring(initialise ? Ring{mapping, capacity} : Ring{mapping})
+{
+}
+
+Channel::~Channel()
+{
+  munmap(m_mapping, m_mappingSize);
+  close(m_memoryFd);
+
+  if (m_wakeupFd >= 0)
+  {
+    close(m_wakeupFd);
+  }
+}
+
+void Channel::setWakeupFd(int eventFd)
+{
+  m_wakeupFd = eventFd;
+}
+
+bool Channel::send(const uint8_t* data, std::size_t length)
+{
+  if (not m_ring.tryPush(data, length)) return false;
+
+  if (m_ring.takeWakeupRequest() && m_wakeupFd >= 0)
+  {
+    uint64_t one = 1;
+    auto result = write(m_wakeupFd, &one, sizeof(one));
+    (void) result;
+  }
+
+  return true;
+}
+
+Ring& Channel::ring()
+{
+  return m_ring;
+}
+
+int Channel::memoryFd() const
+{
+  return m_memoryFd;
+}
+
+bool sendFileDescriptor(int socketFd, int fd)
+{
+  char byte = 0;
+  iovec iov{ &byte, sizeof(byte) };
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+
+  msghdr message{};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  cmsghdr* header = CMSG_FIRSTHDR(&message);
+  header->cmsg_level = SOL_SOCKET;
+  header->cmsg_type = SCM_RIGHTS;
+  header->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+
+  return sendmsg(socketFd, &message, MSG_NOSIGNAL) == sizeof(byte);
+}
+
+int receiveFileDescriptor(int socketFd)
+{
+  char byte;
+  iovec iov{ &byte, sizeof(byte) };
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+
+  msghdr message{};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  if (recvmsg(socketFd, &message, MSG_CMSG_CLOEXEC) != sizeof(byte)) return -1;
+
+  cmsghdr* header = CMSG_FIRSTHDR(&message);
+
+  if (header == nullptr || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) return -1;
+
+  int fd;
+  std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+  return fd;
+}
+
+} // namespace odd::io::shm
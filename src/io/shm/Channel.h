@@ -0,0 +1,58 @@
+#ifndef IO_SHM_CHANNEL_H_
+#define IO_SHM_CHANNEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "Ring.h"
+
+namespace odd::io::shm {
+
+/*
+ * One direction of a shared memory connection between two processes on the same host: a Ring in
+ * an anonymous memfd segment, and the eventfd that wakes the consumer. The producer creates the
+ * segment and passes the memfd to the consumer over a unix socket, the consumer passes back its
+ * eventfd the same way (see sendFileDescriptor and receiveFileDescriptor).
+ */
+class Channel
+{
+  public:
+    // Producer side, creates and maps a new segment
+    [[nodiscard]] static std::unique_ptr<Channel> create(std::size_t capacity);
+
+    // Consumer side, maps a segment received from the producer and takes ownership of the memfd
+    [[nodiscard]] static std::unique_ptr<Channel> attach(int memoryFd);
+
+    Channel(int memoryFd, void* mapping, std::size_t mappingSize, bool initialise, std::size_t capacity);
+    ~Channel();
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    // Takes ownership of the consumer's eventfd
+    void setWakeupFd(int eventFd);
+
+    // Pushes the frame and wakes the consumer if it is waiting, returns false if the ring is full
+    bool send(const uint8_t* data, std::size_t length);
+
+    [[nodiscard]] Ring& ring();
+    [[nodiscard]] int memoryFd() const;
+
+  private:
+    int m_memoryFd;
+    int m_wakeupFd;
+    void* m_mapping;
+    std::size_t m_mappingSize;
+    Ring m_ring;
+};
+
+// Sends a file descriptor as SCM_RIGHTS ancillary data over a unix socket
+bool sendFileDescriptor(int socketFd, int fd);
+
+// Returns the received file descriptor, or -1 on failure
+int receiveFileDescriptor(int socketFd);
+
+} // namespace odd::io::shm
+
+#endif // IO_SHM_CHANNEL_H_
@@ -0,0 +1,149 @@
+#include "Ring.h"
+
+#include <bit>
+#include <cstring>
+#include <new>
+
+namespace odd::io::shm {
+
+namespace {
+
+constexpr std::size_t LENGTH_SIZE = sizeof(uint32_t);
+
+std::size_t alignUp(std::size_t value, std::size_t alignment)
+{
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+std::size_t Ring::requiredSize(std::size_t capacity)
+{
+  return alignUp(sizeof(Header), FRAME_ALIGNMENT) + std::bit_ceil(capacity);
+}
+
+Ring::Ring(void* region, std::size_t capacity)
+  : m_header(new (region) Header{}),
+    m_buffer(static_cast<uint8_t*>(region) + alignUp(sizeof(Header), FRAME_ALIGNMENT))
+{
+  m_header->m_tail.store(0, std::memory_order_relaxed);
+  m_header->m_head.store(0, std::memory_order_relaxed);
+  m_header->m_consumerWaiting.store(0, std::memory_order_relaxed);
+  m_header->m_capacity = std::bit_ceil(capacity);
+}
+
+Ring::Ring(void* region)
+  : m_header(static_cast<Header*>(region)),
+    m_buffer(static_cast<uint8_t*>(region) + alignUp(sizeof(Header), FRAME_ALIGNMENT))
+{
+}
+
+bool Ring::tryPush(const uint8_t* data, std::size_t length)
+{
+  const auto capacity = m_header->m_capacity;
+  const auto frameSize = alignUp(LENGTH_SIZE + length, FRAME_ALIGNMENT);
+
+  if (frameSize > capacity / 2) return false;
+
+  auto tail = m_header->m_tail.load(std::memory_order_relaxed);
+  auto head = m_header->m_head.load(std::memory_order_acquire);
+
+  auto offset = tail & (capacity - 1);
+  auto untilEnd = capacity - offset;
+  auto padding = untilEnd < frameSize ? untilEnd : 0;
+
+  if (capacity - (tail - head) < padding + frameSize) return false;
+
+  if (padding > 0)
+  {
+    uint32_t marker = PADDING_MARKER;
+    std::memcpy(m_buffer + offset, &marker, LENGTH_SIZE);
+    tail += padding;
+    offset = 0;
+  }
+
+  uint32_t frameLength = static_cast<uint32_t>(length);
+  std::memcpy(m_buffer + offset, &frameLength, LENGTH_SIZE);
+  std::memcpy(m_buffer + offset + LENGTH_SIZE, data, length);
+
+  // Sequentially consistent so that the store is ordered before the load of the waiting flag
+  m_header->m_tail.store(tail + frameSize, std::memory_order_seq_cst);
+
+  return true;
+}
+
+bool Ring::takeWakeupRequest()
+{
+  if (m_header->m_consumerWaiting.load(std::memory_order_seq_cst) == 0) return false;
+
+  return m_header->m_consumerWaiting.exchange(0, std::memory_order_seq_cst) == 1;
+}
+
+std::size_t Ring::drain(const OnFrameCallback& onFrame)
+{
+  const auto capacity = m_header->m_capacity;
+  auto head = m_header->m_head.load(std::memory_order_relaxed);
+  std::size_t frames = 0;
+
+  while (true)
+  {
+    auto tail = m_header->m_tail.load(std::memory_order_acquire);
+
+    if (head == tail) break;
+
+    auto offset = head & (capacity - 1);
+    uint32_t frameLength;
+    std::memcpy(&frameLength, m_buffer + offset, LENGTH_SIZE);
+
+    // The length is written by the producer, a frame that runs past the end of the buffer or past
+    // the tail can only come from a corrupted ring, and everything up to the tail is discarded
+    auto frameSize = frameLength == PADDING_MARKER ? capacity - offset : alignUp(LENGTH_SIZE + frameLength, FRAME_ALIGNMENT);
+
+    if (frameSize > capacity - offset || frameSize > tail - head)
+    {
+      head = tail;
+      break;
+    }
+
+    if (frameLength == PADDING_MARKER)
+    {
+      head += frameSize;
+      continue;
+    }
+
+    onFrame(m_buffer + offset + LENGTH_SIZE, frameLength);
+    frames++;
+
+    head += frameSize;
+    m_header->m_head.store(head, std::memory_order_release);
+  }
+
+  m_header->m_head.store(head, std::memory_order_release);
+
+  return frames;
+}
+
+bool Ring::prepareToWait()
+{
+  m_header->m_consumerWaiting.store(1, std::memory_order_seq_cst);
+
+  if (not empty())
+  {
+    m_header->m_consumerWaiting.store(0, std::memory_order_relaxed);
+    return false;
+  }
+
+  return true;
+}
+
+bool Ring::empty() const
+{
+  return m_header->m_head.load(std::memory_order_seq_cst) == m_header->m_tail.load(std::memory_order_seq_cst);
+}
+
+std::size_t Ring::capacity() const
+{
+  return m_header->m_capacity;
+}
+
+} // namespace odd::io::shm
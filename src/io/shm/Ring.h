@@ -0,0 +1,77 @@
+#ifndef IO_SHM_RING_H_
+#define IO_SHM_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace odd::io::shm {
+
+using OnFrameCallback = std::function<void(uint8_t*, std::size_t)>;
+
+/*
+ * A single producer, single consumer ring of length prefixed frames that lives in a region of
+ * (possibly shared) memory. The ring only holds offsets, so it can be mapped at different
+ * addresses by the producer and consumer processes.
+ *
+ * Each frame is a 4 byte length followed by the payload, padded to 8 bytes. A frame never wraps,
+ * if it does not fit before the end of the buffer a padding marker is written and the frame starts
+ * again at the beginning.
+ *
+ * The consumer sets a waiting flag before it sleeps, and the producer only needs to wake it (e.g.
+ * with an eventfd) if takeWakeupRequest() returns true after a push.
+ */
+class Ring
+{
+  public:
+    // The capacity is rounded up to a power of two
+    [[nodiscard]] static std::size_t requiredSize(std::size_t capacity);
+
+    Ring() = default;
+
+    // Initialises a new ring in the region
+    Ring(void* region, std::size_t capacity);
+
+    // Uses a ring that has already been initialised in the region
+    explicit Ring(void* region);
+
+    // Returns false if there is no room for the frame
+    bool tryPush(const uint8_t* data, std::size_t length);
+
+    // Returns true if the consumer was waiting, the caller is then responsible for waking it
+    [[nodiscard]] bool takeWakeupRequest();
+
+    // Passes every available frame to onFrame and returns how many there were. Frames with a length
+    // that does not fit between the head and the tail are dropped along with the rest of the ring.
+    std::size_t drain(const OnFrameCallback& onFrame);
+
+    // Marks the consumer as waiting. Returns false if frames arrived in the meantime, in which case
+    // the consumer should drain again rather than sleep.
+    [[nodiscard]] bool prepareToWait();
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] std::size_t capacity() const;
+
+  private:
+    struct Header
+    {
+      alignas(64) std::atomic<uint64_t> m_tail;
+      alignas(64) std::atomic<uint64_t> m_head;
+      alignas(64) std::atomic<uint32_t> m_consumerWaiting;
+      uint64_t m_capacity;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+    static constexpr uint32_t PADDING_MARKER = 0xFFFFFFFF;
+    static constexpr std::size_t FRAME_ALIGNMENT = 8;
+
+    Header* m_header = nullptr;
+    uint8_t* m_buffer = nullptr;
+};
+
+} // namespace odd::io::shm
+
+#endif // IO_SHM_RING_H_
@@ -0,0 +1,160 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <shm/Channel.h>
+#include <shm/Ring.h>
+
+namespace odd::io::shm {
+
+TEST_CASE("Frames pushed to a ring are drained in order across the wrap around")
+{
+  constexpr std::size_t capacity = 256;
+  std::vector<uint8_t> region(Ring::requiredSize(capacity) + 64);
+  void* aligned = region.data() + (64 - reinterpret_cast<uintptr_t>(region.data()) % 64);
+
+  Ring ring{aligned, capacity};
+  REQUIRE(ring.capacity() == capacity);
+  REQUIRE(ring.empty());
+
+  uint8_t next = 0;
+  uint8_t expected = 0;
+
+  for (int round = 0; round < 20; round++)
+  {
+    std::vector<uint8_t> frame(37, next);
+
+    while (ring.tryPush(frame.data(), frame.size()))
+    {
+      frame.assign(37, ++next);
+    }
+
+    auto drained = ring.drain([&](uint8_t* data, std::size_t length) {
+      REQUIRE(length == 37);
+      CHECK(data[0] == expected);
+      CHECK(data[36] == expected);
+      expected++;
+    });
+
+    CHECK(drained > 0);
+    CHECK(ring.empty());
+  }
+
+  CHECK(expected == next);
+}
+
+TEST_CASE("A ring refuses frames larger than half of its capacity")
+{
+  constexpr std::size_t capacity = 128;
+  std::vector<uint8_t> region(Ring::requiredSize(capacity) + 64);
+  void* aligned = region.data() + (64 - reinterpret_cast<uintptr_t>(region.data()) % 64);
+
+  Ring ring{aligned, capacity};
+  std::vector<uint8_t> frame(100);
+
+  CHECK_FALSE(ring.tryPush(frame.data(), frame.size()));
+}
+
+TEST_CASE("A ring drops a frame whose length runs past the frames that were pushed")
+{
+  constexpr std::size_t capacity = 256;
+  std::vector<uint8_t> region(Ring::requiredSize(capacity) + 64);
+  auto* aligned = region.data() + (64 - reinterpret_cast<uintptr_t>(region.data()) % 64);
+
+  Ring ring{aligned, capacity};
+  std::vector<uint8_t> frame(10, 7);
+
+  REQUIRE(ring.tryPush(frame.data(), frame.size()));
+  REQUIRE(ring.tryPush(frame.data(), frame.size()));
+
+  // The producer overwrites the length of the second frame, which starts 16 bytes into the buffer
+  uint32_t corrupted = 0x00FFFFFF;
+  std::memcpy(aligned + Ring::requiredSize(capacity) - capacity + 16, &corrupted, sizeof(corrupted));
+
+  std::size_t delivered = 0;
+  auto drained = ring.drain([&](uint8_t*, std::size_t length) {
+    CHECK(length == frame.size());
+    delivered++;
+  });
+
+  CHECK(drained == 1);
+  CHECK(delivered == 1);
+  CHECK(ring.empty());
+
+  REQUIRE(ring.tryPush(frame.data(), frame.size()));
+  CHECK(ring.drain([](uint8_t*, std::size_t) {}) == 1);
+}
+
+TEST_CASE("A waiting consumer is woken once")
+{
+  constexpr std::size_t capacity = 256;
+  std::vector<uint8_t> region(Ring::requiredSize(capacity) + 64);
+  void* aligned = region.data() + (64 - reinterpret_cast<uintptr_t>(region.data()) % 64);
+
+  Ring ring{aligned, capacity};
+  uint8_t byte = 1;
+
+  REQUIRE(ring.tryPush(&byte, 1));
+  CHECK_FALSE(ring.takeWakeupRequest());
+  CHECK_FALSE(ring.prepareToWait());
+
+  ring.drain([](uint8_t*, std::size_t) {});
+  REQUIRE(ring.prepareToWait());
+  REQUIRE(ring.tryPush(&byte, 1));
+  CHECK(ring.takeWakeupRequest());
+  CHECK_FALSE(ring.takeWakeupRequest());
+}
+
+TEST_CASE("A channel attached to a received memfd shares the ring of its creator")
+{
+  auto producer = Channel::create(1024);
+  REQUIRE(producer);
+
+  int sockets[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+  REQUIRE(sendFileDescriptor(sockets[0], producer->memoryFd()));
+
+  int memoryFd = receiveFileDescriptor(sockets[1]);
+  REQUIRE(memoryFd >= 0);
+
+  auto consumer = Channel::attach(memoryFd);
+  REQUIRE(consumer);
+
+  constexpr std::size_t messageCount = 10000;
+
+  std::thread producerThread{[&] {
+    for (uint32_t i = 0; i < messageCount; i++)
+    {
+      while (not producer->send(reinterpret_cast<const uint8_t*>(&i), sizeof(i)))
+      {
+        std::this_thread::yield();
+      }
+    }
+  }};
+
+  uint32_t expected = 0;
+  bool inOrder = true;
+
+  while (expected < messageCount)
+  {
+    consumer->ring().drain([&](uint8_t* data, std::size_t length) {
+      uint32_t value;
+      std::memcpy(&value, data, length);
+      inOrder = inOrder && value == expected;
+      expected++;
+    });
+  }
+
+  producerThread.join();
+  CHECK(inOrder);
+
+  close(sockets[0]);
+  close(sockets[1]);
+}
+
+} // namespace odd::io::shm
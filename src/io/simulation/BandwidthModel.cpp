@@ -0,0 +1,102 @@
+#include "BandwidthModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace odd::io::simulation {
+
+namespace {
+
+bool isLimited(const NodeCapacity& capacity)
+{
+  return capacity.m_uplink > 0.0 || capacity.m_downlink > 0.0;
+}
+
+} // namespace
+
+BandwidthModel::BandwidthModel(NodeCapacity defaultCapacity)
+  : m_defaultCapacity(defaultCapacity),
+    m_limited(isLimited(defaultCapacity))
+{
+}
+
+void BandwidthModel::setNode(uint32_t ipAddress, NodeCapacity capacity)
+{
+  m_capacities[ipAddress] = capacity;
+  m_limited = m_limited || isLimited(capacity);
+}
+
+void BandwidthModel::setDefault(NodeCapacity capacity)
+{
+  m_defaultCapacity = capacity;
+  m_limited = isLimited(capacity) || std::any_of(m_capacities.begin(), m_capacities.end(), [] (const auto& node)
+  {
+    return isLimited(node.second);
+  });
+}
+
+[[nodiscard]] const NodeCapacity& BandwidthModel::capacity(uint32_t ipAddress) const
+{
+  auto it = m_capacities.find(ipAddress);
+
+  return it == m_capacities.end() ? m_defaultCapacity : it->second;
+}
+
+[[nodiscard]] bool BandwidthModel::limited() const
+{
+  return m_limited;
+}
+
+[[nodiscard]] std::optional<SimTime> BandwidthModel::transmit(uint32_t ipAddress, SimTime now, std::size_t bytes)
+{
+  const auto& node = capacity(ipAddress);
+
+  if (node.m_uplink <= 0.0) return now;
+
+  return enqueue(m_queues[ipAddress].m_uplink, node.m_uplink, node.m_queueLimit, now, bytes);
+}
+
+[[nodiscard]] std::optional<SimTime> BandwidthModel::receive(uint32_t ipAddress, SimTime now, std::size_t bytes)
+{
+  const auto& node = capacity(ipAddress);
+
+  if (node.m_downlink <= 0.0) return now;
+
+  return enqueue(m_queues[ipAddress].m_downlink, node.m_downlink, node.m_queueLimit, now, bytes);
+}
+
+[[nodiscard]] std::size_t BandwidthModel::dropped() const
+{
+  return m_dropped;
+}
+
+[[nodiscard]] SimTime BandwidthModel::meanQueueingDelay() const
+{
+  return m_queued == 0 ? SimTime{ 0 } : m_queueingDelay / static_cast<SimTime::rep>(m_queued);
+}
+
+std::optional<SimTime> BandwidthModel::enqueue(Queue& queue, double rate, std::size_t limit, SimTime now, std::size_t bytes)
+{
+  auto start = std::max(now, queue.m_busyUntil);
+  auto wait = start - now;
+
+  // The bytes still to pass through ahead of this message
+  auto waiting = std::chrono::duration<double>(wait).count() * rate;
+
+  if (limit > 0 && waiting + static_cast<double>(bytes) > static_cast<double>(limit))
+  {
+    m_dropped++;
+    return std::nullopt;
+  }
+
+  auto serialisation = SimTime{ static_cast<SimTime::rep>(std::ceil(static_cast<double>(bytes) * 1e9 / rate)) };
+
+  queue.m_busyUntil = start + serialisation;
+
+  m_queued++;
+  m_queueingDelay += wait;
+
+  return queue.m_busyUntil;
+}
+
+} // namespace odd::io::simulation
@@ -0,0 +1,83 @@
+#ifndef IO_SIMULATION_BANDWIDTH_MODEL_H_
+#define IO_SIMULATION_BANDWIDTH_MODEL_H_
+
+#include "Scheduler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+namespace odd::io::simulation {
+
+// How fast a node can send and receive, in bytes per second, and how many bytes can wait in each
+// direction's queue. Zero is unlimited
+struct NodeCapacity
+{
+  double m_uplink = 0.0;
+  double m_downlink = 0.0;
+  std::size_t m_queueLimit = 0;
+};
+
+/*
+ * The access links of the nodes of a simulated network. Each node has an uplink that the messages
+ * it sends leave through and a downlink that the messages it is sent arrive through, each a first
+ * in first out queue served at the node's capacity. A message waits for the ones ahead of it, then
+ * takes its size over the capacity to pass through, and is dropped if the bytes waiting ahead of it
+ * and its own would go over the queue limit.
+ *
+ * Every node has the default capacity unless it has been given its own. Only the nodes whose
+ * queues have been used have any state kept for them.
+ */
+class BandwidthModel
+{
+  public:
+    explicit BandwidthModel(NodeCapacity defaultCapacity = {});
+
+    void setNode(uint32_t ipAddress, NodeCapacity capacity);
+    void setDefault(NodeCapacity capacity);
+
+    [[nodiscard]] const NodeCapacity& capacity(uint32_t ipAddress) const;
+
+    // True if any node's capacity is limited, otherwise messages do not need to be queued at all
+    [[nodiscard]] bool limited() const;
+
+    // Queues a message of the given size that is sent or received now, returns when it has passed
+    // through the queue or nothing if the queue is full
+    [[nodiscard]] std::optional<SimTime> transmit(uint32_t ipAddress, SimTime now, std::size_t bytes);
+    [[nodiscard]] std::optional<SimTime> receive(uint32_t ipAddress, SimTime now, std::size_t bytes);
+
+    // The messages the queues have dropped
+    [[nodiscard]] std::size_t dropped() const;
+
+    // The mean time the messages that were queued waited behind the ones ahead of them
+    [[nodiscard]] SimTime meanQueueingDelay() const;
+
+  private:
+    struct Queue
+    {
+      // When the last message in the queue has passed through it
+      SimTime m_busyUntil{ 0 };
+    };
+
+    struct NodeQueues
+    {
+      Queue m_uplink;
+      Queue m_downlink;
+    };
+
+    std::optional<SimTime> enqueue(Queue& queue, double rate, std::size_t limit, SimTime now, std::size_t bytes);
+
+    NodeCapacity m_defaultCapacity;
+    std::unordered_map<uint32_t, NodeCapacity> m_capacities;
+    std::unordered_map<uint32_t, NodeQueues> m_queues;
+    bool m_limited;
+
+    std::size_t m_dropped = 0;
+    std::size_t m_queued = 0;
+    SimTime m_queueingDelay{ 0 };
+};
+
+} // namespace odd::io::simulation
+
+#endif // IO_SIMULATION_BANDWIDTH_MODEL_H_
@@ -0,0 +1,97 @@
+#include "LinkModel.h"
+
+#include <algorithm>
+
+namespace odd::io::simulation {
+
+LinkModel::LinkModel(uint64_t seed, LinkProfile defaultProfile)
+  : m_seed(seed),
+    m_defaultProfile(defaultProfile),
+    m_generator(seed)
+{
+}
+
+void LinkModel::setLink(uint32_t sourceIpAddress, uint32_t destinationIpAddress, LinkProfile profile)
+{
+  m_links[linkKey(sourceIpAddress, destinationIpAddress)] = profile;
+}
+
+void LinkModel::setDefault(LinkProfile profile)
+{
+  m_defaultProfile = profile;
+}
+
+[[nodiscard]] const LinkProfile& LinkModel::profile(uint32_t sourceIpAddress, uint32_t destinationIpAddress) const
+{
+  auto it = m_links.find(linkKey(sourceIpAddress, destinationIpAddress));
+
+  return it == m_links.end() ? m_defaultProfile : it->second;
+}
+
+[[nodiscard]] std::optional<SimTime> LinkModel::sample(uint32_t sourceIpAddress, uint32_t destinationIpAddress)
+{
+  const auto& link = profile(sourceIpAddress, destinationIpAddress);
+
+  if (link.m_lossProbability > 0.0 &&
+      std::bernoulli_distribution{ link.m_lossProbability }(m_generator))
+  {
+    return std::nullopt;
+  }
+
+  if (link.m_jitter.count() <= 0) return link.m_latency;
+
+  std::uniform_int_distribution<SimTime::rep> jitter{ 0, link.m_jitter.count() };
+
+  return link.m_latency + SimTime{ jitter(m_generator) };
+}
+
+[[nodiscard]] std::optional<SimTime> LinkModel::sample(uint32_t sourceIpAddress,
+                                                      uint32_t destinationIpAddress,
+                                                      uint64_t draw) const
+{
+  const auto& link = profile(sourceIpAddress, destinationIpAddress);
+
+  auto random = mix(m_seed ^ mix(linkKey(sourceIpAddress, destinationIpAddress) ^ mix(draw)));
+
+  // The top 53 bits as a double in [0, 1)
+  if (link.m_lossProbability > 0.0 &&
+      static_cast<double>(random >> 11) * 0x1.0p-53 < link.m_lossProbability)
+  {
+    return std::nullopt;
+  }
+
+  if (link.m_jitter.count() <= 0) return link.m_latency;
+
+  auto jitter = mix(random) % (static_cast<uint64_t>(link.m_jitter.count()) + 1);
+
+  return link.m_latency + SimTime{ static_cast<SimTime::rep>(jitter) };
+}
+
+[[nodiscard]] SimTime LinkModel::minimumLatency() const
+{
+  auto latency = m_defaultProfile.m_latency;
+
+  for (const auto& [key, link] : m_links)
+  {
+    latency = std::min(latency, link.m_latency);
+  }
+
+  return latency;
+}
+
+uint64_t LinkModel::linkKey(uint32_t sourceIpAddress, uint32_t destinationIpAddress)
+{
+  return (static_cast<uint64_t>(sourceIpAddress) << 32) | destinationIpAddress;
+}
+
+// splitmix64's finaliser
+uint64_t LinkModel::mix(uint64_t value)
+{
+  value += 0x9e3779b97f4a7c15;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+
+  return value ^ (value >> 31);
+}
+
+} // namespace odd::io::simulation
@@ -0,0 +1,63 @@
+#ifndef IO_SIMULATION_LINK_MODEL_H_
+#define IO_SIMULATION_LINK_MODEL_H_
+
+#include "Scheduler.h"
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <unordered_map>
+
+namespace odd::io::simulation {
+
+// How long a message takes along a link, and how likely it is to be lost. The delay is the latency
+// plus a jitter drawn uniformly from [0, jitter], so messages along a link with jitter can be
+// reordered
+struct LinkProfile
+{
+  SimTime m_latency{ std::chrono::milliseconds{ 10 } };
+  SimTime m_jitter{ 0 };
+  double m_lossProbability = 0.0;
+};
+
+/*
+ * The links between the nodes of a simulated network. Every link uses the default profile unless
+ * it has been given its own, links are one way so the two directions can differ.
+ *
+ * All the randomness comes from the one seeded generator, so a simulation that sends the same
+ * messages in the same order sees the same delays and losses. A simulation that sends from several
+ * threads can instead number each sender's draws itself, a numbered draw depends only on the seed,
+ * the link and the number, not on what was drawn before it.
+ */
+class LinkModel
+{
+  public:
+    explicit LinkModel(uint64_t seed = 1, LinkProfile defaultProfile = {});
+
+    void setLink(uint32_t sourceIpAddress, uint32_t destinationIpAddress, LinkProfile profile);
+    void setDefault(LinkProfile profile);
+
+    [[nodiscard]] const LinkProfile& profile(uint32_t sourceIpAddress, uint32_t destinationIpAddress) const;
+
+    // The delay of the next message along the link, or nothing if the message is lost
+    [[nodiscard]] std::optional<SimTime> sample(uint32_t sourceIpAddress, uint32_t destinationIpAddress);
+
+    // The same, for the draw with the given number, does not use the generator
+    [[nodiscard]] std::optional<SimTime> sample(uint32_t sourceIpAddress, uint32_t destinationIpAddress, uint64_t draw) const;
+
+    // The lowest latency of any link, no message is delivered sooner than this
+    [[nodiscard]] SimTime minimumLatency() const;
+
+  private:
+    static uint64_t linkKey(uint32_t sourceIpAddress, uint32_t destinationIpAddress);
+    static uint64_t mix(uint64_t value);
+
+    uint64_t m_seed;
+    LinkProfile m_defaultProfile;
+    std::unordered_map<uint64_t, LinkProfile> m_links;
+    std::mt19937_64 m_generator;
+};
+
+} // namespace odd::io::simulation
+
+#endif // IO_SIMULATION_LINK_MODEL_H_
@@ -0,0 +1,53 @@
+#ifndef IO_SIMULATION_MAILBOX_H_
+#define IO_SIMULATION_MAILBOX_H_
+
+#include <atomic>
+
+namespace odd::io::simulation {
+
+/*
+ * A lock free list that any number of threads post to and one thread empties. Posting is a single
+ * compare and swap and emptying a single exchange, so a thread posting is never held up by another.
+ * The items are linked through their m_next member, and taken newest first.
+ *
+ * The mailbox owns the items posted to it until they are taken, the taker owns them after that.
+ */
+template <typename T>
+class Mailbox
+{
+  public:
+    Mailbox() = default;
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    ~Mailbox()
+    {
+      for (auto* item = takeAll(); item != nullptr;)
+      {
+        auto* next = item->m_next;
+        delete item;
+        item = next;
+      }
+    }
+
+    void post(T* item)
+    {
+      item->m_next = m_head.load(std::memory_order_relaxed);
+
+      while (not m_head.compare_exchange_weak(item->m_next, item, std::memory_order_release, std::memory_order_relaxed))
+      {
+      }
+    }
+
+    [[nodiscard]] T* takeAll()
+    {
+      return m_head.exchange(nullptr, std::memory_order_acquire);
+    }
+
+  private:
+    std::atomic<T*> m_head{ nullptr };
+};
+
+} // namespace odd::io::simulation
+
+#endif // IO_SIMULATION_MAILBOX_H_
@@ -0,0 +1,125 @@
+#include "MessageArena.h"
+
+#include <bit>
+#include <cstring>
+
+namespace odd::io::simulation {
+
+MessageArena::Handle MessageArena::store(uint32_t sourceIpAddress,
+                                         uint32_t destinationIndex,
+                                         const uint8_t* message,
+                                         std::size_t length)
+{
+  auto messageClass = sizeClass(length);
+  uint8_t* data;
+
+  if (messageClass == OVERSIZED)
+  {
+    m_blocks.push_back(std::make_unique<uint8_t[]>(length));
+    m_reservedBytes += length;
+    data = m_blocks.back().get();
+  }
+  else
+  {
+    data = allocate(messageClass);
+  }
+
+  if (length > 0) std::memcpy(data, message, length);
+
+  InFlightMessage inFlight{ data, static_cast<uint32_t>(length), sourceIpAddress, destinationIndex, messageClass };
+
+  if (m_freeHandles.empty())
+  {
+    m_messages.push_back(inFlight);
+    return static_cast<Handle>(m_messages.size() - 1);
+  }
+
+  auto handle = m_freeHandles.back();
+  m_freeHandles.pop_back();
+  m_messages[handle] = inFlight;
+
+  return handle;
+}
+
+[[nodiscard]] const MessageArena::InFlightMessage& MessageArena::get(Handle handle) const
+{
+  return m_messages[handle];
+}
+
+void MessageArena::release(Handle handle)
+{
+  auto& message = m_messages[handle];
+
+  if (message.m_sizeClass == OVERSIZED)
+  {
+    // Oversized messages are rare, so finding the block is allowed to be slow
+    for (auto it = m_blocks.rbegin(); it != m_blocks.rend(); ++it)
+    {
+      if (it->get() == message.m_data)
+      {
+        m_reservedBytes -= message.m_length;
+        m_blocks.erase(std::next(it).base());
+        break;
+      }
+    }
+  }
+  else
+  {
+    m_freeBuffers[message.m_sizeClass].push_back(message.m_data);
+  }
+
+  message.m_data = nullptr;
+  m_freeHandles.push_back(handle);
+}
+
+[[nodiscard]] std::size_t MessageArena::inFlight() const
+{
+  return m_messages.size() - m_freeHandles.size();
+}
+
+[[nodiscard]] std::size_t MessageArena::reservedBytes() const
+{
+  return m_reservedBytes;
+}
+
+uint8_t MessageArena::sizeClass(std::size_t length)
+{
+  if (length <= (std::size_t{ 1 } << MIN_CLASS_SHIFT)) return 0;
+
+  auto shift = static_cast<std::size_t>(std::bit_width(length - 1));
+
+  if (shift - MIN_CLASS_SHIFT >= SIZE_CLASSES) return OVERSIZED;
+
+  return static_cast<uint8_t>(shift - MIN_CLASS_SHIFT);
+}
+
+uint8_t* MessageArena::allocate(uint8_t sizeClass)
+{
+  auto& freeBuffers = m_freeBuffers[sizeClass];
+
+  if (not freeBuffers.empty())
+  {
+    auto* buffer = freeBuffers.back();
+    freeBuffers.pop_back();
+    return buffer;
+  }
+
+  auto bufferSize = std::size_t{ 1 } << (sizeClass + MIN_CLASS_SHIFT);
+
+  // The rest of a block that is too small for the buffer is left unused
+  if (m_blockRemaining < bufferSize)
+  {
+    m_blocks.push_back(std::make_unique<uint8_t[]>(BLOCK_SIZE));
+    m_reservedBytes += BLOCK_SIZE;
+    m_blockCursor = m_blocks.back().get();
+    m_blockRemaining = BLOCK_SIZE;
+  }
+
+  auto* buffer = m_blockCursor;
+  m_blockCursor += bufferSize;
+  m_blockRemaining -= bufferSize;
+
+  return buffer;
+}
+
+} // namespace odd::io::simulation
@@ -0,0 +1,74 @@
+#ifndef IO_SIMULATION_MESSAGE_ARENA_H_
+#define IO_SIMULATION_MESSAGE_ARENA_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace odd::io::simulation {
+
+/*
+ * Holds copies of the messages that are in flight in a scheduled network. Buffers are carved out
+ * of large blocks in power of two size classes and go back on a free list for their class when the
+ * message is delivered or dropped, so a long simulation stops allocating once it reaches its peak
+ * number of messages in flight. Messages larger than the biggest class get a block of their own.
+ *
+ * A message is referred to by a small handle, so an event that delivers it fits in the small
+ * buffer of a std::function. Not thread safe.
+ */
+class MessageArena
+{
+  public:
+    using Handle = uint32_t;
+
+    struct InFlightMessage
+    {
+      uint8_t* m_data;
+      uint32_t m_length;
+      uint32_t m_sourceIpAddress;
+      uint32_t m_destinationIndex;
+      uint8_t m_sizeClass;
+    };
+
+    MessageArena() = default;
+    MessageArena(const MessageArena&) = delete;
+    MessageArena& operator=(const MessageArena&) = delete;
+
+    Handle store(uint32_t sourceIpAddress, uint32_t destinationIndex, const uint8_t* message, std::size_t length);
+
+    [[nodiscard]] const InFlightMessage& get(Handle handle) const;
+
+    void release(Handle handle);
+
+    [[nodiscard]] std::size_t inFlight() const;
+
+    // The bytes taken from the system for message buffers, whether or not they are in use
+    [[nodiscard]] std::size_t reservedBytes() const;
+
+  private:
+    static constexpr std::size_t MIN_CLASS_SHIFT = 6;
+    static constexpr std::size_t SIZE_CLASSES = 11;
+    static constexpr std::size_t BLOCK_SIZE = 1 << 20;
+
+    // Messages of this size class or larger are allocated on their own
+    static constexpr uint8_t OVERSIZED = SIZE_CLASSES;
+
+    static uint8_t sizeClass(std::size_t length);
+
+    uint8_t* allocate(uint8_t sizeClass);
+
+    std::array<std::vector<uint8_t*>, SIZE_CLASSES> m_freeBuffers;
+    std::vector<std::unique_ptr<uint8_t[]>> m_blocks;
+    uint8_t* m_blockCursor = nullptr;
+    std::size_t m_blockRemaining = 0;
+    std::size_t m_reservedBytes = 0;
+
+    std::vector<InFlightMessage> m_messages;
+    std::vector<Handle> m_freeHandles;
+};
+
+} // namespace odd::io::simulation
+
+#endif // IO_SIMULATION_MESSAGE_ARENA_H_
@@ -9,7 +9,15 @@
 namespace odd::io::simulation {
 
 Network::Network()
-  : m_nextNodeId(0)
+  : m_nodeCount(0),
+    m_scheduler(nullptr)
+{
+}
+
+Network::Network(Scheduler& scheduler, LinkModel linkModel)
+  : m_nodeCount(0),
+    m_scheduler(&scheduler),
+    m_linkModel(std::move(linkModel))
 {
 }
 
@@ -33,81 +41,181 @@ Node& Network::addNode(const std::string& ipAddress, Node::ReceiveHandler receiv
 
 Node& Network::addNode(uint32_t ipAddress)
 {
-  m_nodeIds.push_back(m_nextNodeId++);
+  return addNode(ipAddress, nullptr);
+}
+
+Node& Network::addNode(uint32_t ipAddress, Node::ReceiveHandler receiveHandler)
+{
+  auto nodeId = m_nodeCount;
+
+  m_ipAddresses.push_back(ipAddress);
+  m_receiveHandlers.push_back(std::move(receiveHandler));
+  m_nodes.emplace_back(*this, nodeId);
+
+  // TODO (haigh) do I need some mechanism to remove these if a node leaves?
+  m_nodeIdLookup.emplace(ipAddress, nodeId);
 
-  auto onSendCallback = [this] (uint32_t source,
-                                uint32_t dest,
-                                uint8_t* message,
-                                size_t messageLength)
-                        {
-                          sendMessage(source,
-                                      dest,
-                                      message,
-                                      messageLength);
-                        };
+  m_nodeCount++;
 
-  auto node = std::make_unique<Node>(m_nodeIds.back(),
-                                              ipAddress,
-                                              onSendCallback);
+  return m_nodes.back();
+}
+
+void Network::sendMessage(uint32_t sourceIpAddress,
+                                   uint32_t destinationIpAddress,
+                                   uint8_t* message,
+                                   size_t messageLength)
+{
+  if (m_trace) record(trace::Direction::SENT, sourceIpAddress, destinationIpAddress, message, messageLength);
 
-  m_nodes.push_back(std::move(node));
+  auto destination = nodeId(destinationIpAddress);
 
-  m_nodeIdLookup.emplace(ipAddress, m_nodeIds.back());
+  if (destination == NO_NODE) return;
 
-  if (m_nodes.size() == 1) return *m_nodes.back();
+  if (m_scheduler == nullptr)
+  {
+    deliver(sourceIpAddress, destination, message, messageLength);
+    return;
+  }
 
-  return *m_nodes.back();
+  if (not m_bandwidthModel.limited())
+  {
+    auto delay = m_linkModel.sample(sourceIpAddress, destinationIpAddress);
 
+    if (not delay) return;
+
+    // The sender's buffer is only valid for the duration of the call
+    auto handle = m_inFlight.store(sourceIpAddress, destination, message, messageLength);
+
+    m_scheduler->scheduleAfter(*delay, [this, handle] { deliverInFlight(handle); });
+    return;
+  }
+
+  // A message the link loses has still taken its time on the sender's uplink
+  auto sent = m_bandwidthModel.transmit(sourceIpAddress, m_scheduler->now(), messageLength);
+
+  if (not sent) return;
+
+  auto delay = m_linkModel.sample(sourceIpAddress, destinationIpAddress);
+
+  if (not delay) return;
+
+  auto handle = m_inFlight.store(sourceIpAddress, destination, message, messageLength);
+
+  if (m_bandwidthModel.capacity(destinationIpAddress).m_downlink > 0.0)
+  {
+    m_scheduler->schedule(*sent + *delay, [this, handle] { arriveInFlight(handle); });
+  }
+  else
+  {
+    m_scheduler->schedule(*sent + *delay, [this, handle] { deliverInFlight(handle); });
+  }
 }
 
-Node& Network::addNode(uint32_t ipAddress, Node::ReceiveHandler receiveHandler)
+void Network::registerDeliveryHandler(DeliveryHandler deliveryHandler)
+{
+  m_deliveryHandler = std::move(deliveryHandler);
+}
+
+void Network::setTrace(std::shared_ptr<trace::TraceWriter> trace)
+{
+  m_trace = std::move(trace);
+}
+
+[[nodiscard]] Node& Network::node(uint32_t nodeId)
 {
-  m_nodeIds.push_back(m_nextNodeId++);
+  return m_nodes[nodeId];
+}
 
-  auto onSendCallback = [this] (uint32_t source,
-                                uint32_t dest,
-                                uint8_t* message,
-                                size_t messageLength)
-                        {
-                          sendMessage(source,
-                                      dest,
-                                      message,
-                                      messageLength);
-                        };
+[[nodiscard]] uint32_t Network::nodeId(uint32_t ipAddress) const
+{
+  auto it = m_nodeIdLookup.find(ipAddress);
 
-  auto node = std::make_unique<Node>(m_nodeIds.back(),
-                                              ipAddress,
-                                              onSendCallback,
-                                              std::move(receiveHandler));
+  return it == m_nodeIdLookup.end() ? NO_NODE : it->second;
+}
 
-  m_nodes.push_back(std::move(node));
+[[nodiscard]] std::size_t Network::size() const
+{
+  return m_nodeCount;
+}
 
-  // TODO (haigh) do I need some mechanism to remove these if a node leaves?
-  m_nodeIdLookup.emplace(ipAddress, m_nodeIds.back());
+[[nodiscard]] LinkModel& Network::links()
+{
+  return m_linkModel;
+}
 
-  if (m_nodes.size() == 1) return *m_nodes.back();
+[[nodiscard]] BandwidthModel& Network::bandwidth()
+{
+  return m_bandwidthModel;
+}
 
-  return *m_nodes.back();
+[[nodiscard]] const MessageArena& Network::inFlight() const
+{
+  return m_inFlight;
 }
 
-void Network::sendMessage(uint32_t sourceIpAddress,
-                                   uint32_t destinationIpAddress,
-                                   uint8_t* message,
-                                   size_t messageLength)
+void Network::deliver(uint32_t sourceIpAddress,
+                      uint32_t destinationNodeId,
+                      uint8_t* message,
+                      size_t messageLength)
 {
-  // Go through each of the nodes that we have and find the destination Ip Address
-  auto nodeIp_p = m_nodeIdLookup.find(destinationIpAddress);
+  if (m_trace)
+  {
+    record(trace::Direction::RECEIVED, sourceIpAddress, m_ipAddresses[destinationNodeId], message, messageLength);
+  }
 
-  if (nodeIp_p == m_nodeIdLookup.end()) return;
+  const auto& receiveHandler = m_receiveHandlers[destinationNodeId];
 
-  for (auto& node : m_nodes)
+  if (receiveHandler)
+  {
+    receiveHandler(sourceIpAddress, message, messageLength);
+  }
+  else if (m_deliveryHandler)
   {
-    if (node->nodeId() == nodeIp_p->second)
-    {
-      node->receiveMessage(sourceIpAddress, message, messageLength);
-    }
+    m_deliveryHandler(destinationNodeId, sourceIpAddress, message, messageLength);
   }
 }
 
-} // namespace odd::io::simulation
+void Network::deliverInFlight(MessageArena::Handle handle)
+{
+  const auto& inFlight = m_inFlight.get(handle);
+
+  // The handler may send, which can grow the arena's table of messages, so copy the details out
+  auto* data = inFlight.m_data;
+  auto length = inFlight.m_length;
+  auto source = inFlight.m_sourceIpAddress;
+  auto destination = inFlight.m_destinationIndex;
+
+  deliver(source, destination, data, length);
+
+  m_inFlight.release(handle);
+}
+
+void Network::arriveInFlight(MessageArena::Handle handle)
+{
+  const auto& inFlight = m_inFlight.get(handle);
 
+  auto received = m_bandwidthModel.receive(m_ipAddresses[inFlight.m_destinationIndex],
+                                           m_scheduler->now(),
+                                           inFlight.m_length);
+
+  if (not received)
+  {
+    m_inFlight.release(handle);
+    return;
+  }
+
+  m_scheduler->schedule(*received, [this, handle] { deliverInFlight(handle); });
+}
+
+void Network::record(trace::Direction direction,
+                     uint32_t sourceIpAddress,
+                     uint32_t destinationIpAddress,
+                     const uint8_t* message,
+                     size_t messageLength)
+{
+  auto timestamp = m_scheduler == nullptr ? SimTime{ 0 } : m_scheduler->now();
+
+  m_trace->record(direction, timestamp, sourceIpAddress, destinationIpAddress, message, messageLength);
+}
+
+} // namespace odd::io::simulation
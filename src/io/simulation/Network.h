@@ -1,19 +1,50 @@
 #ifndef IO_SIMULATION_NETWORK_H_
 #define IO_SIMULATION_NETWORK_H_
 
+#include "BandwidthModel.h"
+#include "LinkModel.h"
+#include "MessageArena.h"
 #include "Node.h"
+#include "Scheduler.h"
+#include "../trace/TraceWriter.h"
 
+#include <deque>
 #include <functional>
 #include <cstdint>
 #include <string>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace odd::io::simulation {
 
+/*
+ * Connects simulated nodes by their ip addresses. A network created without a scheduler delivers a
+ * message straight away on the sender's stack. A network created with one delivers it as an event,
+ * after the delay of the link it was sent along, and drops the messages the link loses. The
+ * messages in flight are kept in a MessageArena.
+ *
+ * If any node's bandwidth is limited, a scheduled message also queues to leave through its
+ * sender's uplink before it crosses the link and to arrive through its destination's downlink
+ * after, so the messages a node sends and receives compete for its capacity.
+ *
+ * The state of the nodes is kept in columns indexed by node ID, and a message is delivered by
+ * indexing its destination's receive handler. Simulations of very large networks can leave the
+ * nodes without handlers of their own and register one delivery handler for the whole network,
+ * which is given the destination's node ID and keeps its per node state in arrays of its own.
+ *
+ * A trace writer set on the network records every message when it is sent and again when it is
+ * delivered, timestamped with the scheduler's time (zero without a scheduler).
+ */
 class Network {
   public:
+    // Called for messages to nodes that do not have a receive handler, with the destination's node ID
+    using DeliveryHandler = std::function<void(uint32_t, uint32_t, uint8_t*, size_t)>;
+
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
     Network();
+    explicit Network(Scheduler& scheduler, LinkModel linkModel = LinkModel{});
     virtual ~Network() = default;
     void run(); // TODO (haigh) is this method even needed?
     Node& addNode(uint32_t ipAddress);
@@ -25,13 +56,94 @@ class Network {
                      uint8_t* message,
                      size_t messageLength);
 
+    void registerDeliveryHandler(DeliveryHandler deliveryHandler);
+
+    // Passing nullptr stops the recording
+    void setTrace(std::shared_ptr<trace::TraceWriter> trace);
+
+    [[nodiscard]] Node& node(uint32_t nodeId);
+
+    // The node ID of the node with the address, or NO_NODE
+    [[nodiscard]] uint32_t nodeId(uint32_t ipAddress) const;
+
+    [[nodiscard]] std::size_t size() const;
+
+    [[nodiscard]] LinkModel& links();
+    [[nodiscard]] BandwidthModel& bandwidth();
+    [[nodiscard]] const MessageArena& inFlight() const;
+
   private:
-    std::vector<int> m_nodeIds; // sorted list of nodeIds (which are ints starting from 0)
-    std::vector<std::unique_ptr<Node>> m_nodes;
-    int m_nextNodeId;
+    friend class Node;
+
+    /*
+     * Grows a chunk at a time and the chunks never move, so the state of a node stays where it is
+     * while other nodes are added (the chord tests add nodes while the others' threads are sending).
+     */
+    template <typename T>
+    class Column
+    {
+      public:
+        static constexpr uint32_t CHUNK_SHIFT = 16;
+        static constexpr uint32_t CHUNK_SIZE = 1 << CHUNK_SHIFT;
+
+        Column()
+        {
+          // Enough chunk pointers for every node ID, so the chunk table never moves either
+          m_chunks.reserve((std::size_t{ UINT32_MAX } + 1) / CHUNK_SIZE);
+        }
+
+        T& operator[](uint32_t index)
+        {
+          return m_chunks[index >> CHUNK_SHIFT][index & (CHUNK_SIZE - 1)];
+        }
+
+        const T& operator[](uint32_t index) const
+        {
+          return m_chunks[index >> CHUNK_SHIFT][index & (CHUNK_SIZE - 1)];
+        }
+
+        void push_back(T value)
+        {
+          if ((m_size & (CHUNK_SIZE - 1)) == 0) m_chunks.push_back(std::make_unique<T[]>(CHUNK_SIZE));
+
+          (*this)[m_size++] = std::move(value);
+        }
+
+      private:
+        std::vector<std::unique_ptr<T[]>> m_chunks;
+        uint32_t m_size = 0;
+    };
+
+    void deliver(uint32_t sourceIpAddress,
+                 uint32_t destinationNodeId,
+                 uint8_t* message,
+                 size_t messageLength);
+
+    void deliverInFlight(MessageArena::Handle handle);
+
+    // Queues a message that has crossed its link for the destination's downlink
+    void arriveInFlight(MessageArena::Handle handle);
+
+    void record(trace::Direction direction,
+                uint32_t sourceIpAddress,
+                uint32_t destinationIpAddress,
+                const uint8_t* message,
+                size_t messageLength);
+
+    Column<uint32_t> m_ipAddresses;
+    Column<Node::ReceiveHandler> m_receiveHandlers;
+    std::deque<Node> m_nodes;
+    uint32_t m_nodeCount;
+
+    std::unordered_map<uint32_t, uint32_t> m_nodeIdLookup;
+    DeliveryHandler m_deliveryHandler;
+
+    Scheduler* m_scheduler;
+    LinkModel m_linkModel;
+    BandwidthModel m_bandwidthModel;
+    MessageArena m_inFlight;
 
-    // TODO (haigh) use this node id lookup to store a mapping between ipAddresses and node ids
-    std::unordered_map<uint32_t, int> m_nodeIdLookup;
+    std::shared_ptr<trace::TraceWriter> m_trace;
 };
 
 } // namespace odd::io::simulation
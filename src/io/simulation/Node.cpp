@@ -1,22 +1,12 @@
 #include "Node.h"
 
-namespace odd::io::simulation {
+#include "Network.h"
 
-Node::Node(int nodeId, uint32_t ipAddress, OnSendCallback onSendCallback)
-  : m_nodeId(nodeId),
-    m_ipAddress(ipAddress),
-    m_onSendCallback(std::move(onSendCallback))
-{
-}
+namespace odd::io::simulation {
 
-Node::Node(int nodeId,
-           uint32_t ipAddress,
-           OnSendCallback onSendCallback,
-           ReceiveHandler receiveHandler)
-  : m_nodeId(nodeId),
-    m_ipAddress(ipAddress),
-    m_onSendCallback(std::move(onSendCallback)),
-    m_receiveHandler(std::move(receiveHandler))
+Node::Node(Network& network, uint32_t index)
+  : m_network(&network),
+    m_index(index)
 {
 }
 
@@ -26,35 +16,34 @@ void Node::run()
 
 void Node::registerReceiveHandler(ReceiveHandler nodeReceiveHandler)
 {
-  m_receiveHandler = std::move(nodeReceiveHandler);
+  m_network->m_receiveHandlers[m_index] = std::move(nodeReceiveHandler);
 }
 
 void Node::cancelReceiveHandler()
 {
-  m_receiveHandler = nullptr;
+  m_network->m_receiveHandlers[m_index] = nullptr;
 }
 
 void Node::receiveMessage(uint32_t sourceIpAddress, uint8_t* message, size_t messageLength)
 {
-  if (m_receiveHandler)
-    m_receiveHandler(sourceIpAddress, message, messageLength);
+  m_network->deliver(sourceIpAddress, m_index, message, messageLength);
 }
 
 void Node::sendMessage(uint32_t destinationIpAddress,
                                 uint8_t* message,
                                 size_t messageLength) const
 {
-  m_onSendCallback(m_ipAddress, destinationIpAddress, message, messageLength);
+  m_network->sendMessage(ip(), destinationIpAddress, message, messageLength);
 }
 
 [[nodiscard]] int Node::nodeId() const
 {
-  return m_nodeId;
+  return static_cast<int>(m_index);
 }
 
 [[nodiscard]] uint32_t Node::ip() const
 {
-  return m_ipAddress;
+  return m_network->m_ipAddresses[m_index];
 }
 
 } // namespace odd::io::simulation
@@ -1,22 +1,24 @@
 #ifndef IO_SIMULATION_NODE_H_
 #define IO_SIMULATION_NODE_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 
 namespace odd::io::simulation {
 
+class Network;
+
+/*
+ * A handle to a node of a simulated network. The node's state is kept by the network, indexed by
+ * the node ID, which is the order the node was added in.
+ */
 class Node
 {
   public:
-    using OnSendCallback = std::function<void(uint32_t, uint32_t, uint8_t*, size_t)>;
     using ReceiveHandler = std::function<void(uint32_t, uint8_t*, size_t)>;
-    Node(int nodeId, uint32_t ipAddress, OnSendCallback onSendCallback);
 
-    Node(int nodeId,
-         uint32_t ipAddress,
-         OnSendCallback onSendCallback,
-         ReceiveHandler receiveHandler);
+    Node(Network& network, uint32_t index);
 
     void run();
 
@@ -36,10 +38,8 @@ class Node
     [[nodiscard]] uint32_t ip() const;
 
   private:
-    int m_nodeId;
-    uint32_t m_ipAddress;
-    OnSendCallback m_onSendCallback;
-    ReceiveHandler m_receiveHandler;
+    Network* m_network;
+    uint32_t m_index;
 };
 
 } // namespace odd::io::simulation
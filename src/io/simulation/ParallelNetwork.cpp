@@ -0,0 +1,279 @@
+#include "ParallelNetwork.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace odd::io::simulation {
+
+ParallelNetwork::ParallelNetwork(std::size_t partitions, LinkModel linkModel)
+  : m_linkModel(std::move(linkModel))
+{
+  for (std::size_t i = 0; i < std::max(partitions, std::size_t{ 1 }); i++)
+  {
+    m_partitions.push_back(std::make_unique<Partition>());
+  }
+}
+
+uint32_t ParallelNetwork::addNode(uint32_t ipAddress)
+{
+  auto nodeId = static_cast<uint32_t>(m_ipAddresses.size());
+
+  m_ipAddresses.push_back(ipAddress);
+  m_nodeIdLookup.emplace(ipAddress, nodeId);
+  partitionOf(nodeId).m_eventCounts.push_back(0);
+
+  return nodeId;
+}
+
+void ParallelNetwork::registerDeliveryHandler(DeliveryHandler deliveryHandler)
+{
+  m_deliveryHandler = std::move(deliveryHandler);
+}
+
+void ParallelNetwork::sendMessage(uint32_t sourceNodeId,
+                                  uint32_t destinationIpAddress,
+                                  const uint8_t* message,
+                                  size_t messageLength)
+{
+  auto destination = nodeId(destinationIpAddress);
+
+  if (destination == NO_NODE) return;
+
+  auto key = nextKey(sourceNodeId);
+  auto sourceIpAddress = m_ipAddresses[sourceNodeId];
+
+  // The draw is numbered by the sender's count, so it is the same whichever thread is sending
+  auto delay = m_linkModel.sample(sourceIpAddress, destinationIpAddress, key);
+
+  if (not delay) return;
+
+  auto at = now(sourceNodeId) + std::max(*delay, SimTime{ 1 });
+
+  auto& source = partitionOf(sourceNodeId);
+  auto& target = partitionOf(destination);
+
+  if (&source == &target)
+  {
+    scheduleDelivery(target, at, key, sourceIpAddress, destination, message, messageLength);
+    return;
+  }
+
+  target.m_mailbox.post(new Envelope{ nullptr,
+                                      at,
+                                      key,
+                                      sourceIpAddress,
+                                      destination,
+                                      std::vector<uint8_t>(message, message + messageLength) });
+}
+
+void ParallelNetwork::schedule(uint32_t nodeId, SimTime at, Callback callback)
+{
+  partitionOf(nodeId).m_scheduler.schedule(at, nextKey(nodeId), std::move(callback));
+}
+
+void ParallelNetwork::scheduleAfter(uint32_t nodeId, SimTime delay, Callback callback)
+{
+  schedule(nodeId, now(nodeId) + delay, std::move(callback));
+}
+
+[[nodiscard]] SimTime ParallelNetwork::now(uint32_t nodeId) const
+{
+  return partitionOf(nodeId).m_scheduler.now();
+}
+
+std::size_t ParallelNetwork::runUntil(SimTime end)
+{
+  m_lookahead = std::max(m_linkModel.minimumLatency(), SimTime{ 1 });
+  m_end = end;
+  m_finished = false;
+
+  auto participants = static_cast<std::ptrdiff_t>(m_partitions.size());
+  m_windowRun = std::make_unique<std::barrier<>>(participants);
+  m_windowPlanned = std::make_unique<std::barrier<PlanWindow>>(participants, PlanWindow{ this });
+
+  for (auto& partition : m_partitions)
+  {
+    partition->m_run = 0;
+  }
+
+  // The calling thread runs the first partition, a single partition runs without any threads
+  std::vector<std::thread> threads;
+
+  for (std::size_t i = 1; i < m_partitions.size(); i++)
+  {
+    threads.emplace_back([this, i] { runPartition(*m_partitions[i]); });
+  }
+
+  runPartition(*m_partitions.front());
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  m_now = std::max(m_now, end);
+
+  std::size_t run = 0;
+
+  for (const auto& partition : m_partitions)
+  {
+    run += partition->m_run;
+  }
+
+  return run;
+}
+
+std::size_t ParallelNetwork::runFor(SimTime duration)
+{
+  return runUntil(m_now + duration);
+}
+
+[[nodiscard]] SimTime ParallelNetwork::now() const
+{
+  return m_now;
+}
+
+[[nodiscard]] uint32_t ParallelNetwork::nodeId(uint32_t ipAddress) const
+{
+  auto it = m_nodeIdLookup.find(ipAddress);
+
+  return it == m_nodeIdLookup.end() ? NO_NODE : it->second;
+}
+
+[[nodiscard]] uint32_t ParallelNetwork::ip(uint32_t nodeId) const
+{
+  return m_ipAddresses[nodeId];
+}
+
+[[nodiscard]] std::size_t ParallelNetwork::size() const
+{
+  return m_ipAddresses.size();
+}
+
+[[nodiscard]] std::size_t ParallelNetwork::partitions() const
+{
+  return m_partitions.size();
+}
+
+[[nodiscard]] std::size_t ParallelNetwork::windows() const
+{
+  return m_windows;
+}
+
+[[nodiscard]] SimTime ParallelNetwork::lookahead() const
+{
+  return m_lookahead;
+}
+
+[[nodiscard]] LinkModel& ParallelNetwork::links()
+{
+  return m_linkModel;
+}
+
+[[nodiscard]] ParallelNetwork::Partition& ParallelNetwork::partitionOf(uint32_t nodeId) const
+{
+  return *m_partitions[nodeId % m_partitions.size()];
+}
+
+uint64_t ParallelNetwork::nextKey(uint32_t nodeId)
+{
+  auto& count = partitionOf(nodeId).m_eventCounts[nodeId / m_partitions.size()];
+
+  return (static_cast<uint64_t>(nodeId) << 32) | count++;
+}
+
+void ParallelNetwork::scheduleDelivery(Partition& partition,
+                                       SimTime at,
+                                       uint64_t key,
+                                       uint32_t sourceIpAddress,
+                                       uint32_t destinationNodeId,
+                                       const uint8_t* message,
+                                       size_t messageLength)
+{
+  auto handle = partition.m_inFlight.store(sourceIpAddress, destinationNodeId, message, messageLength);
+
+  partition.m_scheduler.schedule(at, key, [this, &partition, handle] { deliverInFlight(partition, handle); });
+}
+
+void ParallelNetwork::deliverInFlight(Partition& partition, MessageArena::Handle handle)
+{
+  const auto& inFlight = partition.m_inFlight.get(handle);
+
+  // The handler may send, which can grow the arena's table of messages, so copy the details out
+  auto* data = inFlight.m_data;
+  auto length = inFlight.m_length;
+  auto source = inFlight.m_sourceIpAddress;
+  auto destination = inFlight.m_destinationIndex;
+
+  if (m_deliveryHandler) m_deliveryHandler(destination, source, data, length);
+
+  partition.m_inFlight.release(handle);
+}
+
+void ParallelNetwork::takeMail(Partition& partition)
+{
+  for (auto* envelope = partition.m_mailbox.takeAll(); envelope != nullptr;)
+  {
+    // The scheduler orders them by their keys, so the order they were posted in does not matter
+    scheduleDelivery(partition,
+                     envelope->m_time,
+                     envelope->m_key,
+                     envelope->m_sourceIpAddress,
+                     envelope->m_destinationNodeId,
+                     envelope->m_message.data(),
+                     envelope->m_message.size());
+
+    auto* next = envelope->m_next;
+    delete envelope;
+    envelope = next;
+  }
+}
+
+void ParallelNetwork::runPartition(Partition& partition)
+{
+  for (;;)
+  {
+    takeMail(partition);
+    partition.m_nextTime = partition.m_scheduler.nextTime().value_or(SimTime::max());
+
+    m_windowPlanned->arrive_and_wait();
+
+    if (m_finished) break;
+
+    // Everything in the window is before the lookahead, so nothing another partition sends in it
+    partition.m_run += partition.m_scheduler.runUntil(m_windowEnd - SimTime{ 1 });
+
+    // The mail for the next window has all been posted once every partition has run this one
+    m_windowRun->arrive_and_wait();
+  }
+
+  // Only moves the clock on, everything up to the end has run
+  partition.m_scheduler.runUntil(m_end);
+}
+
+void ParallelNetwork::PlanWindow::operator()() noexcept
+{
+  m_network->planWindow();
+}
+
+void ParallelNetwork::planWindow()
+{
+  auto first = SimTime::max();
+
+  for (const auto& partition : m_partitions)
+  {
+    first = std::min(first, partition->m_nextTime);
+  }
+
+  if (first > m_end)
+  {
+    m_finished = true;
+    return;
+  }
+
+  m_windowEnd = std::min(first + m_lookahead, m_end + SimTime{ 1 });
+  m_windows++;
+}
+
+} // namespace odd::io::simulation
@@ -0,0 +1,162 @@
+#ifndef IO_SIMULATION_PARALLEL_NETWORK_H_
+#define IO_SIMULATION_PARALLEL_NETWORK_H_
+
+#include "LinkModel.h"
+#include "Mailbox.h"
+#include "MessageArena.h"
+#include "Scheduler.h"
+
+#include <barrier>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace odd::io::simulation {
+
+/*
+ * A scheduled network whose nodes are split between partitions that run on threads of their own.
+ * Node n belongs to partition n % partitions, and each partition has its own scheduler, so the
+ * events of a node, its timers and the messages delivered to it, only ever run on its partition's
+ * thread.
+ *
+ * The partitions are kept in step conservatively. No message takes less than the lookahead, the
+ * lowest latency of any link, so the events in the lookahead after the earliest pending event
+ * cannot be affected by any other partition's events in that window. Every partition runs the
+ * window, then they all wait for each other, take the messages the others posted to their lock
+ * free mailboxes and agree on the next window.
+ *
+ * A run gives the same result whatever the number of partitions. Events with the same time run in
+ * the order of the node that caused them and that node's count of events, rather than the order
+ * they were scheduled in, and a message's delay is the link model's draw numbered by that count.
+ * The delivery handler and the timers may only touch the state of the node they run for, which
+ * includes sending from it, nodes only affect each other through messages.
+ *
+ * Nodes are added, and the first events scheduled, before running. A message takes at least a
+ * nanosecond, so the lookahead is never zero.
+ */
+class ParallelNetwork
+{
+  public:
+    // Called with the destination's node ID, the source's ip address and the message
+    using DeliveryHandler = std::function<void(uint32_t, uint32_t, uint8_t*, size_t)>;
+    using Callback = std::function<void()>;
+
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+    explicit ParallelNetwork(std::size_t partitions, LinkModel linkModel = LinkModel{});
+    ParallelNetwork(const ParallelNetwork&) = delete;
+    ParallelNetwork& operator=(const ParallelNetwork&) = delete;
+
+    // Returns the node ID, which is the order the node was added in
+    uint32_t addNode(uint32_t ipAddress);
+
+    void registerDeliveryHandler(DeliveryHandler deliveryHandler);
+
+    // Sends from a node, from that node's events or before running
+    void sendMessage(uint32_t sourceNodeId, uint32_t destinationIpAddress, const uint8_t* message, size_t messageLength);
+
+    // A timer of a node, scheduled from that node's events or before running
+    void schedule(uint32_t nodeId, SimTime at, Callback callback);
+    void scheduleAfter(uint32_t nodeId, SimTime delay, Callback callback);
+
+    // The time of the node's partition, which is the time of the event being run in it
+    [[nodiscard]] SimTime now(uint32_t nodeId) const;
+
+    // Runs every event up to and including the end time, returns how many were run
+    std::size_t runUntil(SimTime end);
+    std::size_t runFor(SimTime duration);
+
+    [[nodiscard]] SimTime now() const;
+
+    // The node ID of the node with the address, or NO_NODE
+    [[nodiscard]] uint32_t nodeId(uint32_t ipAddress) const;
+    [[nodiscard]] uint32_t ip(uint32_t nodeId) const;
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t partitions() const;
+
+    // The number of windows the partitions have synchronised on
+    [[nodiscard]] std::size_t windows() const;
+
+    [[nodiscard]] SimTime lookahead() const;
+    [[nodiscard]] LinkModel& links();
+
+  private:
+    // A message for another partition's node
+    struct Envelope
+    {
+      Envelope* m_next;
+      SimTime m_time;
+      uint64_t m_key;
+      uint32_t m_sourceIpAddress;
+      uint32_t m_destinationNodeId;
+      std::vector<uint8_t> m_message;
+    };
+
+    struct Partition
+    {
+      Scheduler m_scheduler;
+      MessageArena m_inFlight;
+      Mailbox<Envelope> m_mailbox;
+
+      // The number of events each of the partition's nodes has caused, indexed by node ID / partitions
+      std::vector<uint32_t> m_eventCounts;
+
+      SimTime m_nextTime{ 0 };
+      std::size_t m_run = 0;
+    };
+
+    [[nodiscard]] Partition& partitionOf(uint32_t nodeId) const;
+
+    // The key of the next event a node causes
+    uint64_t nextKey(uint32_t nodeId);
+
+    void scheduleDelivery(Partition& partition,
+                          SimTime at,
+                          uint64_t key,
+                          uint32_t sourceIpAddress,
+                          uint32_t destinationNodeId,
+                          const uint8_t* message,
+                          size_t messageLength);
+
+    void deliverInFlight(Partition& partition, MessageArena::Handle handle);
+
+    // Schedules the messages the other partitions have posted to the partition
+    void takeMail(Partition& partition);
+
+    // Runs the windows up to the end on the partition's thread
+    void runPartition(Partition& partition);
+
+    // Run by the last partition to reach the start of a window, finds where the window ends
+    void planWindow();
+
+    struct PlanWindow
+    {
+      ParallelNetwork* m_network;
+
+      void operator()() noexcept;
+    };
+
+    std::vector<std::unique_ptr<Partition>> m_partitions;
+
+    std::vector<uint32_t> m_ipAddresses;
+    std::unordered_map<uint32_t, uint32_t> m_nodeIdLookup;
+    DeliveryHandler m_deliveryHandler;
+
+    LinkModel m_linkModel;
+    SimTime m_lookahead{ 1 };
+
+    SimTime m_now{ 0 };
+    SimTime m_end{ 0 };
+    SimTime m_windowEnd{ 0 };
+    std::unique_ptr<std::barrier<>> m_windowRun;
+    std::unique_ptr<std::barrier<PlanWindow>> m_windowPlanned;
+    bool m_finished = false;
+    std::size_t m_windows = 0;
+};
+
+} // namespace odd::io::simulation
+
+#endif // IO_SIMULATION_PARALLEL_NETWORK_H_
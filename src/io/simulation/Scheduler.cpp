@@ -0,0 +1,222 @@
+#include "Scheduler.h"
+
+#include <algorithm>
+
+namespace odd::io::simulation {
+
+Scheduler::Scheduler(SimTime bucketWidth)
+  : m_bucketWidth(std::max(bucketWidth, SimTime{ 1 })),
+    m_buckets(BUCKET_COUNT)
+{
+}
+
+[[nodiscard]] SimTime Scheduler::now() const
+{
+  return m_now;
+}
+
+EventId Scheduler::schedule(SimTime at, Callback callback)
+{
+  return schedule(at, m_nextSequence++, std::move(callback));
+}
+
+EventId Scheduler::schedule(SimTime at, uint64_t key, Callback callback)
+{
+  uint32_t slot;
+
+  if (m_freeSlots.empty())
+  {
+    slot = static_cast<uint32_t>(m_slots.size());
+    m_slots.emplace_back();
+  }
+  else
+  {
+    slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+  }
+
+  auto& entry = m_slots[slot];
+  entry.m_callback = std::move(callback);
+  entry.m_generation++;
+  entry.m_live = true;
+
+  insert(Event{ std::max(at, m_now), key, slot, entry.m_generation });
+  m_pending++;
+
+  // The generation starts at one, so an ID is never NO_EVENT
+  return (static_cast<EventId>(entry.m_generation) << 32) | slot;
+}
+
+EventId Scheduler::scheduleAfter(SimTime delay, Callback callback)
+{
+  return schedule(m_now + delay, std::move(callback));
+}
+
+void Scheduler::cancel(EventId id)
+{
+  auto slot = static_cast<uint32_t>(id);
+  auto generation = static_cast<uint32_t>(id >> 32);
+
+  if (slot >= m_slots.size() || not m_slots[slot].m_live || m_slots[slot].m_generation != generation) return;
+
+  m_slots[slot].m_callback = nullptr;
+  release(slot);
+}
+
+[[nodiscard]] bool Scheduler::isLive(const Event& event) const
+{
+  const auto& slot = m_slots[event.m_slot];
+
+  return slot.m_live && slot.m_generation == event.m_generation;
+}
+
+void Scheduler::release(uint32_t slot)
+{
+  m_slots[slot].m_live = false;
+  m_freeSlots.push_back(slot);
+  m_pending--;
+}
+
+void Scheduler::insert(const Event& event)
+{
+  if (event.m_time < m_readyStart + m_bucketWidth)
+  {
+    // Due in the bucket being run, after the events already there for the same time
+    auto position = std::upper_bound(m_ready.begin(), m_ready.end(), event, std::greater<Event>{});
+    m_ready.insert(position, event);
+  }
+  else if (event.m_time < m_readyStart + m_bucketWidth * BUCKET_COUNT)
+  {
+    m_buckets[bucketIndex(event.m_time)].push_back(event);
+    m_bucketed++;
+  }
+  else
+  {
+    m_overflow.push(event);
+  }
+}
+
+void Scheduler::refill()
+{
+  while (m_ready.empty() && (m_bucketed > 0 || not m_overflow.empty()))
+  {
+    if (m_bucketed == 0)
+    {
+      auto first = m_overflow.top().m_time;
+      m_readyStart = first - first % m_bucketWidth;
+    }
+    else
+    {
+      m_readyStart += m_bucketWidth;
+    }
+
+    // The ring has moved on, the heap's events that are now within it go into their buckets
+    auto ringEnd = m_readyStart + m_bucketWidth * BUCKET_COUNT;
+
+    while (not m_overflow.empty() && m_overflow.top().m_time < ringEnd)
+    {
+      m_buckets[bucketIndex(m_overflow.top().m_time)].push_back(m_overflow.top());
+      m_bucketed++;
+      m_overflow.pop();
+    }
+
+    auto& bucket = m_buckets[bucketIndex(m_readyStart)];
+
+    if (bucket.empty()) continue;
+
+    m_ready.swap(bucket);
+    m_bucketed -= m_ready.size();
+    std::sort(m_ready.begin(), m_ready.end(), std::greater<Event>{});
+  }
+}
+
+const Scheduler::Event* Scheduler::next()
+{
+  for (;;)
+  {
+    refill();
+
+    if (m_ready.empty()) return nullptr;
+
+    if (isLive(m_ready.back())) return &m_ready.back();
+
+    m_ready.pop_back();
+  }
+}
+
+[[nodiscard]] std::size_t Scheduler::bucketIndex(SimTime time) const
+{
+  return static_cast<std::size_t>(time / m_bucketWidth) % BUCKET_COUNT;
+}
+
+bool Scheduler::step()
+{
+  const auto* next = this->next();
+
+  if (next == nullptr) return false;
+
+  auto event = *next;
+  m_ready.pop_back();
+
+  // The callback may schedule or cancel events, which can reuse the slot, so take it out first
+  auto callback = std::move(m_slots[event.m_slot].m_callback);
+  release(event.m_slot);
+
+  m_now = event.m_time;
+  callback();
+
+  return true;
+}
+
+[[nodiscard]] std::optional<SimTime> Scheduler::nextTime()
+{
+  const auto* next = this->next();
+
+  if (next == nullptr) return std::nullopt;
+
+  return next->m_time;
+}
+
+std::size_t Scheduler::runUntil(SimTime end)
+{
+  std::size_t run = 0;
+
+  for (const auto* event = next(); event != nullptr && event->m_time <= end; event = next())
+  {
+    step();
+    run++;
+  }
+
+  m_now = std::max(m_now, end);
+
+  return run;
+}
+
+std::size_t Scheduler::runFor(SimTime duration)
+{
+  return runUntil(m_now + duration);
+}
+
+std::size_t Scheduler::run()
+{
+  std::size_t run = 0;
+
+  while (step())
+  {
+    run++;
+  }
+
+  return run;
+}
+
+[[nodiscard]] std::size_t Scheduler::pending() const
+{
+  return m_pending;
+}
+
+[[nodiscard]] bool Scheduler::empty() const
+{
+  return m_pending == 0;
+}
+
+} // namespace odd::io::simulation
@@ -0,0 +1,135 @@
+#ifndef IO_SIMULATION_SCHEDULER_H_
+#define IO_SIMULATION_SCHEDULER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <vector>
+
+namespace odd::io::simulation {
+
+// Virtual time, measured from the start of the simulation
+using SimTime = std::chrono::nanoseconds;
+
+using EventId = uint64_t;
+
+// Zero is never returned by schedule, so it can be used for "no event"
+static constexpr EventId NO_EVENT = 0;
+
+/*
+ * The event queue of a discrete event simulation. Events run in order of their time, and events
+ * with the same time in the order they were scheduled, so a run is deterministic. The clock jumps
+ * straight to the time of the next event, so idle periods cost nothing.
+ *
+ * The events are kept in a calendar queue: a ring of buckets, each covering one bucket width of
+ * time, for the events due within the next BUCKET_COUNT bucket widths, and a heap for the events
+ * after that. Only the bucket being run is sorted, so scheduling is constant time for most events
+ * and the events in flight in a large network are not all kept in one deep heap. When every bucket
+ * is empty the ring jumps straight to the first event in the heap.
+ *
+ * Callbacks are kept in slots that are reused once their event has run or been cancelled, an
+ * EventId is the slot and the number of times the slot has been used, so a stale ID cancels
+ * nothing. Cancelled events are skipped when they come up.
+ *
+ * The scheduler is not thread safe, the simulation runs on the thread that calls step/run.
+ */
+class Scheduler
+{
+  public:
+    using Callback = std::function<void()>;
+
+    static constexpr std::size_t BUCKET_COUNT = 4096;
+
+    // The bucket width should be around the spacing of the events, e.g. a fraction of the link jitter
+    explicit Scheduler(SimTime bucketWidth = std::chrono::microseconds{ 100 });
+
+    [[nodiscard]] SimTime now() const;
+
+    // An event scheduled in the past runs at the current time
+    EventId schedule(SimTime at, Callback callback);
+    EventId scheduleAfter(SimTime delay, Callback callback);
+
+    // Events with the same time run in the order of their keys rather than the order they were
+    // scheduled in, so the order does not depend on which of them was scheduled first. The keys
+    // should be unique, and a scheduler should use either keys or the order of scheduling
+    EventId schedule(SimTime at, uint64_t key, Callback callback);
+
+    void cancel(EventId id);
+
+    // Runs the next event, returns false if there are none
+    bool step();
+
+    // The time of the next event, if there is one
+    [[nodiscard]] std::optional<SimTime> nextTime();
+
+    // Runs every event up to and including the end time and leaves the clock at the end time,
+    // returns how many were run
+    std::size_t runUntil(SimTime end);
+    std::size_t runFor(SimTime duration);
+
+    // Runs until there are no events left
+    std::size_t run();
+
+    [[nodiscard]] std::size_t pending() const;
+    [[nodiscard]] bool empty() const;
+
+  private:
+    struct Event
+    {
+      SimTime m_time;
+
+      // The order of scheduling, or the caller's key
+      uint64_t m_sequence;
+      uint32_t m_slot;
+      uint32_t m_generation;
+
+      bool operator>(const Event& rhs) const
+      {
+        return m_time > rhs.m_time || (m_time == rhs.m_time && m_sequence > rhs.m_sequence);
+      }
+    };
+
+    struct Slot
+    {
+      Callback m_callback;
+      uint32_t m_generation = 0;
+      bool m_live = false;
+    };
+
+    [[nodiscard]] bool isLive(const Event& event) const;
+    void release(uint32_t slot);
+
+    void insert(const Event& event);
+
+    // Moves the ring on until the bucket being run has an event in it, or there are no events left
+    void refill();
+
+    // The next event that has not been cancelled, or nullptr if there are none
+    const Event* next();
+
+    [[nodiscard]] std::size_t bucketIndex(SimTime time) const;
+
+    const SimTime m_bucketWidth;
+
+    // The events of the bucket being run, sorted so that the next one is at the back
+    std::vector<Event> m_ready;
+    SimTime m_readyStart{ 0 };
+
+    std::vector<std::vector<Event>> m_buckets;
+    std::size_t m_bucketed = 0;
+
+    // The events after the ring
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> m_overflow;
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    std::size_t m_pending = 0;
+    uint64_t m_nextSequence = 0;
+    SimTime m_now{ 0 };
+};
+
+} // namespace odd::io::simulation
+
+#endif // IO_SIMULATION_SCHEDULER_H_
@@ -0,0 +1,97 @@
+#include "TraceReplay.h"
+
+#include <algorithm>
+
+namespace odd::io::simulation {
+
+TraceReplay::TraceReplay(Network& network, Scheduler& scheduler, trace::TraceReader& reader, ReplayConfig config)
+  : m_network(network),
+    m_scheduler(scheduler),
+    m_reader(reader),
+    m_config(config)
+{
+}
+
+void TraceReplay::start()
+{
+  m_start = m_scheduler.now();
+  m_started = false;
+  m_finished = false;
+
+  scheduleNext();
+}
+
+[[nodiscard]] bool TraceReplay::finished() const
+{
+  return m_finished;
+}
+
+[[nodiscard]] std::size_t TraceReplay::replayed() const
+{
+  return m_replayed;
+}
+
+[[nodiscard]] std::size_t TraceReplay::skipped() const
+{
+  return m_skipped;
+}
+
+[[nodiscard]] std::size_t TraceReplay::bytes() const
+{
+  return m_bytes;
+}
+
+void TraceReplay::scheduleNext()
+{
+  for (;;)
+  {
+    if (not m_reader.next(m_next))
+    {
+      m_finished = true;
+      return;
+    }
+
+    auto replayed = m_next.m_direction == trace::Direction::SENT ? m_config.m_replaySent : m_config.m_replayReceived;
+
+    if (replayed) break;
+  }
+
+  if (not m_started)
+  {
+    m_firstTimestamp = m_next.m_timestamp;
+    m_started = true;
+  }
+
+  auto offset = std::max(m_next.m_timestamp - m_firstTimestamp, std::chrono::nanoseconds{ 0 });
+  auto at = m_start + std::chrono::duration_cast<SimTime>(offset / std::max(m_config.m_speed, 1e-9));
+
+  m_scheduler.schedule(at, [this] { replay(); });
+}
+
+void TraceReplay::replay()
+{
+  auto destination = m_network.nodeId(m_next.m_destinationIpAddress);
+
+  if (destination == Network::NO_NODE)
+  {
+    m_skipped++;
+  }
+  else
+  {
+    if (m_next.m_direction == trace::Direction::SENT)
+    {
+      m_network.sendMessage(m_next.m_sourceIpAddress, m_next.m_destinationIpAddress, m_next.m_frame, m_next.m_length);
+    }
+    else
+    {
+      m_network.node(destination).receiveMessage(m_next.m_sourceIpAddress, m_next.m_frame, m_next.m_length);
+    }
+
+    m_replayed++;
+    m_bytes += m_next.m_length;
+  }
+
+  scheduleNext();
+}
+
+} // namespace odd::io::simulation
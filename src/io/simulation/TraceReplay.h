@@ -0,0 +1,72 @@
+#ifndef IO_SIMULATION_TRACE_REPLAY_H_
+#define IO_SIMULATION_TRACE_REPLAY_H_
+
+#include "Network.h"
+#include "Scheduler.h"
+#include "../trace/TraceReader.h"
+
+#include <cstddef>
+
+namespace odd::io::simulation {
+
+struct ReplayConfig
+{
+  // Above one replays the trace faster than it was captured, the gaps between frames are divided by it
+  double m_speed = 1.0;
+
+  // Sent frames go through the network, and its links, to their destinations. Received frames are
+  // handed straight to the node they were received by, which is how traces captured at a single
+  // node, that only know its side of the conversation, are replayed
+  bool m_replaySent = true;
+  bool m_replayReceived = false;
+};
+
+/*
+ * Feeds the frames of a trace into a scheduled network, at the times they were captured relative
+ * to the first frame. Frames are read one at a time as the replay reaches them, so a trace of any
+ * length replays in constant memory. Frames for addresses that are not in the network are skipped.
+ *
+ * The reader has to outlive the replay, the frames are delivered from its mapping of the file.
+ */
+class TraceReplay
+{
+  public:
+    TraceReplay(Network& network, Scheduler& scheduler, trace::TraceReader& reader, ReplayConfig config = {});
+
+    TraceReplay(const TraceReplay&) = delete;
+    TraceReplay& operator=(const TraceReplay&) = delete;
+
+    // Replays the first frame at the scheduler's current time
+    void start();
+
+    [[nodiscard]] bool finished() const;
+
+    [[nodiscard]] std::size_t replayed() const;
+    [[nodiscard]] std::size_t skipped() const;
+    [[nodiscard]] std::size_t bytes() const;
+
+  private:
+    // Reads on to the next frame that is replayed and schedules it
+    void scheduleNext();
+    void replay();
+
+    Network& m_network;
+    Scheduler& m_scheduler;
+    trace::TraceReader& m_reader;
+    const ReplayConfig m_config;
+
+    trace::TraceRecord m_next{};
+    bool m_finished = false;
+
+    SimTime m_start{ 0 };
+    std::chrono::nanoseconds m_firstTimestamp{ 0 };
+    bool m_started = false;
+
+    std::size_t m_replayed = 0;
+    std::size_t m_skipped = 0;
+    std::size_t m_bytes = 0;
+};
+
+} // namespace odd::io::simulation
+
+#endif // IO_SIMULATION_TRACE_REPLAY_H_
@@ -1,9 +1,20 @@
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
 #include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <thread>
+#include <vector>
+#include <unistd.h>
 
+#include <LinkModel.h>
+#include <MessageArena.h>
 #include <Network.h>
+#include <ParallelNetwork.h>
+#include <Scheduler.h>
+#include <TraceReplay.h>
 
 namespace odd::io::simulation {
 
@@ -60,5 +71,450 @@ TEST_CASE("Network simulator does not allow two nodes with the same address to b
 {
 }
 
-} // namespace odd::io::simulation
+TEST_CASE("Scheduler runs events in time order and the same time in the order they were scheduled")
+{
+  using namespace std::chrono_literals;
+
+  Scheduler scheduler;
+  std::vector<int> order;
+
+  scheduler.schedule(30ms, [&order] { order.push_back(3); });
+  scheduler.schedule(10ms, [&order] { order.push_back(1); });
+  scheduler.schedule(20ms, [&order] { order.push_back(2); });
+  scheduler.schedule(20ms, [&order] { order.push_back(22); });
+  auto cancelled = scheduler.schedule(15ms, [&order] { order.push_back(-1); });
+
+  scheduler.cancel(cancelled);
+
+  CHECK(scheduler.runUntil(20ms) == 3);
+  CHECK(scheduler.now() == 20ms);
+  CHECK(order == std::vector<int>{ 1, 2, 22 });
+
+  // An event can schedule another, which runs after the events already due at the same time
+  scheduler.schedule(30ms, [&scheduler, &order] { scheduler.scheduleAfter(0ms, [&order] { order.push_back(4); }); });
+
+  CHECK(scheduler.run() == 3);
+  CHECK(order == std::vector<int>{ 1, 2, 22, 3, 4 });
+  CHECK(scheduler.now() == 30ms);
+
+  // The clock moves on to the end of the period even when there is nothing to run
+  scheduler.runFor(1h);
+  CHECK(scheduler.now() == 1h + 30ms);
+  CHECK(scheduler.empty());
+}
+
+TEST_CASE("A scheduled network delivers messages after the link delay and drops the ones the link loses")
+{
+  using namespace std::chrono_literals;
+
+  Scheduler scheduler;
+  Network network{ scheduler, LinkModel{ 42, LinkProfile{ 5ms, 0ms, 0.0 } } };
+
+  std::vector<SimTime> receivedAt;
+
+  auto& node0 = network.addNode(0, [] (uint32_t, uint8_t*, size_t) {});
+  network.addNode(1, [&receivedAt, &scheduler] (uint32_t sourceIp, uint8_t* message, size_t messageLength)
+  {
+    CHECK(sourceIp == 0);
+    CHECK(messageLength == 3);
+    CHECK(message[2] == 7);
+    receivedAt.push_back(scheduler.now());
+  });
+  network.addNode(2, [] (uint32_t, uint8_t*, size_t) { FAIL("the link to node 2 loses everything"); });
+
+  network.links().setLink(0, 2, LinkProfile{ 1ms, 0ms, 1.0 });
+
+  {
+    uint8_t message[3] = { 0, 0, 7 };
+    node0.sendMessage(1, message, sizeof(message));
+    node0.sendMessage(2, message, sizeof(message));
+
+    // Nothing arrives until the scheduler runs, and the sender's buffer can be reused meanwhile
+    message[2] = 0;
+  }
+
+  CHECK(receivedAt.empty());
+
+  scheduler.run();
+
+  CHECK(receivedAt == std::vector<SimTime>{ 5ms });
+}
+
+TEST_CASE("A trace of a simulated network replays into another at a faster speed")
+{
+  using namespace std::chrono_literals;
+
+  auto path = (std::filesystem::temp_directory_path() / ("odd-replay-" + std::to_string(getpid()) + ".trace")).string();
+
+  {
+    Scheduler scheduler;
+    Network network{ scheduler, LinkModel{ 42, LinkProfile{ 5ms, 0ms, 0.0 } } };
+    network.setTrace(trace::TraceWriter::create(path, 256));
+
+    auto& node0 = network.addNode(1, [] (uint32_t, uint8_t*, size_t) {});
+    network.addNode(2, [] (uint32_t, uint8_t*, size_t) {});
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      scheduler.schedule(10ms * i, [&node0, i]
+      {
+        uint8_t message[2] = { 9, i };
+        node0.sendMessage(2, message, sizeof(message));
+      });
+    }
+
+    scheduler.run();
+  }
+
+  auto reader = trace::TraceReader::open(path);
+  REQUIRE(reader);
+
+  std::vector<SimTime> sentAt;
+  std::vector<SimTime> receivedAt;
+  trace::TraceRecord record{};
+
+  while (reader->next(record))
+  {
+    CHECK(record.m_sourceIpAddress == 1);
+    CHECK(record.m_destinationIpAddress == 2);
+    (record.m_direction == trace::Direction::SENT ? sentAt : receivedAt).push_back(record.m_timestamp);
+  }
+
+  CHECK(sentAt == std::vector<SimTime>{ 0ms, 10ms, 20ms });
+  CHECK(receivedAt == std::vector<SimTime>{ 5ms, 15ms, 25ms });
+
+  for (auto replayReceived : { false, true })
+  {
+    reader->rewind();
+
+    Scheduler scheduler;
+    Network network{ scheduler, LinkModel{ 42, LinkProfile{ 5ms, 0ms, 0.0 } } };
+
+    std::vector<SimTime> deliveredAt;
+
+    network.addNode(1, [] (uint32_t, uint8_t*, size_t) {});
+    network.addNode(2, [&] (uint32_t sourceIp, uint8_t* message, size_t messageLength)
+    {
+      CHECK(sourceIp == 1);
+      REQUIRE(messageLength == 2);
+      CHECK(message[1] == deliveredAt.size());
+      deliveredAt.push_back(scheduler.now());
+    });
+
+    scheduler.runUntil(1s);
+
+    TraceReplay replay{ network, scheduler, *reader, ReplayConfig{ 2.0, not replayReceived, replayReceived } };
+    replay.start();
+    scheduler.run();
+
+    CHECK(replay.finished());
+    CHECK(replay.replayed() == 3);
+
+    // Sent frames cross the link again, received frames are handed straight to the node
+    auto latency = replayReceived ? 0ms : 5ms;
+    CHECK(deliveredAt == std::vector<SimTime>{ 1s + latency, 1s + 5ms + latency, 1s + 10ms + latency });
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Messages queue for their nodes' uplinks and downlinks and a full queue drops them")
+{
+  using namespace std::chrono_literals;
+
+  Scheduler scheduler;
+  Network network{ scheduler, LinkModel{ 42, LinkProfile{ 5ms, 0ms, 0.0 } } };
+
+  std::vector<SimTime> receivedAt;
+  auto receive = [&receivedAt, &scheduler] (uint32_t, uint8_t*, size_t) { receivedAt.push_back(scheduler.now()); };
+
+  auto& node0 = network.addNode(0, [] (uint32_t, uint8_t*, size_t) {});
+  auto& node1 = network.addNode(1, [] (uint32_t, uint8_t*, size_t) {});
+  network.addNode(2, receive);
+  network.addNode(3, receive);
+
+  std::vector<uint8_t> message(100, 0);
+
+  SECTION("The uplink sends one message after another")
+  {
+    // 100 bytes take 100ms, and the queue holds the one being sent and one more
+    network.bandwidth().setNode(0, NodeCapacity{ 1000.0, 0.0, 250 });
+
+    for (int i = 0; i < 3; i++)
+    {
+      node0.sendMessage(2, message.data(), message.size());
+    }
+
+    // Other nodes' uplinks are not held up
+    node1.sendMessage(3, message.data(), message.size());
+
+    scheduler.run();
+
+    CHECK(receivedAt == std::vector<SimTime>{ 5ms, 105ms, 205ms });
+    CHECK(network.bandwidth().dropped() == 1);
+    CHECK(network.bandwidth().meanQueueingDelay() == 50ms);
+  }
+
+  SECTION("The downlink receives one message after another")
+  {
+    network.bandwidth().setNode(2, NodeCapacity{ 0.0, 1000.0, 0 });
+
+    node0.sendMessage(2, message.data(), message.size());
+    node1.sendMessage(2, message.data(), message.size());
+    node0.sendMessage(3, message.data(), message.size());
+
+    scheduler.run();
+
+    CHECK(receivedAt == std::vector<SimTime>{ 5ms, 105ms, 205ms });
+    CHECK(network.bandwidth().dropped() == 0);
+  }
+}
+
+TEST_CASE("Link jitter stays within its bounds and is the same for the same seed")
+{
+  using namespace std::chrono_literals;
+
+  LinkModel first{ 7, LinkProfile{ 10ms, 4ms, 0.25 } };
+  LinkModel second{ 7, LinkProfile{ 10ms, 4ms, 0.25 } };
+
+  std::size_t lost = 0;
+
+  for (int i = 0; i < 10000; i++)
+  {
+    auto delay = first.sample(0, 1);
+
+    CHECK(delay == second.sample(0, 1));
+
+    if (not delay)
+    {
+      lost++;
+      continue;
+    }
+
+    CHECK(*delay >= 10ms);
+    CHECK(*delay <= 14ms);
+  }
+
+  CHECK(lost > 2000);
+  CHECK(lost < 3000);
+}
+
+TEST_CASE("Hours of simulated traffic are delivered and lost at the link model's rates")
+{
+  using namespace std::chrono_literals;
 
+  Scheduler scheduler;
+  Network network{ scheduler, LinkModel{ 1, LinkProfile{ 20ms, 10ms, 0.01 } } };
+
+  constexpr uint32_t nodeCount = 16;
+  std::vector<Node*> nodes;
+  std::size_t received = 0;
+
+  for (uint32_t ip = 0; ip < nodeCount; ip++)
+  {
+    nodes.push_back(&network.addNode(ip, [&received] (uint32_t, uint8_t*, size_t) { received++; }));
+  }
+
+  // Every node sends a message to the next one every second
+  std::function<void(uint32_t)> tick = [&] (uint32_t ip)
+  {
+    uint8_t message[8] = {};
+    nodes[ip]->sendMessage((ip + 1) % nodeCount, message, sizeof(message));
+    scheduler.scheduleAfter(1s, [&tick, ip] { tick(ip); });
+  };
+
+  for (uint32_t ip = 0; ip < nodeCount; ip++)
+  {
+    scheduler.schedule(0s, [&tick, ip] { tick(ip); });
+  }
+
+  scheduler.runUntil(3h);
+
+  CHECK(scheduler.now() == 3h);
+
+  // About 1% of the 16 * 3 * 3600 messages are lost
+  CHECK(received > 16 * 3 * 3600 * 97 / 100);
+  CHECK(received < 16 * 3 * 3600);
+}
+
+TEST_CASE("MessageArena reuses the buffers of delivered messages")
+{
+  MessageArena arena;
+
+  std::vector<uint8_t> small(40, 1);
+  std::vector<uint8_t> large(1000, 2);
+  std::vector<uint8_t> oversized(100000, 3);
+
+  auto first = arena.store(1, 2, small.data(), small.size());
+  auto second = arena.store(3, 4, large.data(), large.size());
+  auto third = arena.store(5, 6, oversized.data(), oversized.size());
+
+  CHECK(arena.inFlight() == 3);
+  CHECK(arena.get(first).m_length == 40);
+  CHECK(arena.get(first).m_sourceIpAddress == 1);
+  CHECK(arena.get(second).m_destinationIndex == 4);
+  CHECK(arena.get(second).m_data[999] == 2);
+  CHECK(arena.get(third).m_data[99999] == 3);
+
+  auto* firstBuffer = arena.get(first).m_data;
+  auto reserved = arena.reservedBytes();
+
+  arena.release(first);
+  arena.release(third);
+
+  CHECK(arena.inFlight() == 1);
+  CHECK(arena.reservedBytes() == reserved - oversized.size());
+
+  // The same size class gets the same buffer back, and nothing new is allocated
+  auto fourth = arena.store(7, 8, small.data(), 64);
+
+  CHECK(arena.get(fourth).m_data == firstBuffer);
+  CHECK(arena.reservedBytes() == reserved - oversized.size());
+}
+
+TEST_CASE("A million node network delivers a message to every node")
+{
+  using namespace std::chrono_literals;
+
+  constexpr uint32_t nodeCount = 1000000;
+
+  Scheduler scheduler;
+  Network network{ scheduler, LinkModel{ 3, LinkProfile{ 10ms, 5ms, 0.0 } } };
+
+  // The per node state of the simulation is its own array, the nodes only have an address
+  std::vector<uint32_t> received(nodeCount, 0);
+
+  network.registerDeliveryHandler([&] (uint32_t nodeId, uint32_t, uint8_t* message, size_t messageLength)
+  {
+    received[nodeId]++;
+
+    // Every message is passed on once around the ring
+    if (message[0] == 0)
+    {
+      message[0] = 1;
+      network.sendMessage(network.node(nodeId).ip(), (network.node(nodeId).ip() + 1) % nodeCount, message, messageLength);
+    }
+  });
+
+  for (uint32_t ip = 0; ip < nodeCount; ip++)
+  {
+    network.addNode(ip);
+  }
+
+  CHECK(network.size() == nodeCount);
+  CHECK(network.nodeId(nodeCount - 1) == nodeCount - 1);
+  CHECK(network.nodeId(nodeCount) == Network::NO_NODE);
+
+  for (uint32_t ip = 0; ip < nodeCount; ip++)
+  {
+    uint8_t message[32] = {};
+    network.node(ip).sendMessage((ip + 1) % nodeCount, message, sizeof(message));
+  }
+
+  auto delivered = scheduler.run();
+
+  CHECK(delivered == 2 * nodeCount);
+  CHECK(std::all_of(received.begin(), received.end(), [] (uint32_t count) { return count == 2; }));
+  CHECK(network.inFlight().inFlight() == 0);
+}
+
+namespace {
+
+uint64_t mix(uint64_t value)
+{
+  value = (value ^ (value >> 33)) * 0xff51afd7ed558ccd;
+  return value ^ (value >> 33);
+}
+
+struct GossipResult
+{
+  std::size_t m_events;
+  std::vector<uint64_t> m_digests;
+};
+
+// Every node gossips to nodes picked from what it has received, so any difference in the order or
+// timing of a delivery changes where the later messages go
+GossipResult gossip(std::size_t partitions, uint32_t nodeCount)
+{
+  using namespace std::chrono_literals;
+
+  ParallelNetwork network{ partitions, LinkModel{ 7, LinkProfile{ 5ms, 20ms, 0.01 } } };
+  network.links().setLink(0, 1, LinkProfile{ 2ms, 0ms, 0.0 });
+
+  std::vector<uint64_t> digests(nodeCount, 0);
+
+  network.registerDeliveryHandler([&] (uint32_t nodeId, uint32_t sourceIp, uint8_t* message, size_t)
+  {
+    auto& digest = digests[nodeId];
+    digest = mix(digest ^ static_cast<uint64_t>(network.now(nodeId).count()) ^ (uint64_t{ sourceIp } << 32) ^ message[0]);
+
+    if (message[0] > 0)
+    {
+      message[0]--;
+      network.sendMessage(nodeId, static_cast<uint32_t>(digest % nodeCount), message, 1);
+    }
+  });
+
+  for (uint32_t ip = 0; ip < nodeCount; ip++)
+  {
+    network.addNode(ip);
+  }
+
+  std::function<void(uint32_t)> tick = [&] (uint32_t nodeId)
+  {
+    uint8_t message[1] = { 4 };
+    network.sendMessage(nodeId, static_cast<uint32_t>(mix(digests[nodeId] + nodeId) % nodeCount), message, 1);
+    network.scheduleAfter(nodeId, 1s, [&tick, nodeId] { tick(nodeId); });
+  };
+
+  for (uint32_t nodeId = 0; nodeId < nodeCount; nodeId++)
+  {
+    network.schedule(nodeId, SimTime{ mix(nodeId) % 1000000000 }, [&tick, nodeId] { tick(nodeId); });
+  }
+
+  auto events = network.runFor(5s);
+  events += network.runFor(5s);
+
+  CHECK(network.now() == 10s);
+  CHECK(network.lookahead() == 2ms);
+
+  return GossipResult{ events, digests };
+}
+
+} // namespace
+
+TEST_CASE("A partitioned network gives the same result on one thread and on several")
+{
+  constexpr uint32_t nodeCount = 20000;
+
+  auto single = gossip(1, nodeCount);
+
+  // Ten ticks of every node, each followed by a gossip of up to five deliveries
+  CHECK(single.m_events > nodeCount * 10 * 5);
+  CHECK(single.m_events < nodeCount * 11 * 6);
+
+  for (std::size_t partitions : { 4, 7 })
+  {
+    auto partitioned = gossip(partitions, nodeCount);
+
+    CHECK(partitioned.m_events == single.m_events);
+    CHECK(partitioned.m_digests == single.m_digests);
+  }
+}
+
+// Not run by default, run with NetworkSimulationTests "[benchmark]" to see how the partitions scale
+TEST_CASE("A partitioned network's run time by the number of partitions", "[.][benchmark]")
+{
+  constexpr uint32_t nodeCount = 100000;
+
+  for (std::size_t partitions = 1; partitions <= std::max(1u, std::thread::hardware_concurrency()); partitions *= 2)
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto result = gossip(partitions, nodeCount);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    std::cout << partitions << " partitions: " << result.m_events << " events in " << elapsed.count() << " s" << std::endl;
+  }
+}
+
+} // namespace odd::io::simulation
@@ -1,4 +1,5 @@
 #include <arpa/inet.h>
+#include <cerrno>
 #include <iostream>
 #include <sys/socket.h>
 #include <memory>
@@ -11,10 +12,12 @@
 namespace odd::io::tcp {
 
 Acceptor::Acceptor(std::string ipAddress,
-                               uint16_t portNumber,
-                               ClientManager* clientManager)
-  : m_fd(socket(AF_INET, SOCK_STREAM, 0)),
+                   uint16_t portNumber,
+                   ClientManager* clientManager,
+                   std::size_t acceptBatchSize)
+  : m_fd(socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)),
     m_clientManager(clientManager),
+    m_acceptBatchSize(acceptBatchSize),
     m_running(false)
 {
   m_address.sin_family = AF_INET;
@@ -23,10 +26,12 @@ Acceptor::Acceptor(std::string ipAddress,
 }
 
 Acceptor::Acceptor(uint32_t ipAddress,
-                               uint16_t portNumber,
-                               ClientManager* clientManager)
-  : m_fd(socket(AF_INET, SOCK_STREAM, 0)),
+                   uint16_t portNumber,
+                   ClientManager* clientManager,
+                   std::size_t acceptBatchSize)
+  : m_fd(socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)),
     m_clientManager(clientManager),
+    m_acceptBatchSize(acceptBatchSize),
     m_running(false)
 {
   m_address.sin_family = AF_INET;
@@ -37,6 +42,11 @@ Acceptor::Acceptor(uint32_t ipAddress,
 Acceptor::~Acceptor()
 {
   stop();
+
+  if (m_fd >= 0)
+  {
+    close(m_fd);
+  }
 }
 
 void Acceptor::start()
@@ -94,6 +104,44 @@ void Acceptor::stop()
   }
 }
 
+int Acceptor::fd() const
+{
+  return m_fd;
+}
+
+std::size_t Acceptor::acceptClients()
+{
+  std::size_t accepted = 0;
+
+  // Refused connections count towards the batch as well, so that a flood of connections from a
+  // source which is over its limit still yields back to the owner of the socket.
+  for (std::size_t attempt = 0; attempt < m_acceptBatchSize; attempt++)
+  {
+    sockaddr_in client;
+    socklen_t clientSize = sizeof(client);
+
+    int clientFD = accept4(m_fd, (struct sockaddr*) &client, &clientSize, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+    if (clientFD == -1)
+    {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+      {
+        std::cerr << "Could not accept client" << std::endl;
+      }
+      break;
+    }
+
+    if (m_clientManager->processNewClient(clientFD, client, clientSize))
+    {
+      accepted++;
+    }
+  }
+
+  return accepted;
+}
+
 void Acceptor::clientAcceptorThreadFn()
 {
   fd_set listenSet;
@@ -104,12 +152,9 @@ void Acceptor::clientAcceptorThreadFn()
     FD_ZERO(&listenSet);
     FD_SET(m_fd, &listenSet);
 
-    // Accept a call
-    sockaddr_in client;
-    socklen_t clientSize = sizeof(client);
-
     timeval timeout;
     timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
 
     int socketCount = select(m_fd + 1, &listenSet, nullptr, nullptr, &timeout);
 
@@ -118,25 +163,7 @@ void Acceptor::clientAcceptorThreadFn()
       continue;
     }
 
-    int clientFD = accept(m_fd, (struct sockaddr*) &client, &clientSize);
-
-    if (clientFD == -1)
-    {
-      // TODO (haigh) This is a hack to get around the fact that accept() is blocking
-      // and we want to be able to stop the thread.  We should probably use select()
-      // or something similar to make this non-blocking.
-      if (errno == EAGAIN || errno == EWOULDBLOCK)
-      {
-        continue;
-      }
-      else
-      {
-        std::cerr << "Could not accept client" << std::endl;
-        return;
-      }
-    }
-
-    m_clientManager->processNewClient(std::make_unique<ClientRecord>(clientFD, client, clientSize));
+    acceptClients();
   }
 
   std::cout << "Acceptor thread exiting" << std::endl;
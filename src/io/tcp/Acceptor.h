@@ -13,21 +13,37 @@ namespace odd::io::tcp {
 class Acceptor
 {
   public:
-    Acceptor(std::string ipAddress, uint16_t portNumber, ClientManager* clientManager);
-    Acceptor(uint32_t ipAddress, uint16_t portNumber, ClientManager* clientManager);
+    Acceptor(std::string ipAddress,
+             uint16_t portNumber,
+             ClientManager* clientManager,
+             std::size_t acceptBatchSize = 64);
+    Acceptor(uint32_t ipAddress,
+             uint16_t portNumber,
+             ClientManager* clientManager,
+             std::size_t acceptBatchSize = 64);
     ~Acceptor();
 
     void start();
     void stop();
 
-  private:
+    // Opens the listening socket without starting the acceptor thread, this allows the socket to be
+    // polled by the owner (e.g. a Reactor) which then calls acceptClients when it is readable.
     bool startListening();
+
+    // The listening socket is non-blocking, this drains up to acceptBatchSize connections from the
+    // backlog and returns the number that were accepted.
+    std::size_t acceptClients();
+
+    [[nodiscard]] int fd() const;
+
+  private:
     void clientAcceptorThreadFn();
 
     int m_fd;
     sockaddr_in m_address;
     std::thread m_clientAcceptorThread;
     ClientManager* m_clientManager;
+    const std::size_t m_acceptBatchSize;
     std::atomic<bool> m_running;
 };
 
@@ -0,0 +1,57 @@
+#include "AdmissionControl.h"
+
+namespace odd::io::tcp {
+
+AdmissionControl::AdmissionControl(AdmissionLimits limits)
+  : m_limits(limits),
+    m_connectionCount(0)
+{
+}
+
+bool AdmissionControl::tryAdmit(uint32_t sourceIpAddress)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (m_connectionCount >= m_limits.m_maxConnections) return false;
+
+  auto& sourceCount = m_connectionsPerSource[sourceIpAddress];
+
+  if (sourceCount >= m_limits.m_maxConnectionsPerSource)
+  {
+    if (sourceCount == 0) m_connectionsPerSource.erase(sourceIpAddress);
+    return false;
+  }
+
+  sourceCount++;
+  m_connectionCount++;
+  return true;
+}
+
+void AdmissionControl::release(uint32_t sourceIpAddress)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_connectionsPerSource.find(sourceIpAddress);
+
+  if (it == m_connectionsPerSource.end()) return;
+
+  if (--it->second == 0)
+  {
+    m_connectionsPerSource.erase(it);
+  }
+
+  m_connectionCount--;
+}
+
+std::size_t AdmissionControl::connectionCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_connectionCount;
+}
+
+const AdmissionLimits& AdmissionControl::limits() const
+{
+  return m_limits;
+}
+
+} // namespace odd::io::tcp
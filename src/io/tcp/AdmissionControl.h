@@ -0,0 +1,46 @@
+#ifndef IO_TCP_ADMISSION_CONTROL_H_
+#define IO_TCP_ADMISSION_CONTROL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace odd::io::tcp {
+
+struct AdmissionLimits
+{
+  std::size_t m_maxConnections = 4096;
+  std::size_t m_maxConnectionsPerSource = 64;
+
+  // The maximum number of connections accepted from the backlog each time the listening socket
+  // becomes readable, this stops a burst of connections from starving already connected clients.
+  std::size_t m_acceptBatchSize = 64;
+};
+
+/*
+ * Tracks the number of open connections, in total and per source address, so that new connections
+ * can be refused once either limit is reached. A single instance is shared by every Reactor of a
+ * Server, so the limits apply to the server as a whole.
+ */
+class AdmissionControl
+{
+  public:
+    explicit AdmissionControl(AdmissionLimits limits = {});
+
+    bool tryAdmit(uint32_t sourceIpAddress);
+    void release(uint32_t sourceIpAddress);
+
+    [[nodiscard]] std::size_t connectionCount() const;
+    [[nodiscard]] const AdmissionLimits& limits() const;
+
+  private:
+    const AdmissionLimits m_limits;
+    mutable std::mutex m_mutex;
+    std::size_t m_connectionCount;
+    std::unordered_map<uint32_t, std::size_t> m_connectionsPerSource;
+};
+
+} // namespace odd::io::tcp
+
+#endif // IO_TCP_ADMISSION_CONTROL_H_
@@ -11,29 +11,44 @@ ClientRecord::ClientRecord(int fd, sockaddr_in socketAddress, socklen_t addressL
     m_socketAddress(socketAddress),
     m_socketAddressLength(addressLength)
 {
-  char address[NI_MAXHOST];
-  inet_ntop(AF_INET, &m_socketAddress.sin_addr, address, NI_MAXHOST);
-  m_name = std::string{address} + ":" + std::to_string(ntohs(m_socketAddress.sin_port));
 }
 
 const std::string ClientRecord::socketName()
 {
-  return m_name;
+  return static_cast<const ClientRecord&>(*this).socketName();
 }
 
 const std::string& ClientRecord::socketName() const
 {
+  if (m_name.empty())
+  {
+    char address[NI_MAXHOST];
+    inet_ntop(AF_INET, &m_socketAddress.sin_addr, address, NI_MAXHOST);
+    m_name = std::string{address} + ":" + std::to_string(ntohs(m_socketAddress.sin_port));
+  }
+
   return m_name;
 }
 
-void ClientManager::processNewClient(std::unique_ptr<ClientRecord> client)
+ClientManager::ClientManager(AdmissionControl* admissionControl)
+  : m_admissionControl(admissionControl)
+{
+}
+
+bool ClientManager::processNewClient(int fd, const sockaddr_in& socketAddress, socklen_t addressLength)
 {
+  if (m_admissionControl && not m_admissionControl->tryAdmit(socketAddress.sin_addr.s_addr))
+  {
+    close(fd);
+    return false;
+  }
+
   std::lock_guard<std::mutex> lock(m_mutex);
 
-  std::cout << "New client connected: " << client->socketName() << std::endl;
-  m_clients.emplace(client->m_fd, std::move(client));
+  m_clients.try_emplace(fd, fd, socketAddress, addressLength);
 
   m_conditionVariable.notify_one();
+  return true;
 }
 
 void ClientManager::processClientDisconnecion(int fd)
@@ -48,6 +63,11 @@ void ClientManager::processClientDisconnecion(int fd)
     return;
   }
 
+  if (m_admissionControl)
+  {
+    m_admissionControl->release(data->second.m_socketAddress.sin_addr.s_addr);
+  }
+
   m_clients.erase(data);
   close(fd);
 
@@ -76,7 +96,7 @@ std::string ClientManager::getClientName(int fd)
 
   if (data != m_clients.end())
   {
-    return data->second->socketName();
+    return data->second.socketName();
   }
 
   return "Unknown client";
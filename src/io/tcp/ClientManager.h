@@ -9,6 +9,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "AdmissionControl.h"
+
 namespace odd::io::tcp {
 
 class ClientRecord
@@ -16,19 +18,23 @@ class ClientRecord
   public:
     ClientRecord(int fd, sockaddr_in socketAddress, socklen_t addressLength);
 
+    // The name is formatted the first time it is asked for, rather than for every connection.
     const std::string socketName();
     const std::string& socketName() const;
 
     int m_fd;
     sockaddr_in m_socketAddress;
     socklen_t m_socketAddressLength;
-    std::string m_name;
+    mutable std::string m_name;
 };
 
 class ClientManager
 {
   public:
-    void processNewClient(std::unique_ptr<ClientRecord> client);
+    explicit ClientManager(AdmissionControl* admissionControl = nullptr);
+
+    // Returns false, and closes the socket, if the client is refused by the admission control.
+    bool processNewClient(int clientFD, const sockaddr_in& socketAddress, socklen_t addressLength);
 
     void processClientDisconnecion(int clientFD);
 
@@ -39,12 +45,12 @@ class ClientManager
     std::string getClientName(int clientFD);
 
   private:
+    AdmissionControl* m_admissionControl;
     std::mutex m_mutex;
     std::condition_variable m_conditionVariable;
-    std::unordered_map<int, std::unique_ptr<ClientRecord>> m_clients;
+    std::unordered_map<int, ClientRecord> m_clients;
 };
 
 } // namespace odd::io::tcp
 
 #endif // IO_TCP_CLIENT_MANAGER_H_
-
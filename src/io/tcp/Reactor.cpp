@@ -0,0 +1,115 @@
+#include "Reactor.h"
+
+#include <cerrno>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+
+namespace odd::io::tcp {
+
+Reactor::Reactor(uint32_t ipAddress,
+                 uint16_t portNumber,
+                 const std::vector<OnReceiveCallback>& subscribers,
+                 AdmissionControl* admissionControl)
+  : m_clientManager{admissionControl},
+    m_acceptor{ipAddress,
+               portNumber,
+               &m_clientManager,
+               admissionControl ? admissionControl->limits().m_acceptBatchSize : AdmissionLimits{}.m_acceptBatchSize},
+    m_subscribers(subscribers),
+    m_running(false)
+{
+}
+
+Reactor::~Reactor()
+{
+  stop();
+}
+
+bool Reactor::start()
+{
+  if (not m_acceptor.startListening())
+  {
+    std::cerr << "Reactor could not start listening" << std::endl;
+    return false;
+  }
+
+  m_running = true;
+  m_thread = std::thread{&Reactor::threadFunction, this};
+  return true;
+}
+
+void Reactor::stop()
+{
+  if (m_running)
+  {
+    m_running = false;
+    m_thread.join();
+  }
+}
+
+std::vector<int> Reactor::getAllClientFds()
+{
+  return m_clientManager.getAllClientFds();
+}
+
+void Reactor::threadFunction()
+{
+  std::vector<pollfd> pollFds;
+
+  while (m_running)
+  {
+    pollFds.clear();
+    pollFds.push_back(pollfd{ m_acceptor.fd(), POLLIN, 0 });
+
+    for (const auto& fd : m_clientManager.getAllClientFds())
+    {
+      pollFds.push_back(pollfd{ fd, POLLIN, 0 });
+    }
+
+    int socketCount = poll(pollFds.data(), pollFds.size(), 1000);
+
+    if (socketCount <= 0)
+    {
+      continue;
+    }
+
+    // Service the existing clients before accepting new ones so that a burst of connections does
+    // not delay messages from clients that are already connected.
+    for (std::size_t i = 1; i < pollFds.size(); i++)
+    {
+      if (pollFds[i].revents & (POLLIN | POLLHUP | POLLERR))
+      {
+        receiveFromClient(pollFds[i].fd);
+      }
+    }
+
+    if (pollFds[0].revents & POLLIN)
+    {
+      m_acceptor.acceptClients();
+    }
+  }
+}
+
+void Reactor::receiveFromClient(int fd)
+{
+  uint8_t messageBuffer[4096];
+
+  auto bytesIn = recv(fd, messageBuffer, sizeof(messageBuffer), 0);
+
+  // Accepted sockets are non-blocking, so a spurious wakeup is not a disconnection.
+  if (bytesIn < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return;
+
+  if (bytesIn <= 0)
+  {
+    m_clientManager.processClientDisconnecion(fd);
+    return;
+  }
+
+  for (const auto& subscriber : m_subscribers)
+  {
+    subscriber(messageBuffer, static_cast<std::size_t>(bytesIn));
+  }
+}
+
+} // namespace odd::io::tcp
@@ -0,0 +1,53 @@
+#ifndef IO_TCP_REACTOR_H_
+#define IO_TCP_REACTOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "Acceptor.h"
+#include "AdmissionControl.h"
+#include "ClientManager.h"
+#include "Types.h"
+
+/*
+ * A Reactor is a single thread that owns a listening socket and the set of clients accepted on it.
+ * The listening socket is bound with SO_REUSEPORT, so several Reactors can listen on the same port
+ * and the kernel will distribute incoming connections between them. Received messages are passed
+ * to the subscribers on the Reactor's own thread, there is no handoff to another thread.
+ */
+
+namespace odd::io::tcp {
+
+class Reactor
+{
+  public:
+    Reactor(uint32_t ipAddress,
+            uint16_t portNumber,
+            const std::vector<OnReceiveCallback>& subscribers,
+            AdmissionControl* admissionControl = nullptr);
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    bool start();
+    void stop();
+
+    std::vector<int> getAllClientFds();
+
+  private:
+    void threadFunction();
+    void receiveFromClient(int fd);
+
+    ClientManager m_clientManager;
+    Acceptor m_acceptor;
+    const std::vector<OnReceiveCallback>& m_subscribers;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+};
+
+} // namespace odd::io::tcp
+
+#endif // IO_TCP_REACTOR_H_
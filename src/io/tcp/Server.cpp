@@ -1,19 +1,42 @@
+
 #include "Server.h"
-#include <cstring>
+#include <arpa/inet.h>
 #include <iostream>
 
 namespace odd::io::tcp {
 
-Server::Server(std::string ipAddress, uint16_t portNumber)
-  : m_acceptor{ipAddress, portNumber, &m_clientManager},
-    m_running(false)
+namespace {
+
+uint32_t convertIpAddressToInteger(const std::string& ipAddress)
 {
+  in_addr address{};
+  inet_pton(AF_INET, ipAddress.c_str(), &address);
+  return ntohl(address.s_addr);
 }
 
-Server::Server(uint32_t ipAddress, uint16_t portNumber)
-  : m_acceptor{ipAddress, portNumber, &m_clientManager},
+} // namespace
+
+Server::Server(std::string ipAddress,
+               uint16_t portNumber,
+               std::size_t reactorCount,
+               AdmissionLimits admissionLimits)
+  : Server(convertIpAddressToInteger(ipAddress), portNumber, reactorCount, admissionLimits)
+{
+}
+
+Server::Server(uint32_t ipAddress,
+               uint16_t portNumber,
+               std::size_t reactorCount,
+               AdmissionLimits admissionLimits)
+  : m_admissionControl(admissionLimits),
     m_running(false)
 {
+  if (reactorCount == 0) reactorCount = 1;
+
+  for (std::size_t i = 0; i < reactorCount; i++)
+  {
+    m_reactors.push_back(std::make_unique<Reactor>(ipAddress, portNumber, m_subscribers, &m_admissionControl));
+  }
 }
 
 Server::~Server()
@@ -26,8 +49,11 @@ void Server::start()
   try
   {
     m_running = true;
-    m_thread = std::thread(&Server::threadFunction, this);
-    m_acceptor.start();
+
+    for (auto& reactor : m_reactors)
+    {
+      reactor->start();
+    }
   }
   catch (const std::exception& e)
   {
@@ -40,8 +66,11 @@ void Server::stop()
   if (m_running)
   {
     m_running = false;
-    m_thread.join();
-    m_acceptor.stop();
+
+    for (auto& reactor : m_reactors)
+    {
+      reactor->stop();
+    }
   }
 }
 
@@ -52,9 +81,12 @@ void Server::subscribeToAll(OnReceiveCallback callback)
 
 void Server::broadcast(const std::string& message)
 {
-  for (const auto& fd : m_clientManager.getAllClientFds())
+  for (auto& reactor : m_reactors)
   {
-    unicast(message, fd);
+    for (const auto& fd : reactor->getAllClientFds())
+    {
+      unicast(message, fd);
+    }
   }
 }
 
@@ -71,59 +103,5 @@ void Server::unicast(const std::string& message, int fd)
   send(fd, message.c_str(), message.size() + 1, 0);
 }
 
-void Server::threadFunction()
-{
-  fd_set master;
-
-  while (m_running)
-  {
-    FD_ZERO(&master);
-
-    auto allClientFds = m_clientManager.getAllClientFds();
-
-    for (const auto& fd : allClientFds)
-    { 
-      FD_SET(fd, &master);
-    };
-    
-    timeval timeout;
-    timeout.tv_sec = 1;
-
-    int socketCount = select(40, &master, nullptr, nullptr, &timeout);
-
-    if (socketCount <= 0)
-    {
-      continue;
-    }
-
-    for (const auto& client : allClientFds)
-    {
-      char messageBuffer[4096];
-      std::memset(messageBuffer, 0, 4096);
-
-      if (FD_ISSET(client, &master))
-      {
-        size_t bytesIn = recv(client, &messageBuffer, 4096, 0);
-
-        if (bytesIn <= 0)
-        {
-          m_clientManager.processClientDisconnecion(client);
-        }
-        else
-        {
-          for (const auto& subscriber : m_subscribers)
-          {
-            auto* messageData = new uint8_t[bytesIn];
-            memcpy(messageData, messageBuffer, bytesIn);
-            subscriber(messageData, bytesIn);
-          }
-        }
-      }
-
-    }
-  }
-
-}
-
 } // namespace odd::io::tcp
 
@@ -1,15 +1,13 @@
 #ifndef IO_TCP_SERVER_H_
 #define IO_TCP_SERVER_H_
 
-#include "Acceptor.h"
-#include "ClientManager.h"
-#include <functional>
+#include "Reactor.h"
+#include "Types.h"
+#include <memory>
 #include <atomic>
 
 namespace odd::io::tcp {
 
-using OnReceiveCallback = std::function<void(uint8_t*, std::size_t)>;
-
 class Server_I
 {
   public:
@@ -22,11 +20,24 @@ class Server_I
     virtual void unicast(const std::string& message, int fd) = 0;
 };
 
+/*
+ * The Server listens on a single port using one or more Reactors. Each Reactor has its own
+ * listening socket and its own set of clients, so with more than one Reactor the kernel shares the
+ * incoming connections between them and each one is serviced on a separate thread. Subscribers
+ * must be added before the server is started, they are called on the thread of the Reactor that
+ * received the message. The admission limits are shared by all of the Reactors.
+ */
 class Server : public Server_I
 {
   public:
-    Server(std::string ipAddress, uint16_t portNumber);
-    Server(uint32_t ipAddress, uint16_t portNumber);
+    Server(std::string ipAddress,
+           uint16_t portNumber,
+           std::size_t reactorCount = 1,
+           AdmissionLimits admissionLimits = {});
+    Server(uint32_t ipAddress,
+           uint16_t portNumber,
+           std::size_t reactorCount = 1,
+           AdmissionLimits admissionLimits = {});
     ~Server() override;
 
     void start() override;
@@ -38,15 +49,12 @@ class Server : public Server_I
     void unicast(const std::string& message, int fd) override;
 
   private:
-    void threadFunction();
-    ClientManager m_clientManager;
-    Acceptor m_acceptor;
+    AdmissionControl m_admissionControl;
     std::vector<OnReceiveCallback> m_subscribers;
-    std::thread m_thread;
+    std::vector<std::unique_ptr<Reactor>> m_reactors;
     std::atomic<bool> m_running;
 };
 
 } // namespace odd::io::tcp
 
 #endif // IO_TCP_SERVER_H_
-
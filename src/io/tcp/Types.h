@@ -1,6 +1,9 @@
 #ifndef IO_TCP_TYPES_H_
 #define IO_TCP_TYPES_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
 
 namespace odd::io::tcp
@@ -10,6 +13,8 @@ using IpAddressString = std::string;
 using IpAddressV4 = uint32_t;
 using PortNumber = uint16_t;
 
+using OnReceiveCallback = std::function<void(uint8_t*, std::size_t)>;
+
 } // namespace odd::io::tcp
 
 #endif // IO_TCP_TYPES_H_
@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <tcp/Acceptor.h>
+#include <tcp/AdmissionControl.h>
 #include <tcp/ClientManager.h>
 
 namespace odd::io::tcp {
@@ -11,5 +12,42 @@ TEST_CASE("TcpAcceptor")
   Acceptor acceptor{"127.0.0.1", 54000, &manager};
 }
 
+TEST_CASE("AdmissionControl enforces the per source connection limit")
+{
+  AdmissionLimits limits;
+  limits.m_maxConnectionsPerSource = 2;
+  AdmissionControl admission{limits};
+
+  CHECK(admission.tryAdmit(0x7F000001));
+  CHECK(admission.tryAdmit(0x7F000001));
+  CHECK_FALSE(admission.tryAdmit(0x7F000001));
+
+  // A different source is not affected by the first source reaching its limit
+  CHECK(admission.tryAdmit(0x7F000002));
+
+  admission.release(0x7F000001);
+  CHECK(admission.tryAdmit(0x7F000001));
+  CHECK(admission.connectionCount() == 3);
+}
+
+TEST_CASE("AdmissionControl enforces the global connection limit")
+{
+  AdmissionLimits limits;
+  limits.m_maxConnections = 3;
+  AdmissionControl admission{limits};
+
+  CHECK(admission.tryAdmit(1));
+  CHECK(admission.tryAdmit(2));
+  CHECK(admission.tryAdmit(3));
+  CHECK_FALSE(admission.tryAdmit(4));
+
+  admission.release(2);
+  CHECK(admission.tryAdmit(4));
+
+  // Releasing a source that was never admitted does not change the count
+  admission.release(5);
+  CHECK(admission.connectionCount() == 3);
+}
+
 } // namespace odd::io::tcp
 
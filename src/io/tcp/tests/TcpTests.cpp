@@ -1,5 +1,6 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <atomic>
 #include <iostream>
 #include <vector>
 
@@ -35,5 +36,43 @@ TEST_CASE("First test to check client/server behaviour")
   server.stop();
 }
 
+TEST_CASE("Server with several reactors receives from every client")
+{
+  Server server{"127.0.0.1", 54001, 4};
+  std::atomic<int> messagesReceived{0};
+
+  server.subscribeToAll([&messagesReceived] (uint8_t*, std::size_t)
+  {
+    messagesReceived++;
+  });
+
+  server.start();
+
+  std::vector<std::unique_ptr<Client>> clients;
+
+  for (int i = 0; i < 4; ++i)
+  {
+    clients.push_back(std::make_unique<Client>("127.0.0.1", 54001));
+    clients.back()->start();
+  }
+
+  const uint8_t ping[] = { 'p', 'i', 'n', 'g' };
+
+  for (auto& client : clients)
+  {
+    client->send(ping, sizeof(ping));
+  }
+
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+
+  CHECK(messagesReceived == 4);
+
+  for (auto& client : clients)
+  {
+    client->stop();
+  }
+  server.stop();
+}
+
 } // namespace odd
 
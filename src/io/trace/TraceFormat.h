@@ -0,0 +1,64 @@
+#ifndef IO_TRACE_TRACE_FORMAT_H_
+#define IO_TRACE_TRACE_FORMAT_H_
+
+#include <chrono>
+#include <cstdint>
+
+namespace odd::io::trace {
+
+/*
+ * A trace file is a header followed by records back to back, each a record header and the frame's
+ * bytes, with no padding in between. Integers are in the byte order of the host that wrote the
+ * trace, and addresses are stored as the program holds them (network byte order for the addresses
+ * from inet_pton).
+ *
+ * The file is grown in large steps while it is written and cut down to its records when it is
+ * closed. A record header of zeros marks the end of a trace whose writer did not close it.
+ */
+static constexpr char TRACE_MAGIC[8] = { 'O', 'D', 'D', 'T', 'R', 'A', 'C', 'E' };
+static constexpr uint32_t TRACE_VERSION = 1;
+
+enum class Direction : uint8_t
+{
+  SENT = 1,
+  RECEIVED = 2
+};
+
+struct TraceFileHeader
+{
+  char m_magic[8];
+  uint32_t m_version;
+  uint32_t m_reserved;
+};
+
+struct TraceRecordHeader
+{
+  // Nanoseconds from the start of the capture
+  uint64_t m_timestamp;
+
+  // Zero if the capture point does not know it
+  uint32_t m_sourceIpAddress;
+  uint32_t m_destinationIpAddress;
+
+  uint32_t m_length;
+  Direction m_direction;
+  uint8_t m_reserved[3];
+};
+
+static_assert(sizeof(TraceFileHeader) == 16);
+static_assert(sizeof(TraceRecordHeader) == 24);
+
+// A record as read back, the frame points into the reader's mapping of the file
+struct TraceRecord
+{
+  std::chrono::nanoseconds m_timestamp;
+  uint32_t m_sourceIpAddress;
+  uint32_t m_destinationIpAddress;
+  Direction m_direction;
+  uint8_t* m_frame;
+  uint32_t m_length;
+};
+
+} // namespace odd::io::trace
+
+#endif // IO_TRACE_TRACE_FORMAT_H_
@@ -0,0 +1,95 @@
+#include "TraceReader.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace odd::io::trace {
+
+std::unique_ptr<TraceReader> TraceReader::open(const std::string& path)
+{
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (fd < 0)
+  {
+    std::cerr << "open " << path << " failed: " << std::strerror(errno) << std::endl;
+    return nullptr;
+  }
+
+  off_t mappingSize = lseek(fd, 0, SEEK_END);
+
+  if (mappingSize < static_cast<off_t>(sizeof(TraceFileHeader)))
+  {
+    std::cerr << path << " is not a trace" << std::endl;
+    close(fd);
+    return nullptr;
+  }
+
+  void* mapping = mmap(nullptr, static_cast<std::size_t>(mappingSize), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+  // The mapping keeps its own reference to the file
+  close(fd);
+
+  if (mapping == MAP_FAILED)
+  {
+    std::cerr << "mmap failed: " << std::strerror(errno) << std::endl;
+    return nullptr;
+  }
+
+  TraceFileHeader header;
+  std::memcpy(&header, mapping, sizeof(header));
+
+  if (std::memcmp(header.m_magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || header.m_version != TRACE_VERSION)
+  {
+    std::cerr << path << " is not a version " << TRACE_VERSION << " trace" << std::endl;
+    munmap(mapping, static_cast<std::size_t>(mappingSize));
+    return nullptr;
+  }
+
+  return std::make_unique<TraceReader>(mapping, static_cast<std::size_t>(mappingSize));
+}
+
+TraceReader::TraceReader(void* mapping, std::size_t mappingSize)
+  : m_mapping(static_cast<uint8_t*>(mapping)),
+    m_mappingSize(mappingSize),
+    m_offset(sizeof(TraceFileHeader))
+{
+}
+
+TraceReader::~TraceReader()
+{
+  munmap(m_mapping, m_mappingSize);
+}
+
+bool TraceReader::next(TraceRecord& record)
+{
+  if (m_mappingSize - m_offset < sizeof(TraceRecordHeader)) return false;
+
+  TraceRecordHeader header;
+  std::memcpy(&header, m_mapping + m_offset, sizeof(header));
+
+  // The zeros past the last record of a trace that was not closed
+  if (header.m_direction != Direction::SENT && header.m_direction != Direction::RECEIVED) return false;
+
+  if (m_mappingSize - m_offset - sizeof(header) < header.m_length) return false;
+
+  record.m_timestamp = std::chrono::nanoseconds{ header.m_timestamp };
+  record.m_sourceIpAddress = header.m_sourceIpAddress;
+  record.m_destinationIpAddress = header.m_destinationIpAddress;
+  record.m_direction = header.m_direction;
+  record.m_frame = m_mapping + m_offset + sizeof(header);
+  record.m_length = header.m_length;
+
+  m_offset += sizeof(header) + header.m_length;
+
+  return true;
+}
+
+void TraceReader::rewind()
+{
+  m_offset = sizeof(TraceFileHeader);
+}
+
+} // namespace odd::io::trace
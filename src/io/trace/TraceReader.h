@@ -0,0 +1,44 @@
+#ifndef IO_TRACE_TRACE_READER_H_
+#define IO_TRACE_TRACE_READER_H_
+
+#include "TraceFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace odd::io::trace {
+
+/*
+ * Reads the records of a trace file in the order they were written. The file is mapped copy on
+ * write, so the frames handed out may be changed by whoever they are delivered to without changing
+ * the file, and they stay valid for as long as the reader.
+ */
+class TraceReader
+{
+  public:
+    // Returns nullptr if the file cannot be mapped or is not a trace
+    [[nodiscard]] static std::unique_ptr<TraceReader> open(const std::string& path);
+
+    TraceReader(void* mapping, std::size_t mappingSize);
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    // Returns false at the end of the trace, a record cut short by the end of the file is not read
+    bool next(TraceRecord& record);
+
+    // Goes back to the first record
+    void rewind();
+
+  private:
+    uint8_t* m_mapping;
+    std::size_t m_mappingSize;
+    std::size_t m_offset;
+};
+
+} // namespace odd::io::trace
+
+#endif // IO_TRACE_TRACE_READER_H_
@@ -0,0 +1,158 @@
+#include "TraceWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace odd::io::trace {
+
+std::unique_ptr<TraceWriter> TraceWriter::create(const std::string& path, std::size_t initialCapacity)
+{
+  auto mappingSize = sizeof(TraceFileHeader) + std::max(initialCapacity, sizeof(TraceRecordHeader));
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+  if (fd < 0)
+  {
+    std::cerr << "open " << path << " failed: " << std::strerror(errno) << std::endl;
+    return nullptr;
+  }
+
+  if (ftruncate(fd, static_cast<off_t>(mappingSize)) < 0)
+  {
+    std::cerr << "ftruncate failed: " << std::strerror(errno) << std::endl;
+    ::close(fd);
+    return nullptr;
+  }
+
+  void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  if (mapping == MAP_FAILED)
+  {
+    std::cerr << "mmap failed: " << std::strerror(errno) << std::endl;
+    ::close(fd);
+    return nullptr;
+  }
+
+  TraceFileHeader header{};
+  std::memcpy(header.m_magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  header.m_version = TRACE_VERSION;
+  std::memcpy(mapping, &header, sizeof(header));
+
+  return std::make_unique<TraceWriter>(fd, mapping, mappingSize);
+}
+
+TraceWriter::TraceWriter(int fd, void* mapping, std::size_t mappingSize)
+  : m_fd(fd),
+    m_mapping(static_cast<uint8_t*>(mapping)),
+    m_mappingSize(mappingSize),
+    m_size(sizeof(TraceFileHeader)),
+    m_records(0),
+    m_created(std::chrono::steady_clock::now())
+{
+}
+
+TraceWriter::~TraceWriter()
+{
+  close();
+}
+
+bool TraceWriter::record(Direction direction,
+                         std::chrono::nanoseconds timestamp,
+                         uint32_t sourceIpAddress,
+                         uint32_t destinationIpAddress,
+                         const uint8_t* frame,
+                         std::size_t length)
+{
+  std::lock_guard lock(m_mutex);
+
+  if (m_mapping == nullptr) return false;
+
+  auto required = m_size + sizeof(TraceRecordHeader) + length;
+
+  if (required > m_mappingSize && not grow(required)) return false;
+
+  TraceRecordHeader header{};
+  header.m_timestamp = static_cast<uint64_t>(timestamp.count());
+  header.m_sourceIpAddress = sourceIpAddress;
+  header.m_destinationIpAddress = destinationIpAddress;
+  header.m_length = static_cast<uint32_t>(length);
+  header.m_direction = direction;
+
+  // Records follow each other without padding, so they are copied rather than cast in place
+  std::memcpy(m_mapping + m_size, &header, sizeof(header));
+  if (length > 0) std::memcpy(m_mapping + m_size + sizeof(header), frame, length);
+
+  m_size = required;
+  m_records++;
+
+  return true;
+}
+
+[[nodiscard]] std::chrono::nanoseconds TraceWriter::elapsed() const
+{
+  return std::chrono::steady_clock::now() - m_created;
+}
+
+void TraceWriter::close()
+{
+  std::lock_guard lock(m_mutex);
+
+  if (m_mapping == nullptr) return;
+
+  munmap(m_mapping, m_mappingSize);
+  m_mapping = nullptr;
+
+  if (ftruncate(m_fd, static_cast<off_t>(m_size)) < 0)
+  {
+    std::cerr << "ftruncate failed: " << std::strerror(errno) << std::endl;
+  }
+
+  ::close(m_fd);
+}
+
+[[nodiscard]] std::size_t TraceWriter::records() const
+{
+  std::lock_guard lock(m_mutex);
+  return m_records;
+}
+
+[[nodiscard]] std::size_t TraceWriter::size() const
+{
+  std::lock_guard lock(m_mutex);
+  return m_size;
+}
+
+bool TraceWriter::grow(std::size_t required)
+{
+  auto mappingSize = std::max(m_mappingSize * 2, required);
+
+  munmap(m_mapping, m_mappingSize);
+  m_mapping = nullptr;
+
+  if (ftruncate(m_fd, static_cast<off_t>(mappingSize)) < 0)
+  {
+    std::cerr << "ftruncate failed: " << std::strerror(errno) << std::endl;
+    mappingSize = m_mappingSize;
+  }
+
+  void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+
+  if (mapping == MAP_FAILED)
+  {
+    // Nothing more can be recorded, keep what has been
+    std::cerr << "mmap failed: " << std::strerror(errno) << std::endl;
+    ftruncate(m_fd, static_cast<off_t>(m_size));
+    ::close(m_fd);
+    return false;
+  }
+
+  m_mapping = static_cast<uint8_t*>(mapping);
+  m_mappingSize = mappingSize;
+
+  return mappingSize >= required;
+}
+
+} // namespace odd::io::trace
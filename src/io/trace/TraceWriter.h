@@ -0,0 +1,72 @@
+#ifndef IO_TRACE_TRACE_WRITER_H_
+#define IO_TRACE_TRACE_WRITER_H_
+
+#include "TraceFormat.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace odd::io::trace {
+
+/*
+ * Appends frames to a trace file through a shared mapping of it, so recording a frame is a copy
+ * into memory and the kernel writes the pages back in its own time. The file is created with room
+ * for the initial capacity of records and doubled, and mapped again, whenever a frame does not
+ * fit. Closing the writer cuts the file down to the records written.
+ *
+ * Any number of threads may record to the same writer.
+ */
+class TraceWriter
+{
+  public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 64 * 1024 * 1024;
+
+    // Creates the file, replacing any file at the path, returns nullptr if it cannot be created
+    [[nodiscard]] static std::unique_ptr<TraceWriter> create(const std::string& path,
+                                                             std::size_t initialCapacity = DEFAULT_CAPACITY);
+
+    TraceWriter(int fd, void* mapping, std::size_t mappingSize);
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Returns false if the trace is closed or the file could not be grown
+    bool record(Direction direction,
+                std::chrono::nanoseconds timestamp,
+                uint32_t sourceIpAddress,
+                uint32_t destinationIpAddress,
+                const uint8_t* frame,
+                std::size_t length);
+
+    // The time since the writer was created, for capture points that are not on simulated time
+    [[nodiscard]] std::chrono::nanoseconds elapsed() const;
+
+    void close();
+
+    [[nodiscard]] std::size_t records() const;
+
+    // The bytes written, header included, which is the size of the file once it is closed
+    [[nodiscard]] std::size_t size() const;
+
+  private:
+    bool grow(std::size_t required);
+
+    mutable std::mutex m_mutex;
+
+    int m_fd;
+    uint8_t* m_mapping;
+    std::size_t m_mappingSize;
+    std::size_t m_size;
+    std::size_t m_records;
+
+    const std::chrono::steady_clock::time_point m_created;
+};
+
+} // namespace odd::io::trace
+
+#endif // IO_TRACE_TRACE_WRITER_H_
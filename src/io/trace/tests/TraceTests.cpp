@@ -0,0 +1,159 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include <trace/TraceReader.h>
+#include <trace/TraceWriter.h>
+
+namespace odd::io::trace {
+
+namespace {
+
+std::string tracePath(const std::string& name)
+{
+  return (std::filesystem::temp_directory_path() / ("odd-" + name + "-" + std::to_string(getpid()) + ".trace")).string();
+}
+
+} // namespace
+
+TEST_CASE("Frames recorded to a trace are read back in order")
+{
+  auto path = tracePath("round-trip");
+
+  {
+    auto writer = TraceWriter::create(path, 1024);
+    REQUIRE(writer);
+
+    for (uint8_t i = 0; i < 10; i++)
+    {
+      std::vector<uint8_t> frame(i, i);
+      auto direction = i % 2 == 0 ? Direction::SENT : Direction::RECEIVED;
+
+      REQUIRE(writer->record(direction, std::chrono::milliseconds{ i }, 100 + i, 200 + i, frame.data(), frame.size()));
+    }
+
+    CHECK(writer->records() == 10);
+  }
+
+  // Closing the writer cuts the file down to the records
+  auto expectedSize = sizeof(TraceFileHeader) + 10 * sizeof(TraceRecordHeader) + 45;
+  CHECK(std::filesystem::file_size(path) == expectedSize);
+
+  auto reader = TraceReader::open(path);
+  REQUIRE(reader);
+
+  TraceRecord record{};
+
+  for (uint8_t i = 0; i < 10; i++)
+  {
+    REQUIRE(reader->next(record));
+    CHECK(record.m_timestamp == std::chrono::milliseconds{ i });
+    CHECK(record.m_sourceIpAddress == 100u + i);
+    CHECK(record.m_destinationIpAddress == 200u + i);
+    CHECK(record.m_direction == (i % 2 == 0 ? Direction::SENT : Direction::RECEIVED));
+    REQUIRE(record.m_length == i);
+
+    for (uint32_t j = 0; j < record.m_length; j++)
+    {
+      CHECK(record.m_frame[j] == i);
+    }
+  }
+
+  CHECK_FALSE(reader->next(record));
+
+  reader->rewind();
+  REQUIRE(reader->next(record));
+  CHECK(record.m_sourceIpAddress == 100);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("A trace grows past its initial capacity while threads record to it")
+{
+  auto path = tracePath("growth");
+  auto writer = TraceWriter::create(path, 64);
+  REQUIRE(writer);
+
+  constexpr uint32_t threadCount = 4;
+  constexpr uint32_t framesPerThread = 2000;
+  std::vector<std::thread> threads;
+
+  for (uint32_t t = 0; t < threadCount; t++)
+  {
+    threads.emplace_back([&writer, t]
+    {
+      std::vector<uint8_t> frame(100, static_cast<uint8_t>(t));
+
+      for (uint32_t i = 0; i < framesPerThread; i++)
+      {
+        writer->record(Direction::SENT, writer->elapsed(), t, i, frame.data(), frame.size());
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  writer->close();
+
+  auto reader = TraceReader::open(path);
+  REQUIRE(reader);
+
+  std::vector<uint32_t> next(threadCount, 0);
+  TraceRecord record{};
+
+  while (reader->next(record))
+  {
+    REQUIRE(record.m_sourceIpAddress < threadCount);
+    REQUIRE(record.m_length == 100);
+    CHECK(record.m_frame[99] == record.m_sourceIpAddress);
+
+    // Each thread's frames are in the order it recorded them
+    CHECK(record.m_destinationIpAddress == next[record.m_sourceIpAddress]++);
+  }
+
+  for (auto count : next)
+  {
+    CHECK(count == framesPerThread);
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("The records of a trace that is still being written can be read")
+{
+  auto path = tracePath("open");
+  auto writer = TraceWriter::create(path, 4096);
+  REQUIRE(writer);
+
+  uint8_t frame[] = { 1, 2, 3 };
+  writer->record(Direction::SENT, std::chrono::nanoseconds{ 5 }, 1, 2, frame, sizeof(frame));
+  writer->record(Direction::RECEIVED, std::chrono::nanoseconds{ 6 }, 1, 2, frame, sizeof(frame));
+
+  auto reader = TraceReader::open(path);
+  REQUIRE(reader);
+
+  TraceRecord record{};
+  CHECK(reader->next(record));
+  CHECK(reader->next(record));
+  CHECK(record.m_timestamp == std::chrono::nanoseconds{ 6 });
+  CHECK_FALSE(reader->next(record));
+
+  writer->close();
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("A file that is not a trace is not opened")
+{
+  CHECK_FALSE(TraceReader::open(tracePath("missing")));
+}
+
+} // namespace odd::io::trace
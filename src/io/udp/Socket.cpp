@@ -0,0 +1,171 @@
+#include "Socket.h"
+
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace odd::io::udp {
+
+namespace {
+
+// The number of datagrams passed to the kernel in each sendmmsg/recvmmsg call
+constexpr std::size_t SYSCALL_BATCH = 64;
+
+} // namespace
+
+Socket::Socket(uint32_t ipAddress, uint16_t port)
+  : m_fd(-1),
+    m_ipAddress(ipAddress),
+    m_port(port)
+{
+}
+
+Socket::~Socket()
+{
+  close();
+}
+
+bool Socket::open()
+{
+  m_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+  if (m_fd < 0)
+  {
+    std::cerr << "Could not create udp socket" << std::endl;
+    return false;
+  }
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(m_port);
+  address.sin_addr.s_addr = htonl(m_ipAddress);
+
+  if (bind(m_fd, (struct sockaddr*) &address, sizeof(address)) == -1)
+  {
+    std::cerr << "Could not bind udp socket to IP/port" << std::endl;
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void Socket::close()
+{
+  if (m_fd >= 0)
+  {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+std::size_t Socket::sendBatch(const Datagram* datagrams, std::size_t count)
+{
+  std::array<mmsghdr, SYSCALL_BATCH> headers{};
+  std::array<iovec, SYSCALL_BATCH> iovecs{};
+  std::array<sockaddr_in, SYSCALL_BATCH> addresses{};
+
+  std::size_t sent = 0;
+
+  while (sent < count)
+  {
+    auto batch = std::min(count - sent, SYSCALL_BATCH);
+
+    for (std::size_t i = 0; i < batch; i++)
+    {
+      const auto& datagram = datagrams[sent + i];
+
+      addresses[i].sin_family = AF_INET;
+      addresses[i].sin_port = htons(datagram.m_port);
+      addresses[i].sin_addr.s_addr = htonl(datagram.m_ipAddress);
+
+      iovecs[i].iov_base = const_cast<uint8_t*>(datagram.m_data.data());
+      iovecs[i].iov_len = datagram.m_length;
+
+      headers[i].msg_hdr = msghdr{};
+      headers[i].msg_hdr.msg_name = &addresses[i];
+      headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+      headers[i].msg_hdr.msg_iov = &iovecs[i];
+      headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int result = sendmmsg(m_fd, headers.data(), batch, 0);
+
+    if (result < 0)
+    {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+      {
+        std::cerr << "Error sending udp datagrams" << std::endl;
+      }
+      break;
+    }
+
+    sent += static_cast<std::size_t>(result);
+
+    if (static_cast<std::size_t>(result) < batch) break;
+  }
+
+  return sent;
+}
+
+std::size_t Socket::receiveBatch(std::vector<Datagram>& datagrams)
+{
+  std::array<mmsghdr, SYSCALL_BATCH> headers{};
+  std::array<iovec, SYSCALL_BATCH> iovecs{};
+  std::array<sockaddr_in, SYSCALL_BATCH> addresses{};
+
+  std::size_t received = 0;
+
+  while (received < datagrams.size())
+  {
+    auto batch = std::min(datagrams.size() - received, SYSCALL_BATCH);
+
+    for (std::size_t i = 0; i < batch; i++)
+    {
+      auto& datagram = datagrams[received + i];
+
+      iovecs[i].iov_base = datagram.m_data.data();
+      iovecs[i].iov_len = datagram.m_data.size();
+
+      headers[i].msg_hdr = msghdr{};
+      headers[i].msg_hdr.msg_name = &addresses[i];
+      headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+      headers[i].msg_hdr.msg_iov = &iovecs[i];
+      headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int result = recvmmsg(m_fd, headers.data(), batch, 0, nullptr);
+
+    if (result < 0)
+    {
+      if (errno == EINTR) continue;
+      break;
+    }
+
+    for (int i = 0; i < result; i++)
+    {
+      auto& datagram = datagrams[received + i];
+      datagram.m_ipAddress = ntohl(addresses[i].sin_addr.s_addr);
+      datagram.m_port = ntohs(addresses[i].sin_port);
+      datagram.m_length = headers[i].msg_len;
+    }
+
+    received += static_cast<std::size_t>(result);
+
+    if (static_cast<std::size_t>(result) < batch) break;
+  }
+
+  return received;
+}
+
+int Socket::fd() const
+{
+  return m_fd;
+}
+
+} // namespace odd::io::udp
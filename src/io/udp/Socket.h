@@ -0,0 +1,57 @@
+#ifndef IO_UDP_SOCKET_H_
+#define IO_UDP_SOCKET_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace odd::io::udp {
+
+// Small enough to fit in a single ethernet frame without fragmentation
+static constexpr std::size_t MAX_DATAGRAM_SIZE = 1472;
+
+struct Datagram
+{
+  uint32_t m_ipAddress = 0;
+  uint16_t m_port = 0;
+  std::size_t m_length = 0;
+  std::array<uint8_t, MAX_DATAGRAM_SIZE> m_data;
+};
+
+/*
+ * A non-blocking UDP socket. Datagrams are sent and received in batches with sendmmsg/recvmmsg so
+ * that a burst of small messages costs one system call rather than one per message. Addresses and
+ * ports are in host byte order, the same as io::tcp.
+ */
+class Socket
+{
+  public:
+    Socket(uint32_t ipAddress, uint16_t port);
+    ~Socket();
+
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    bool open();
+    void close();
+
+    // Returns the number of datagrams that were sent, which can be fewer than the number given if
+    // the socket buffer is full.
+    std::size_t sendBatch(const Datagram* datagrams, std::size_t count);
+
+    // Receives up to datagrams.size() datagrams, returns the number received (zero if none were
+    // waiting).
+    std::size_t receiveBatch(std::vector<Datagram>& datagrams);
+
+    [[nodiscard]] int fd() const;
+
+  private:
+    int m_fd;
+    uint32_t m_ipAddress;
+    uint16_t m_port;
+};
+
+} // namespace odd::io::udp
+
+#endif // IO_UDP_SOCKET_H_
@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <udp/Socket.h>
+
+namespace odd::io::udp {
+
+TEST_CASE("A batch of datagrams is sent and received")
+{
+  constexpr uint32_t localhost = 0x7F000001;
+
+  Socket sender{localhost, 54301};
+  Socket receiver{localhost, 54302};
+
+  REQUIRE(sender.open());
+  REQUIRE(receiver.open());
+
+  std::vector<Datagram> toSend(3);
+
+  for (std::size_t i = 0; i < toSend.size(); i++)
+  {
+    toSend[i].m_ipAddress = localhost;
+    toSend[i].m_port = 54302;
+    toSend[i].m_length = i + 1;
+    std::memset(toSend[i].m_data.data(), static_cast<int>(i), toSend[i].m_length);
+  }
+
+  CHECK(sender.sendBatch(toSend.data(), toSend.size()) == 3);
+
+  std::vector<Datagram> received(8);
+  std::size_t receivedCount = 0;
+
+  for (int attempt = 0; attempt < 100 && receivedCount < 3; attempt++)
+  {
+    std::vector<Datagram> batch(8);
+    auto count = receiver.receiveBatch(batch);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+      received[receivedCount++] = batch[i];
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+
+  REQUIRE(receivedCount == 3);
+
+  for (std::size_t i = 0; i < receivedCount; i++)
+  {
+    CHECK(received[i].m_ipAddress == localhost);
+    CHECK(received[i].m_port == 54301);
+    CHECK(received[i].m_length == i + 1);
+    CHECK(received[i].m_data[0] == i);
+  }
+}
+
+TEST_CASE("Receiving from an empty socket does not block")
+{
+  Socket socket{0x7F000001, 54303};
+  REQUIRE(socket.open());
+
+  std::vector<Datagram> batch(4);
+  CHECK(socket.receiveBatch(batch) == 0);
+}
+
+} // namespace odd::io::udp